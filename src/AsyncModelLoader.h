@@ -0,0 +1,224 @@
+#pragma once
+#include "RenderDevice.h"
+#include "ModelCooker.h"
+#include "StaticModel.h"
+#include "ThreadPool.h"
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Diligent
+{
+
+// -----------------------------------------------------------------------------
+// Carga de modelos GLTF en segundo plano.
+//   Load() encola en el ThreadPool la parte de CPU: proyectar la cache .dgcm
+//   y validarla o, si no vale, cocinar el .gltf y reescribirla
+//   (ModelCooker::Acquire). Los workers no tocan el device, asi que tambien
+//   vale para GL. ProcessUploads() crea los StaticModel en el render thread
+//   con un presupuesto de tiempo por frame y entrega los modelos listos; su
+//   geometria va al GeometryPool, que la sube en su siguiente Flush().
+// -----------------------------------------------------------------------------
+class AsyncModelLoader
+{
+public:
+    enum class STATE
+    {
+        Parsing,   // en un worker (cache o cooker)
+        Uploading, // datos listos, esperando su turno en ProcessUploads
+        Ready,     // entregado al llamador
+        Failed,
+        Unknown    // nunca se pidio
+    };
+
+    struct LoadedModel
+    {
+        std::string                  Name;
+        std::unique_ptr<StaticModel> pModel;
+        bool                         FromCache = false;
+    };
+
+    struct Stats
+    {
+        Uint32 Requested    = 0;
+        Uint32 Ready        = 0;
+        Uint32 Failed       = 0;
+        Uint32 CacheHits    = 0;   // .dgcm valido, sin parsear el .gltf
+        Uint32 Cooked       = 0;   // cocinados (cache ausente u obsoleta)
+        double CacheMs      = 0.0; // suma en workers: proyectar + validar
+        double CookMs       = 0.0; // suma en workers: cocinar + escribir
+        double CreateMs     = 0.0; // suma en render thread: buffers y texturas
+        Uint32 LastUploads  = 0;   // modelos subidos en la ultima llamada
+        double LastUploadMs = 0.0; // tiempo de esa llamada
+    };
+
+    // pGeometryPool == nullptr: cada modelo con su VB/IB propio
+    void Initialize(IRenderDevice* pDevice, GeometryPool* pGeometryPool, const ModelCookSettings& Settings = {}, unsigned NumThreads = 0)
+    {
+        m_pDevice       = pDevice;
+        m_pGeometryPool = pGeometryPool;
+        m_Settings      = Settings;
+        m_pPool         = std::make_unique<ThreadPool>(NumThreads);
+    }
+
+    // FileName relativo al directorio de trabajo ("Barrel/scene.gltf"); es
+    // tambien el nombre con el que se entrega
+    void Load(const std::string& FileName) { Load(FileName, m_Settings); }
+
+    // Con otros ajustes de cocinado (p.e. sin MeshOptimizer para comparar):
+    // la cache de ese modelo se recocina porque su hash no coincide
+    void Load(const std::string& FileName, const ModelCookSettings& Settings)
+    {
+        auto pEntry  = std::make_unique<Entry>();
+        pEntry->Name = FileName;
+
+        Entry* pRaw = pEntry.get();
+        m_Entries.push_back(std::move(pEntry));
+        ++m_Stats.Requested;
+
+        pRaw->Parsed = m_pPool->Submit([FileName, Settings]() {
+            return ModelCooker::Acquire(FileName, Settings);
+        });
+    }
+
+    // Render thread: recoge lo que terminaron los workers y crea los
+    // StaticModel (buffers y texturas inmutables) hasta gastar BudgetMs (al
+    // menos uno por llamada, para no estancarse nunca).
+    // Los modelos listos se anaden a Out en orden de peticion.
+    Uint32 ProcessUploads(double BudgetMs, std::vector<LoadedModel>& Out)
+    {
+        const auto tStart   = std::chrono::high_resolution_clock::now();
+        Uint32     Uploaded = 0;
+
+        for (auto& pEntry : m_Entries)
+        {
+            Entry& E = *pEntry;
+            if (E.State == STATE::Parsing)
+            {
+                if (E.Parsed.wait_for(std::chrono::seconds{0}) != std::future_status::ready)
+                    continue;
+                try
+                {
+                    E.pSource = E.Parsed.get();
+                    E.State   = E.pSource->Ok ? STATE::Uploading : STATE::Failed;
+                    if (E.pSource->Ok && E.pSource->FromCache)
+                    {
+                        ++m_Stats.CacheHits;
+                        m_Stats.CacheMs += E.pSource->TimeMs;
+                    }
+                    else if (E.pSource->Ok)
+                    {
+                        ++m_Stats.Cooked;
+                        m_Stats.CookMs += E.pSource->TimeMs;
+                    }
+                }
+                catch (...)
+                {
+                    E.State = STATE::Failed;
+                }
+            }
+            if (E.State == STATE::Failed && !E.Reported)
+            {
+                E.Reported = true;
+                ++m_Stats.Failed;
+                OutputDebugStringA(("AsyncModelLoader: fallo al cargar " + E.Name +
+                                    (E.pSource ? ": " + E.pSource->Error : std::string{}) + "\n").c_str());
+                E.pSource.reset();
+                continue;
+            }
+            if (E.State != STATE::Uploading)
+                continue;
+
+            const std::chrono::duration<double, std::milli> Elapsed = std::chrono::high_resolution_clock::now() - tStart;
+            if (Uploaded > 0 && Elapsed.count() >= BudgetMs)
+                break;
+
+            const auto tCreate   = std::chrono::high_resolution_clock::now();
+            auto       pModel    = std::make_unique<StaticModel>();
+            const bool Created   = pModel->Create(m_pDevice, E.Name, E.pSource->View, m_pGeometryPool);
+            const bool FromCache = E.pSource->FromCache;
+            E.pSource.reset(); // desproyecta la cache / libera lo cocinado
+            ++Uploaded;
+
+            const std::chrono::duration<double, std::milli> CreateTime = std::chrono::high_resolution_clock::now() - tCreate;
+            m_Stats.CreateMs += CreateTime.count();
+
+            if (!Created)
+            {
+                E.State    = STATE::Failed;
+                E.Reported = true;
+                ++m_Stats.Failed;
+                OutputDebugStringA(("AsyncModelLoader: no se pudieron crear los recursos de " + E.Name + "\n").c_str());
+                continue;
+            }
+            E.State = STATE::Ready;
+            Out.push_back({E.Name, std::move(pModel), FromCache});
+            ++m_Stats.Ready;
+        }
+
+        const std::chrono::duration<double, std::milli> Total = std::chrono::high_resolution_clock::now() - tStart;
+        m_Stats.LastUploads  = Uploaded;
+        m_Stats.LastUploadMs = Total.count();
+        return Uploaded;
+    }
+
+    // Estado de la ultima peticion con ese nombre (un modelo liberado se puede
+    // volver a pedir). Unknown si nunca se pidio.
+    STATE GetState(const std::string& Name) const
+    {
+        for (auto it = m_Entries.rbegin(); it != m_Entries.rend(); ++it)
+        {
+            if ((*it)->Name == Name)
+                return (*it)->State;
+        }
+        return STATE::Unknown;
+    }
+
+    bool IsReady(const std::string& Name) const { return GetState(Name) == STATE::Ready; }
+    bool HasFailed(const std::string& Name) const { return GetState(Name) == STATE::Failed; }
+    bool IsPending(const std::string& Name) const
+    {
+        const STATE State = GetState(Name);
+        return State == STATE::Parsing || State == STATE::Uploading;
+    }
+
+    // Nombres que aun no se han entregado (parseando o esperando subida)
+    template <typename F>
+    void ForEachPending(F&& Fn) const
+    {
+        for (const auto& pEntry : m_Entries)
+        {
+            if (pEntry->State == STATE::Parsing || pEntry->State == STATE::Uploading)
+                Fn(pEntry->Name);
+        }
+    }
+
+    bool                     HasPending() const { return m_Stats.Ready + m_Stats.Failed < m_Stats.Requested; }
+    unsigned                 GetNumThreads() const { return m_pPool ? m_pPool->GetNumThreads() : 0; }
+    const Stats&             GetStats() const { return m_Stats; }
+    const ModelCookSettings& GetCookSettings() const { return m_Settings; }
+
+private:
+    struct Entry
+    {
+        std::string                                     Name;
+        std::future<std::unique_ptr<CookedModelSource>> Parsed;
+        std::unique_ptr<CookedModelSource>              pSource;
+        STATE                                           State    = STATE::Parsing;
+        bool                                            Reported = false;
+    };
+
+    IRenderDevice*                      m_pDevice       = nullptr;
+    GeometryPool*                       m_pGeometryPool = nullptr;
+    ModelCookSettings                   m_Settings;
+    std::vector<std::unique_ptr<Entry>> m_Entries;
+    Stats                               m_Stats;
+
+    // Ultimo miembro: se destruye primero y espera a los workers pendientes
+    // (pueden estar escribiendo una cache)
+    std::unique_ptr<ThreadPool> m_pPool;
+};
+
+} // namespace Diligent
@@ -0,0 +1,185 @@
+#pragma once
+#include "BasicMath.hpp"
+#include "AdvancedMath.hpp" // ViewFrustum, ExtractViewFrustumPlanesFromMatrix
+#include <cmath>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#    include <emmintrin.h>
+#    define CHUNK_CULLING_SSE 1
+#else
+#    define CHUNK_CULLING_SSE 0
+#endif
+
+namespace Diligent
+{
+
+// AABBs de chunks en SoA (centro + semiextension por eje). Asi el test contra
+// un plano carga 4 cajas de golpe con _mm_loadu_ps, sin shuffles.
+struct ChunkBoundsSoA
+{
+    std::vector<float> CenterX, CenterY, CenterZ;
+    std::vector<float> ExtentX, ExtentY, ExtentZ;
+
+    void Clear()
+    {
+        CenterX.clear();
+        CenterY.clear();
+        CenterZ.clear();
+        ExtentX.clear();
+        ExtentY.clear();
+        ExtentZ.clear();
+    }
+
+    void Add(const float3& Min, const float3& Max)
+    {
+        CenterX.push_back((Min.x + Max.x) * 0.5f);
+        CenterY.push_back((Min.y + Max.y) * 0.5f);
+        CenterZ.push_back((Min.z + Max.z) * 0.5f);
+        ExtentX.push_back((Max.x - Min.x) * 0.5f);
+        ExtentY.push_back((Max.y - Min.y) * 0.5f);
+        ExtentZ.push_back((Max.z - Min.z) * 0.5f);
+    }
+
+    Uint32 Size() const { return static_cast<Uint32>(CenterX.size()); }
+};
+
+// Los 6 planos del frustum, tambien en SoA. Normales hacia dentro y
+// normalizadas: dot(N, p) + D es la distancia con signo al plano.
+struct FrustumPlanesSoA
+{
+    static constexpr Uint32 NumPlanes = 6;
+
+    enum PLANE_IDX : Uint32
+    {
+        LEFT = 0,
+        RIGHT,
+        BOTTOM,
+        TOP,
+        NEAR_PLANE,
+        FAR_PLANE
+    };
+
+    float Nx[NumPlanes];
+    float Ny[NumPlanes];
+    float Nz[NumPlanes];
+    float D[NumPlanes];
+
+    FrustumPlanesSoA(const float4x4& ViewProj, bool IsGL)
+    {
+        ViewFrustum Frustum;
+        ExtractViewFrustumPlanesFromMatrix(ViewProj, Frustum, IsGL);
+
+        const Plane3D* Planes[NumPlanes] = {&Frustum.LeftPlane, &Frustum.RightPlane,
+                                            &Frustum.BottomPlane, &Frustum.TopPlane,
+                                            &Frustum.NearPlane, &Frustum.FarPlane};
+        for (Uint32 p = 0; p < NumPlanes; ++p)
+        {
+            const float3& N      = Planes[p]->Normal;
+            const float   InvLen = 1.f / std::sqrt(N.x * N.x + N.y * N.y + N.z * N.z);
+
+            Nx[p] = N.x * InvLen;
+            Ny[p] = N.y * InvLen;
+            Nz[p] = N.z * InvLen;
+            D[p]  = Planes[p]->Distance * InvLen;
+        }
+    }
+
+    // Deja un plano siempre satisfecho (p.e. el near de una cascada de sombra:
+    // un caster entre la luz y la cascada tambien proyecta dentro)
+    void IgnorePlane(PLANE_IDX p)
+    {
+        Nx[p] = 0.f;
+        Ny[p] = 0.f;
+        Nz[p] = 0.f;
+        D[p]  = 1.f;
+    }
+};
+
+// Esfera (centro en mundo, radio) contra los seis planos
+inline bool IsSphereVisible(const FrustumPlanesSoA& Planes, const float3& Center, float Radius)
+{
+    for (Uint32 p = 0; p < FrustumPlanesSoA::NumPlanes; ++p)
+    {
+        if (Planes.Nx[p] * Center.x + Planes.Ny[p] * Center.y + Planes.Nz[p] * Center.z + Planes.D[p] < -Radius)
+            return false;
+    }
+    return true;
+}
+
+// Caja fuera si para algun plano: dot(N, c) + D + (|Nx| ex + |Ny| ey + |Nz| ez) < 0.
+// Mismo orden de operaciones que el camino SSE, asi ambos dan el mismo resultado.
+inline bool IsChunkVisibleScalar(const ChunkBoundsSoA& Bounds, const FrustumPlanesSoA& Planes, Uint32 i)
+{
+    for (Uint32 p = 0; p < FrustumPlanesSoA::NumPlanes; ++p)
+    {
+        const float Dist = Planes.Nx[p] * Bounds.CenterX[i] + Planes.Ny[p] * Bounds.CenterY[i] + Planes.Nz[p] * Bounds.CenterZ[i] + Planes.D[p];
+        const float Rad  = std::abs(Planes.Nx[p]) * Bounds.ExtentX[i] + std::abs(Planes.Ny[p]) * Bounds.ExtentY[i] + std::abs(Planes.Nz[p]) * Bounds.ExtentZ[i];
+        if (Dist + Rad < 0.f)
+            return false;
+    }
+    return true;
+}
+
+// Rellena Visible (1 = visible) y devuelve cuantos chunks pasan.
+// Con UseSIMD procesa grupos de 4 cajas con SSE; la cola va por el camino escalar.
+inline Uint32 CullChunks(const ChunkBoundsSoA& Bounds, const FrustumPlanesSoA& Planes, std::vector<Uint8>& Visible, bool UseSIMD = true)
+{
+    const Uint32 Count = Bounds.Size();
+    Visible.resize(Count);
+
+    Uint32 NumVisible = 0;
+    Uint32 i          = 0;
+
+#if CHUNK_CULLING_SSE
+    if (UseSIMD)
+    {
+        const __m128 SignMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+        for (; i + 4 <= Count; i += 4)
+        {
+            const __m128 Cx = _mm_loadu_ps(&Bounds.CenterX[i]);
+            const __m128 Cy = _mm_loadu_ps(&Bounds.CenterY[i]);
+            const __m128 Cz = _mm_loadu_ps(&Bounds.CenterZ[i]);
+            const __m128 Ex = _mm_loadu_ps(&Bounds.ExtentX[i]);
+            const __m128 Ey = _mm_loadu_ps(&Bounds.ExtentY[i]);
+            const __m128 Ez = _mm_loadu_ps(&Bounds.ExtentZ[i]);
+
+            __m128 Outside = _mm_setzero_ps();
+            for (Uint32 p = 0; p < FrustumPlanesSoA::NumPlanes; ++p)
+            {
+                const __m128 Nx = _mm_set1_ps(Planes.Nx[p]);
+                const __m128 Ny = _mm_set1_ps(Planes.Ny[p]);
+                const __m128 Nz = _mm_set1_ps(Planes.Nz[p]);
+
+                __m128 Dist = _mm_add_ps(_mm_mul_ps(Nx, Cx), _mm_mul_ps(Ny, Cy));
+                Dist        = _mm_add_ps(Dist, _mm_mul_ps(Nz, Cz));
+                Dist        = _mm_add_ps(Dist, _mm_set1_ps(Planes.D[p]));
+
+                __m128 Rad = _mm_add_ps(_mm_mul_ps(_mm_and_ps(Nx, SignMask), Ex), _mm_mul_ps(_mm_and_ps(Ny, SignMask), Ey));
+                Rad        = _mm_add_ps(Rad, _mm_mul_ps(_mm_and_ps(Nz, SignMask), Ez));
+
+                // Dist + Rad < 0  <=>  fuera de este plano
+                Outside = _mm_or_ps(Outside, _mm_cmplt_ps(_mm_add_ps(Dist, Rad), _mm_setzero_ps()));
+            }
+
+            const int OutMask = _mm_movemask_ps(Outside);
+            for (Uint32 k = 0; k < 4; ++k)
+            {
+                const Uint8 Vis = (OutMask & (1 << k)) ? 0 : 1;
+                Visible[i + k]  = Vis;
+                NumVisible += Vis;
+            }
+        }
+    }
+#endif
+
+    for (; i < Count; ++i)
+    {
+        const Uint8 Vis = IsChunkVisibleScalar(Bounds, Planes, i) ? 1 : 0;
+        Visible[i]      = Vis;
+        NumVisible += Vis;
+    }
+    return NumVisible;
+}
+
+} // namespace Diligent
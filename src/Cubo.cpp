@@ -22,9 +22,23 @@ struct TangentVertex
     //float3 bitangent;
 };
 
+static_assert(sizeof(TangentVertex) == GeometryPool::VertexStride, "TangentVertex debe coincidir con el pool");
+
+static constexpr Uint32 CuboIndices[] =
+    {
+        0, 1, 2, 0, 2, 3,
+        4, 5, 6, 4, 6, 7,
+        8, 9, 10, 8, 10, 11,
+        12, 13, 14, 12, 14, 15,
+        16, 17, 18, 16, 18, 19,
+        20, 21, 22, 20, 22, 23};
+
+static void GenerarVerticesCubo(std::vector<TangentVertex>& verts);
+
 Cubo::Cubo(RefCntAutoPtr<IRenderDevice>  device,
            RefCntAutoPtr<IPipelineState> pPSO,
-           std::uint32_t                 id) 
+           std::uint32_t                 id,
+           GeometryPool*                 pGeometryPool) 
 {
     m_id = id;
     m_pDevice = device;
@@ -33,12 +47,41 @@ Cubo::Cubo(RefCntAutoPtr<IRenderDevice>  device,
     //   ATTRIB4: float3 bitangent
     pPSO->CreateShaderResourceBinding(&m_SRB, true);
 
+    if (pGeometryPool != nullptr)
+    {
+        // Todos los cubos son la misma malla: un solo rango compartido en el pool
+        std::vector<TangentVertex> verts;
+        GenerarVerticesCubo(verts);
+        m_pGeometryPool = pGeometryPool;
+        m_Geometry      = pGeometryPool->Allocate("Cubo", verts.data(), static_cast<Uint32>(verts.size()), CuboIndices, _countof(CuboIndices));
+        m_NumIndices    = _countof(CuboIndices);
+        return;
+    }
+
     crearBufferVertices();
     crearBufferIndices();
     
 }
 
 void Cubo::crearBufferVertices()
+{
+    std::vector<TangentVertex> verts;
+    GenerarVerticesCubo(verts);
+
+    /*----------------------------------------------------------*
+     * 5. Crear el vertex buffer                                *
+     *----------------------------------------------------------*/
+    BufferDesc vbDesc;
+    vbDesc.Name      = ("Cubo VB " + std::to_string(m_id)).c_str();
+    vbDesc.Usage     = USAGE_IMMUTABLE;
+    vbDesc.BindFlags = BIND_VERTEX_BUFFER;
+    vbDesc.Size      = static_cast<Uint32>(verts.size() * sizeof(TangentVertex));
+
+    BufferData vbData{verts.data(), vbDesc.Size};
+    m_pDevice->CreateBuffer(vbDesc, &vbData, &m_VertexBuffer);
+}
+
+static void GenerarVerticesCubo(std::vector<TangentVertex>& verts)
 {
     // 1) Define los vrtices raw sin tangentes
     RawVertex rawVerts[24] =
@@ -74,18 +117,10 @@ void Cubo::crearBufferVertices()
             {{+1, -1, -1}, {0, -1, 0}, {1, 0}},
             {{-1, -1, -1}, {0, -1, 0}, {0, 0}}};
 
-    // 2) ndices del cubo
-    Uint32 indices[] =
-        {
-            0, 1, 2, 0, 2, 3,       // frontal
-            4, 5, 6, 4, 6, 7,       // posterior
-            8, 9, 10, 8, 10, 11,    // izquierda
-            12, 13, 14, 12, 14, 15, // derecha
-            16, 17, 18, 16, 18, 19, // superior
-            20, 21, 22, 20, 22, 23  // inferior
-        };
-
-        std::vector<TangentVertex> verts(24);
+    // 2) Indices del cubo: frontal, posterior, izquierda, derecha, superior, inferior
+    const Uint32* indices = CuboIndices;
+
+    verts.resize(24);
     std::vector<float3>        bitanAccum(24, float3{0, 0, 0});
 
     for (int i = 0; i < 24; ++i)
@@ -153,43 +188,22 @@ void Cubo::crearBufferVertices()
         float sign = (dot(B, bitanAccum[i]) < 0.0f) ? -1.0f : 1.0f;
         v.tangent  = float4{T.x, T.y, T.z, sign};
     }
-
-    /*----------------------------------------------------------*
-     * 5. Crear el vertex buffer                                *
-     *----------------------------------------------------------*/
-    BufferDesc vbDesc;
-    vbDesc.Name      = ("Cubo VB " + std::to_string(m_id)).c_str();
-    vbDesc.Usage     = USAGE_IMMUTABLE;
-    vbDesc.BindFlags = BIND_VERTEX_BUFFER;
-    vbDesc.Size      = static_cast<Uint32>(verts.size() * sizeof(TangentVertex));
-
-    BufferData vbData{verts.data(), vbDesc.Size};
-    m_pDevice->CreateBuffer(vbDesc, &vbData, &m_VertexBuffer);
 }
 
 void Cubo::crearBufferIndices()
 {
-    constexpr Uint32 Indices[] =
-        {
-            0, 1, 2, 0, 2, 3,
-            4, 5, 6, 4, 6, 7,
-            8, 9, 10, 8, 10, 11,
-            12, 13, 14, 12, 14, 15,
-            16, 17, 18, 16, 18, 19,
-            20, 21, 22, 20, 22, 23};
-
     BufferDesc IndBuffDesc;
     IndBuffDesc.Name      = ("Cubo index buffer" + std::to_string(m_id)).c_str();
     IndBuffDesc.Usage     = USAGE_IMMUTABLE;
     IndBuffDesc.BindFlags = BIND_INDEX_BUFFER;
-    IndBuffDesc.Size      = sizeof(Indices);
+    IndBuffDesc.Size      = sizeof(CuboIndices);
 
     BufferData IBData;
-    IBData.pData    = Indices;
-    IBData.DataSize = sizeof(Indices);
+    IBData.pData    = CuboIndices;
+    IBData.DataSize = sizeof(CuboIndices);
     m_pDevice->CreateBuffer(IndBuffDesc, &IBData, &m_IndexBuffer);
 
-    m_NumIndices = _countof(Indices);
+    m_NumIndices = _countof(CuboIndices);
 }
 
 
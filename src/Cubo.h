@@ -7,12 +7,16 @@ namespace Diligent
 class Cubo : public Objeto3D
 {
 public:
-    Cubo(RefCntAutoPtr<IRenderDevice> device, RefCntAutoPtr<IPipelineState> m_pPSO, std::uint32_t id);
+    // Con pGeometryPool la malla va al pool compartido en vez de a buffers propios
+    Cubo(RefCntAutoPtr<IRenderDevice> device, RefCntAutoPtr<IPipelineState> m_pPSO, std::uint32_t id, GeometryPool* pGeometryPool = nullptr);
 
     //void Render(RefCntAutoPtr<IDeviceContext>  pContext, RefCntAutoPtr<IPipelineState> m_PSO, float4x4 viewProjection) override;
     void Actualizar(float deltaTime) override;
     void crearBufferVertices() override;
     void crearBufferIndices() override;
     void crearBufferConstante() override;
+
+    // Vertices en [-1, 1]^3: media diagonal = sqrt(3)
+    float GetLocalBoundingRadius() const override { return 1.7320508f; }
 };
 } // namespace Diligent
\ No newline at end of file
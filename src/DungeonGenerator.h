@@ -3,10 +3,13 @@
 #include <random>
 #include <cstdint>
 #include <algorithm>
+#include <memory>
 #include <optional>
 #include <sstream>     
 #include <iostream>    
 #include <fstream> 
+#include "PackedTileGrid.h"
+#include "ThreadPool.h"
 
 
 
@@ -29,49 +32,193 @@ public:
     struct Rect
     {
         int x, y, w, h;
+    };
 
-        // Leaf = todavia no dividido
-        bool IsLeaf() const noexcept { return left == nullptr && right == nullptr; }
+    // Nodo del BSP. Todos viven en un solo vector (GetNodes(), la raiz es el 0),
+    // enlazados por indice y con la sala dentro del propio nodo.
+    struct Node
+    {
+        Rect bounds;
+        Rect room{}; // valida si hasRoom
 
-        // Hijos creados luego de un corte
-        std::unique_ptr<Rect> left;
-        std::unique_ptr<Rect> right;
+        // Hijos creados luego de un corte, -1 = sin hijo
+        int32_t left  = -1;
+        int32_t right = -1;
 
-        
         // Sala final tallada dentro de esta hoja
-        bool                  hasRoom = false;
-        std::unique_ptr<Rect> room;
+        bool hasRoom = false;
+
+        // Leaf = todavia no dividido
+        bool IsLeaf() const noexcept { return left < 0; }
     };
 
-    
+    struct TreeStats
+    {
+        size_t Nodes       = 0;
+        size_t Rooms       = 0;
+        size_t Allocations = 0; // bloques de memoria pedidos para los nodos
+
+        // Con un new por nodo y otro por sala (arbol de unique_ptr)
+        size_t PerNodeAllocations() const noexcept { return Nodes + Rooms; }
+    };
 
-    
-    void Generate(int w, int h, int minLeaf = 8, int maxLeaf = 20, uint32_t seed = std::random_device{}())
+    // Bytes: un Tile por celda. Packed2Bit: 2 bits por celda (PackedTileGrid),
+    // para mazmorras enormes; Row()/GetTiles() solo existen con Bytes.
+    enum class Storage : uint8_t
+    {
+        Bytes,
+        Packed2Bit
+    };
+
+    // Se aplica en el siguiente Generate
+    void    SetStorage(Storage s) noexcept { _storage = s; }
+    Storage GetStorage() const noexcept { return _storage; }
+
+    // pPool = nullptr -> todo en el hilo que llama. El resultado es el mismo
+    // para la misma semilla con cualquier numero de hilos.
+    void Generate(int w, int h, int minLeaf = 8, int maxLeaf = 20, uint32_t seed = std::random_device{}(),
+                  Diligent::ThreadPool* pPool = nullptr)
     {
         Width  = w;
         Height = h;
-        _grid.assign(Height, std::vector<Tile>(Width, Tile::Wall)); // start full of walls
-
-        rng.seed(seed);
-        _root = std::make_unique<Rect>(Rect{0, 0, Width, Height});
+        // start full of walls
+        if (_storage == Storage::Packed2Bit)
+        {
+            _grid.clear();
+            _grid.shrink_to_fit();
+            _packed.Assign(Width, Height, static_cast<uint8_t>(Tile::Wall));
+        }
+        else
+        {
+            _packed = {};
+            _grid.assign(static_cast<size_t>(Width) * Height, Tile::Wall);
+        }
 
-        SplitLeaf(*_root, minLeaf, maxLeaf);
-        CreateRooms(*_root);
-        DigCorridors(*_root);
+        _tree.nodes.clear();
+        _tree.allocations = 0;
+        // Sin reserva para la parte alta: los cortes pueden pelar tiras de solo
+        // minLeaf celdas, asi que su tamano no sale del area / ParallelCells.
+        // Crece sola (son pocos nodos) y MergeSubtrees reserva el total exacto.
+        _tree.Add(Rect{0, 0, Width, Height});
+
+        // La parte alta del arbol se corta en este hilo hasta dejar subarboles de
+        // ParallelCells celdas o menos, y cada subarbol es una tarea. Cada nodo saca
+        // sus numeros de su propio flujo, derivado de (semilla, camino desde la
+        // raiz), asi que da igual que hilo lo procese y en que orden.
+        const uint64_t       rootKey = Mix64(seed);
+        std::vector<Subtree> subtrees;
+        SplitTop(0, rootKey, minLeaf, maxLeaf, subtrees);
+
+        // Cada subarbol en su propio bloque, reservado de una vez: todo nodo mide
+        // al menos minLeaf x minLeaf, asi que no puede haber mas de 2 * area / minLeaf^2
+        ForEachParallel(pPool, subtrees.size(), [&](size_t i) {
+            Subtree&   s      = subtrees[i];
+            const Rect bounds = _tree.nodes[s.root].bounds;
+            s.arena.Reserve(2 * static_cast<size_t>(static_cast<int64_t>(bounds.w) * bounds.h / (static_cast<int64_t>(minLeaf) * minLeaf)) + 1);
+            s.arena.Add(bounds);
+            SplitLeaf(s.arena, 0, s.key, minLeaf, maxLeaf);
+            CreateRooms(s.arena.nodes, 0, s.key, s.fills);
+            DigCorridors(s.arena.nodes, 0, s.key, s.fills, false);
+        });
+        MergeSubtrees(subtrees);
+
+        // Pasillos entre subarboles
+        std::vector<Fill> topFills;
+        DigCorridors(_tree.nodes, 0, rootKey, topFills, true);
+
+        // Los subarboles no se solapan: con un byte por celda cada uno se talla en
+        // su hilo. Empaquetado dos subarboles pueden compartir palabra: en orden.
+        if (_storage == Storage::Bytes)
+            ForEachParallel(pPool, subtrees.size(), [&](size_t i) { ApplyFills(subtrees[i].fills); });
+        else
+            for (const Subtree& s : subtrees)
+                ApplyFills(s.fills);
+        ApplyFills(topFills);
     }
 
-    Tile GetTile(int x, int y) const noexcept { return _grid[y][x]; }
+    Tile GetTile(int x, int y) const noexcept
+    {
+        return _storage == Storage::Packed2Bit ? static_cast<Tile>(_packed.Get(x, y)) : Row(y)[x];
+    }
     int  GetWidth() const noexcept { return Width; }
     int  GetHeight() const noexcept { return Height; }
 
+    // Arbol del ultimo Generate, solo lectura: salas y hojas sin tocar el reparto de memoria
+    const std::vector<Node>& GetNodes() const noexcept { return _tree.nodes; }
+    const TreeStats&         GetTreeStats() const noexcept { return _treeStats; }
+
+    // Un bloque de Philox4x32-10, el de los flujos de cada nodo (lo usan las
+    // pruebas con los vectores conocidos de Random123)
+    static void Philox4x32(const uint32_t ctr[4], const uint32_t key[2], uint32_t out[4]) noexcept { NodeRng::Philox(ctr, key, out); }
+
+    // Rejilla en un solo bloque, fila a fila: la celda (x, y) esta en y * Width + x (solo Storage::Bytes)
+    const Tile*              Row(int y) const noexcept { return _grid.data() + static_cast<size_t>(y) * Width; }
+    const std::vector<Tile>& GetTiles() const noexcept { return _grid; }
+
+    // Copia la fila y en Width tiles, con cualquier Storage
+    void CopyRow(int y, Tile* dst) const noexcept
+    {
+        if (_storage == Storage::Packed2Bit)
+            _packed.ExpandRow(y, reinterpret_cast<uint8_t*>(dst));
+        else
+            std::copy_n(Row(y), Width, dst);
+    }
+
+    size_t CountTiles(Tile t) const noexcept
+    {
+        if (_storage == Storage::Packed2Bit)
+            return _packed.Count(static_cast<uint8_t>(t));
+        return static_cast<size_t>(std::count(_grid.begin(), _grid.end(), t));
+    }
+
+    // FNV-1a de 64 bits de todas las celdas, fila a fila (igual con cualquier Storage)
+    uint64_t HashGrid() const
+    {
+        uint64_t          hash = 0xCBF29CE484222325ull;
+        std::vector<Tile> row(Width);
+        for (int y = 0; y < Height; ++y)
+        {
+            CopyRow(y, row.data());
+            for (Tile t : row)
+                hash = (hash ^ static_cast<uint8_t>(t)) * 0x100000001B3ull;
+        }
+        return hash;
+    }
+
+    size_t GetGridBytes() const noexcept { return _storage == Storage::Packed2Bit ? _packed.GetSizeInBytes() : _grid.size() * sizeof(Tile); }
+
+    // Un bit por celda de tipo t (ver TileBitplane)
+    void ExportBitplane(Tile t, TileBitplane& plane) const
+    {
+        if (_storage == Storage::Packed2Bit)
+        {
+            _packed.ExtractBitplane(static_cast<uint8_t>(t), plane);
+            return;
+        }
+
+        plane.Width       = Width;
+        plane.Height      = Height;
+        plane.WordsPerRow = (static_cast<size_t>(Width) + 63) / 64;
+        plane.Words.assign(plane.WordsPerRow * Height, 0);
+        for (int y = 0; y < Height; ++y)
+        {
+            const Tile* row = Row(y);
+            uint64_t*   dst = plane.Words.data() + static_cast<size_t>(y) * plane.WordsPerRow;
+            for (int x = 0; x < Width; ++x)
+                dst[x / 64] |= static_cast<uint64_t>(row[x] == t) << (x % 64);
+        }
+    }
+
      std::string ToString() const
     {
         std::ostringstream oss;
+        std::vector<Tile> tiles(Width);
+        std::string       line(Width, ' ');
         for (int y = 0; y < Height; ++y)
         {
-            for (int x = 0; x < Width; ++x)
-                oss << TileToChar(GetTile(x, y));
-            oss << '\n';
+            CopyRow(y, tiles.data());
+            std::transform(tiles.begin(), tiles.end(), line.begin(), TileToChar);
+            oss << line << '\n';
         }
         return oss.str();
     }
@@ -90,19 +237,23 @@ public:
 
         ofs << "P6\n"
             << Width << ' ' << Height << "\n255\n";
+        std::vector<unsigned char> rgb(static_cast<size_t>(Width) * 3);
+        std::vector<Tile>          row(Width);
         for (int y = 0; y < Height; ++y)
         {
+            CopyRow(y, row.data());
             for (int x = 0; x < Width; ++x)
             {
-                unsigned char rgb[3];
-                switch (GetTile(x, y))
+                unsigned char c;
+                switch (row[x])
                 {
-                    case Tile::Floor: rgb[0] = rgb[1] = rgb[2] = 200; break; // gris claro
-                    case Tile::Wall: rgb[0] = rgb[1] = rgb[2] = 80; break;   // gris oscuro
-                    default: rgb[0] = rgb[1] = rgb[2] = 0; break;            // negro
+                    case Tile::Floor: c = 200; break; // gris claro
+                    case Tile::Wall: c = 80; break;   // gris oscuro
+                    default: c = 0; break;            // negro
                 }
-                ofs.write(reinterpret_cast<char*>(rgb), 3);
+                rgb[x * 3 + 0] = rgb[x * 3 + 1] = rgb[x * 3 + 2] = c;
             }
+            ofs.write(reinterpret_cast<const char*>(rgb.data()), static_cast<std::streamsize>(rgb.size())); // una escritura por fila
         }
         OutputDebugStringA("Generacin completada :D");
         return true;
@@ -123,23 +274,209 @@ private:
         }
     }
 
-    int                            Width  = 0;
-    int                            Height = 0;
-    std::vector<std::vector<Tile>> _grid;
+    int               Width  = 0;
+    int               Height = 0;
+    std::vector<Tile> _grid; // Width * Height, row-major
+    PackedTileGrid    _packed;
+    Storage           _storage = Storage::Bytes;
 
-    std::mt19937          rng;
-    std::unique_ptr<Rect> _root;
+    // Nodos de un subarbol (o de la parte alta) en un bloque contiguo
+    struct NodeArena
+    {
+        std::vector<Node> nodes;
+        size_t            allocations = 0;
 
-    std::vector<std::vector<Tile>> getGrid() const { return _grid; } 
+        void Reserve(size_t count)
+        {
+            if (count > nodes.capacity())
+            {
+                nodes.reserve(count);
+                ++allocations;
+            }
+        }
 
+        // Puede mover el bloque: no guardar referencias a nodos entre llamadas
+        int32_t Add(const Rect& bounds)
+        {
+            if (nodes.size() == nodes.capacity())
+                ++allocations;
+            nodes.push_back(Node{bounds});
+            return static_cast<int32_t>(nodes.size() - 1);
+        }
+    };
+
+    NodeArena _tree;
+    TreeStats _treeStats;
+
+    Tile* Row(int y) noexcept { return _grid.data() + static_cast<size_t>(y) * Width; }
+
+    // Subarboles de hasta ParallelCells celdas van enteros a una tarea
+    static constexpr int64_t ParallelCells = 512 * 512;
+
+    // Rectangulo a tallar como suelo (sala o tramo de pasillo)
+    struct Fill
+    {
+        int x, y, w, h;
+    };
+
+    struct Subtree
+    {
+        int32_t           root; // indice en _tree
+        uint64_t          key;
+        NodeArena         arena; // el nodo 0 es una copia de la raiz
+        std::vector<Fill> fills;
+    };
+
+    // Philox4x32-10 (Salmon et al., 2011): cifra el contador (bloque, flujo) con la
+    // clave del nodo y da 4 numeros de 32 bits por bloque. Crear un flujo es copiar
+    // la clave (un mt19937 inicializa 624 palabras, demasiado para cientos de miles
+    // de nodos). Range() no usa std::uniform_int_distribution, cuyo resultado
+    // depende de la libreria estandar: la misma semilla da la misma mazmorra con
+    // MSVC, libstdc++ o libc++.
+    struct NodeRng
+    {
+        uint32_t key[2];
+        uint32_t counter[4]; // [0] = bloque, [1..2] = flujo
+        uint32_t block[4] = {};
+        int      used     = 4;
+
+        uint32_t Next() noexcept
+        {
+            if (used == 4)
+            {
+                Philox(counter, key, block);
+                ++counter[0];
+                used = 0;
+            }
+            return block[used++];
+        }
+
+        // Entero uniforme en [lo, hi] sin sesgo (Lemire, 2019): un producto de
+        // 64 bits y, solo si cae en la zona de rechazo, un modulo
+        int Range(int lo, int hi) noexcept
+        {
+            const uint32_t span = static_cast<uint32_t>(hi) - static_cast<uint32_t>(lo) + 1u;
+            if (span == 0)
+                return static_cast<int>(Next()); // [INT_MIN, INT_MAX]
+
+            uint64_t m   = static_cast<uint64_t>(Next()) * span;
+            uint32_t low = static_cast<uint32_t>(m);
+            if (low < span)
+            {
+                const uint32_t threshold = (0u - span) % span;
+                while (low < threshold)
+                {
+                    m   = static_cast<uint64_t>(Next()) * span;
+                    low = static_cast<uint32_t>(m);
+                }
+            }
+            return static_cast<int>(static_cast<uint32_t>(lo) + static_cast<uint32_t>(m >> 32));
+        }
+
+        bool Bool() noexcept { return (Next() >> 31) != 0; }
+
+        static void Philox(const uint32_t ctr[4], const uint32_t k[2], uint32_t out[4]) noexcept
+        {
+            uint32_t c0 = ctr[0], c1 = ctr[1], c2 = ctr[2], c3 = ctr[3];
+            uint32_t k0 = k[0], k1 = k[1];
+            for (int round = 0; round < 10; ++round)
+            {
+                const uint64_t p0 = static_cast<uint64_t>(0xD2511F53u) * c0;
+                const uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57u) * c2;
+
+                c0 = static_cast<uint32_t>(p1 >> 32) ^ c1 ^ k0;
+                c1 = static_cast<uint32_t>(p1);
+                c2 = static_cast<uint32_t>(p0 >> 32) ^ c3 ^ k1;
+                c3 = static_cast<uint32_t>(p0);
+
+                k0 += 0x9E3779B9u;
+                k1 += 0xBB67AE85u;
+            }
+            out[0] = c0;
+            out[1] = c1;
+            out[2] = c2;
+            out[3] = c3;
+        }
+    };
+
+    enum Stream : uint64_t
+    {
+        SplitStream    = 0x53504C4954ull, // "SPLIT"
+        RoomStream     = 0x524F4F4Dull,   // "ROOM"
+        CorridorStream = 0x434F5252ull    // "CORR"
+    };
+
+    static uint64_t Mix64(uint64_t z) noexcept
+    {
+        z += 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    // Clave del hijo izquierdo (0) o derecho (1): la clave es el camino desde la raiz
+    static uint64_t ChildKey(uint64_t key, int side) noexcept { return Mix64(key ^ (side ? 0xA5A5A5A5A5A5A5A5ull : 0x5A5A5A5A5A5A5A5Aull)); }
+    static NodeRng  MakeRng(uint64_t key, Stream stream) noexcept
+    {
+        return NodeRng{{static_cast<uint32_t>(key), static_cast<uint32_t>(key >> 32)},
+                       {0u, static_cast<uint32_t>(stream), static_cast<uint32_t>(stream >> 32), 0u}};
+    }
+
+    static bool IsSubtreeRoot(const Rect& r) noexcept { return static_cast<int64_t>(r.w) * r.h <= ParallelCells; }
+
+    template <typename F>
+    static void ForEachParallel(Diligent::ThreadPool* pPool, size_t count, const F& task)
+    {
+        if (pPool == nullptr)
+        {
+            for (size_t i = 0; i < count; ++i)
+                task(i);
+            return;
+        }
+
+        std::vector<std::future<void>> jobs;
+        jobs.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+            jobs.push_back(pPool->Submit([&task, i] { task(i); }));
+        for (auto& job : jobs)
+            job.wait(); // las tareas usan variables de Generate: esperar a todas antes de relanzar
+        for (auto& job : jobs)
+            job.get();
+    }
+
+    // Parte alta del arbol, en el hilo que llama: corta hasta llegar a subarboles pequenos
+    void SplitTop(int32_t node, uint64_t key, int minLeaf, int maxLeaf, std::vector<Subtree>& subtrees)
+    {
+        if (IsSubtreeRoot(_tree.nodes[node].bounds) || !SplitNode(_tree, node, key, minLeaf, maxLeaf))
+        {
+            subtrees.push_back(Subtree{node, key, {}, {}});
+            return;
+        }
+        SplitTop(_tree.nodes[node].left, ChildKey(key, 0), minLeaf, maxLeaf, subtrees);
+        SplitTop(_tree.nodes[node].right, ChildKey(key, 1), minLeaf, maxLeaf, subtrees);
+    }
 
     // Corte recursido de BPS
-    bool SplitLeaf(Rect& leaf, int minLeaf, int maxLeaf)
+    bool SplitLeaf(NodeArena& arena, int32_t node, uint64_t key, int minLeaf, int maxLeaf)
     {
-        if (!leaf.IsLeaf())
+        if (!arena.nodes[node].IsLeaf())
             return false; // ya cortado
 
-        bool splitH = RandomBool();
+        if (!SplitNode(arena, node, key, minLeaf, maxLeaf))
+            return false;
+
+        SplitLeaf(arena, arena.nodes[node].left, ChildKey(key, 0), minLeaf, maxLeaf);
+        SplitLeaf(arena, arena.nodes[node].right, ChildKey(key, 1), minLeaf, maxLeaf);
+        return true;
+    }
+
+    // Un corte, con el flujo del nodo
+    static bool SplitNode(NodeArena& arena, int32_t node, uint64_t key, int minLeaf, int maxLeaf)
+    {
+        NodeRng    rng  = MakeRng(key, SplitStream);
+        const Rect leaf = arena.nodes[node].bounds; // copia: Add puede mover el bloque
+
+        bool splitH = RandomBool(rng);
         if (leaf.w > leaf.h && leaf.w / leaf.h >= 1.25f)
             splitH = false;
         else if (leaf.h > leaf.w && leaf.h / leaf.w >= 1.25f)
@@ -149,77 +486,115 @@ private:
         if (max <= minLeaf)
             return false; // muy pequeo para cortar
 
-        std::uniform_int_distribution<int> dist(minLeaf, std::min(maxLeaf, max));
-        int                                split = dist(rng);
+        int split = rng.Range(minLeaf, std::min(maxLeaf, max));
 
+        int32_t left, right;
         if (splitH)
         {
-            leaf.left  = std::make_unique<Rect>(Rect{leaf.x, leaf.y, leaf.w, split});
-            leaf.right = std::make_unique<Rect>(Rect{leaf.x, leaf.y + split, leaf.w, leaf.h - split});
+            left  = arena.Add(Rect{leaf.x, leaf.y, leaf.w, split});
+            right = arena.Add(Rect{leaf.x, leaf.y + split, leaf.w, leaf.h - split});
         }
         else
         {
-            leaf.left  = std::make_unique<Rect>(Rect{leaf.x, leaf.y, split, leaf.h});
-            leaf.right = std::make_unique<Rect>(Rect{leaf.x + split, leaf.y, leaf.w - split, leaf.h});
+            left  = arena.Add(Rect{leaf.x, leaf.y, split, leaf.h});
+            right = arena.Add(Rect{leaf.x + split, leaf.y, leaf.w - split, leaf.h});
         }
-
-        SplitLeaf(*leaf.left, minLeaf, maxLeaf);
-        SplitLeaf(*leaf.right, minLeaf, maxLeaf);
+        arena.nodes[node].left  = left;
+        arena.nodes[node].right = right;
         return true;
     }
 
+    // Pasa los subarboles a _tree, en orden de subarbol (no de hilo): el nodo k > 0
+    // del subarbol va detras de los anteriores y su raiz ocupa el sitio que tenia
+    void MergeSubtrees(std::vector<Subtree>& subtrees)
+    {
+        _treeStats       = {};
+        size_t numNodes  = _tree.nodes.size();
+        size_t numAllocs = 0;
+        for (const Subtree& s : subtrees)
+        {
+            numNodes += s.arena.nodes.size() - 1;
+            numAllocs += s.arena.allocations;
+        }
+        _tree.Reserve(numNodes);
+
+        for (Subtree& s : subtrees)
+        {
+            const int32_t base  = static_cast<int32_t>(_tree.nodes.size()) - 1;
+            auto          remap = [base](int32_t k) { return k < 0 ? k : base + k; };
+            for (size_t k = 0; k < s.arena.nodes.size(); ++k)
+            {
+                Node n  = s.arena.nodes[k];
+                n.left  = remap(n.left);
+                n.right = remap(n.right);
+                if (k == 0)
+                    _tree.nodes[s.root] = n;
+                else
+                    _tree.nodes.push_back(n);
+            }
+            s.arena = {}; // libera el bloque del subarbol
+        }
+
+        _treeStats.Nodes       = _tree.nodes.size();
+        _treeStats.Rooms       = static_cast<size_t>(std::count_if(_tree.nodes.begin(), _tree.nodes.end(), [](const Node& n) { return n.hasRoom; }));
+        _treeStats.Allocations = _tree.allocations + numAllocs;
+    }
+
  
     // Tallar una sala en cada hoja
-    void CreateRooms(Rect& leaf)
+    static void CreateRooms(std::vector<Node>& nodes, int32_t node, uint64_t key, std::vector<Fill>& fills)
     {
-        if (!leaf.IsLeaf())
+        if (!nodes[node].IsLeaf())
         {
-            CreateRooms(*leaf.left);
-            CreateRooms(*leaf.right);
+            CreateRooms(nodes, nodes[node].left, ChildKey(key, 0), fills);
+            CreateRooms(nodes, nodes[node].right, ChildKey(key, 1), fills);
             return;
         }
 
+        NodeRng     rng  = MakeRng(key, RoomStream);
+        const Rect& leaf = nodes[node].bounds;
+
         // Room size at least 3x3
-        std::uniform_int_distribution<int> rw(3, leaf.w - 2);
-        std::uniform_int_distribution<int> rh(3, leaf.h - 2);
-        int                                roomW = rw(rng);
-        int                                roomH = rh(rng);
-
-        std::uniform_int_distribution<int> rx(1, leaf.w - roomW - 1);
-        std::uniform_int_distribution<int> ry(1, leaf.h - roomH - 1);
-        int                                roomX = leaf.x + rx(rng);
-        int                                roomY = leaf.y + ry(rng);
-
-        leaf.room = std::make_unique<Rect>(Rect{roomX, roomY, roomW, roomH});
-        leaf.hasRoom = true; 
-
-        for (int y = roomY; y < roomY + roomH; ++y)
-            for (int x = roomX; x < roomX + roomW; ++x)
-                _grid[y][x] = Tile::Floor;
+        int roomW = rng.Range(3, leaf.w - 2);
+        int roomH = rng.Range(3, leaf.h - 2);
+
+        int roomX = leaf.x + rng.Range(1, leaf.w - roomW - 1);
+        int roomY = leaf.y + rng.Range(1, leaf.h - roomH - 1);
+
+        nodes[node].room    = Rect{roomX, roomY, roomW, roomH};
+        nodes[node].hasRoom = true;
+
+        fills.push_back(Fill{roomX, roomY, roomW, roomH});
     }
 
   
-    // Conectar hojas hermanas con un pasillo en forma de L
-    void DigCorridors(Rect& leaf)
+    // Conectar hojas hermanas con un pasillo en forma de L. El pasillo queda
+    // dentro del rectangulo del nodo. stopAtSubtrees: solo la parte alta del
+    // arbol, los subarboles ya tienen sus pasillos.
+    static void DigCorridors(const std::vector<Node>& nodes, int32_t node, uint64_t key, std::vector<Fill>& fills, bool stopAtSubtrees)
     {
-        if (!leaf.left || !leaf.right)
+        const Node& leaf = nodes[node];
+        if (leaf.IsLeaf())
+            return;
+        if (stopAtSubtrees && IsSubtreeRoot(leaf.bounds))
             return;
 
-        DigCorridors(*leaf.left);
-        DigCorridors(*leaf.right);
+        DigCorridors(nodes, leaf.left, ChildKey(key, 0), fills, stopAtSubtrees);
+        DigCorridors(nodes, leaf.right, ChildKey(key, 1), fills, stopAtSubtrees);
 
-        Point p1 = ChoosePointInRoom(*leaf.left);
-        Point p2 = ChoosePointInRoom(*leaf.right);
+        NodeRng rng = MakeRng(key, CorridorStream);
+        Point   p1  = ChoosePointInRoom(nodes, leaf.left, rng);
+        Point   p2  = ChoosePointInRoom(nodes, leaf.right, rng);
 
-        if (RandomBool())
+        if (RandomBool(rng))
         {
-            CarveHorizontal(p1.x, p2.x, p1.y);
-            CarveVertical(p1.y, p2.y, p2.x);
+            CarveHorizontal(p1.x, p2.x, p1.y, fills);
+            CarveVertical(p1.y, p2.y, p2.x, fills);
         }
         else
         {
-            CarveVertical(p1.y, p2.y, p1.x);
-            CarveHorizontal(p1.x, p2.x, p2.y);
+            CarveVertical(p1.y, p2.y, p1.x, fills);
+            CarveHorizontal(p1.x, p2.x, p2.y, fills);
         }
     }
 
@@ -236,38 +611,63 @@ private:
     //    return {dx(rng), dy(rng)};
     //}
 
-    Point ChoosePointInRoom(const Rect& node)
+    static Point ChoosePointInRoom(const std::vector<Node>& nodes, int32_t node, NodeRng& rng)
     {
         // Desciende hasta un hijo con sala
-        const Rect* cur = &node;
+        const Node* cur = &nodes[node];
         while (!cur->hasRoom)
         {
             // ambos hijos existen
-            cur = RandomBool() ? cur->left.get() : cur->right.get();
+            cur = &nodes[RandomBool(rng) ? cur->left : cur->right];
         }
 
-        const Rect&                        r = *cur->room; // aqu s hay sala
-        std::uniform_int_distribution<int> dx(r.x, r.x + r.w - 1);
-        std::uniform_int_distribution<int> dy(r.y, r.y + r.h - 1);
-        return {dx(rng), dy(rng)};
+        const Rect& r = cur->room; // aqu s hay sala
+        const int   x = rng.Range(r.x, r.x + r.w - 1);
+        const int   y = rng.Range(r.y, r.y + r.h - 1);
+        return {x, y};
     }
 
 
-    void CarveHorizontal(int x1, int x2, int y)
+    static void CarveHorizontal(int x1, int x2, int y, std::vector<Fill>& fills)
     {
         if (x2 < x1) std::swap(x1, x2);
-        for (int x = x1; x <= x2; ++x)
-            _grid[y][x] = Tile::Floor;
+        fills.push_back(Fill{x1, y, x2 - x1 + 1, 1});
     }
 
-    void CarveVertical(int y1, int y2, int x)
+    static void CarveVertical(int y1, int y2, int x, std::vector<Fill>& fills)
     {
         if (y2 < y1) std::swap(y1, y2);
-        for (int y = y1; y <= y2; ++y)
-            _grid[y][x] = Tile::Floor;
+        fills.push_back(Fill{x, y1, 1, y2 - y1 + 1});
+    }
+
+    // Todo se talla como suelo, asi que el orden de los Fill no cambia el resultado
+    void ApplyFills(const std::vector<Fill>& fills) noexcept
+    {
+        for (const Fill& f : fills)
+        {
+            if (_storage == Storage::Packed2Bit)
+            {
+                if (f.w == 1)
+                    _packed.FillColumn(f.x, f.y, f.h, static_cast<uint8_t>(Tile::Floor));
+                else
+                    _packed.FillRect(f.x, f.y, f.w, f.h, static_cast<uint8_t>(Tile::Floor));
+            }
+            else if (f.w == 1)
+            {
+                // Columna: mismo bloque, saltando Width celdas por fila
+                Tile* cell = Row(f.y) + f.x;
+                for (int y = 0; y < f.h; ++y, cell += Width)
+                    *cell = Tile::Floor;
+            }
+            else
+            {
+                for (int y = f.y; y < f.y + f.h; ++y)
+                    std::fill_n(Row(y) + f.x, f.w, Tile::Floor);
+            }
+        }
     }
 
-    bool RandomBool() { return std::uniform_int_distribution<int>(0, 1)(rng) == 1; }
+    static bool RandomBool(NodeRng& rng) { return rng.Bool(); }
 
 
 };
@@ -25,7 +25,8 @@ public:
                  POMMaterial*                  pWallMat,
                  float                         tileSize       = 2.0f,
                  float                         wallHeight     = 2.0f,
-                 float                         floorThickness = 0.1f) :
+                 float                         floorThickness = 0.1f,
+                 GeometryPool*                 pGeometryPool  = nullptr) :
         m_pDevice{pDevice},
         m_pPSO{pPSO},
         m_FloorMat{pFloorMat},
@@ -34,8 +35,8 @@ public:
         m_WallHeight{wallHeight},
         m_FloorThickness{floorThickness}
     {
-        // 1 cubo base para TODA la escena
-        m_CubeMesh = std::make_unique<Cubo>(pDevice, pPSO, /*id*/ 0);
+        // 1 cubo base para TODA la escena (con pool, el mismo rango que el resto de cubos)
+        m_CubeMesh = std::make_unique<Cubo>(pDevice, pPSO, /*id*/ 0, pGeometryPool);
     }
 
     /// Genera/actualiza la escena a partir de un DungeonGenerator ya construido
@@ -51,34 +52,47 @@ public:
         const float xOffset = -W * TS * 0.5f + TS * 0.5f;
         const float zOffset = -H * TS * 0.5f + TS * 0.5f;
 
+        // Un bit por celda de suelo y otro por celda de muro: las palabras a 0
+        // (64 celdas vacias) se saltan enteras y solo se visitan los bits a 1
+        TileBitplane floorBits, wallBits;
+        dg.ExportBitplane(DungeonGenerator::Tile::Floor, floorBits);
+        dg.ExportBitplane(DungeonGenerator::Tile::Wall, wallBits);
+
         for (int y = 0; y < H; ++y)
         {
-            for (int x = 0; x < W; ++x)
+            const uint64_t* floorRow = floorBits.Row(y);
+            const uint64_t* wallRow  = wallBits.Row(y);
+            for (size_t w = 0; w < floorBits.WordsPerRow; ++w)
             {
-                auto tile = dg.GetTile(x, y);
-                if (tile == DungeonGenerator::Tile::Empty)
-                    continue;
-
-                float worldX = x * TS + xOffset;
-                float worldZ = y * TS + zOffset;
-
-                float4x4 S, T;
-                if (tile == DungeonGenerator::Tile::Floor)
+                const uint64_t floorWord = floorRow[w];
+                uint64_t       bits      = floorWord | wallRow[w];
+                for (; bits != 0; bits &= bits - 1)
                 {
-                    // escalamos en Y para que sea finito (0.1 * altura muro aprox.)
-                    S = float4x4::Scale(float3{TS * 0.5f, m_FloorThickness * 0.5f, TS * 0.5f});
-                    T = float4x4::Translation(float3{worldX, -m_WallHeight * 0.5f + m_FloorThickness * 0.5f, worldZ});
+                    const int  bit  = LowestSetBit(bits);
+                    const int  x    = static_cast<int>(w) * 64 + bit;
+                    const auto tile = ((floorWord >> bit) & 1) ? DungeonGenerator::Tile::Floor : DungeonGenerator::Tile::Wall;
+
+                    float worldX = x * TS + xOffset;
+                    float worldZ = y * TS + zOffset;
+
+                    float4x4 S, T;
+                    if (tile == DungeonGenerator::Tile::Floor)
+                    {
+                        // escalamos en Y para que sea finito (0.1 * altura muro aprox.)
+                        S = float4x4::Scale(float3{TS * 0.5f, m_FloorThickness * 0.5f, TS * 0.5f});
+                        T = float4x4::Translation(float3{worldX, -m_WallHeight * 0.5f + m_FloorThickness * 0.5f, worldZ});
+                    }
+                    else // Wall
+                    {
+                        S = float4x4::Scale(float3{TS * 0.5f, m_WallHeight * 0.5f, TS * 0.5f});
+                        T = float4x4::Translation(float3{worldX, 0.0f, worldZ});
+                    }
+
+                    TileInstance inst;
+                    inst.World      = S * T;
+                    inst.MaterialId = (tile == DungeonGenerator::Tile::Floor) ? 0u : 1u;
+                    m_Instances.push_back(inst);
                 }
-                else // Wall
-                {
-                    S = float4x4::Scale(float3{TS * 0.5f, m_WallHeight * 0.5f, TS * 0.5f});
-                    T = float4x4::Translation(float3{worldX, 0.0f, worldZ});
-                }
-
-                TileInstance inst;
-                inst.World      = S * T;
-                inst.MaterialId = (tile == DungeonGenerator::Tile::Floor) ? 0u : 1u;
-                m_Instances.push_back(inst);
             }
         }
 
@@ -153,6 +167,8 @@ private:
         DrawIndexedAttribs draw;
         draw.IndexType             = VT_UINT32;
         draw.NumIndices            = m_CubeMesh->GetNumIndices();
+        draw.FirstIndexLocation    = m_CubeMesh->GetFirstIndex();
+        draw.BaseVertex            = m_CubeMesh->GetBaseVertex();
         draw.NumInstances          = static_cast<Uint32>(instanceIndices.size());
         draw.Flags                 = DRAW_FLAG_VERIFY_ALL;
         draw.FirstInstanceLocation = 0; // asumiendo que el instance buffer est ordenado
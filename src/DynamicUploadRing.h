@@ -0,0 +1,151 @@
+#pragma once
+#include "RefCntAutoPtr.hpp"
+#include "RenderDevice.h"
+#include "DeviceContext.h"
+#include "Buffer.h"
+#include <cstring> // std::memcpy
+#include <string>
+
+namespace Diligent
+{
+
+// -----------------------------------------------------------------------------
+// Anillo de subida de datos por draw.
+//   Un unico buffer USAGE_DYNAMIC grande. Cada Upload() copia el bloque al
+//   siguiente hueco alineado y devuelve su offset, que el renderer aplica con
+//   IShaderResourceVariable::SetBufferOffset. El primer Upload del frame (o al
+//   dar la vuelta) mapea con DISCARD; el resto con NO_OVERWRITE, asi nunca se
+//   pisa memoria que la GPU todavia este leyendo.
+//   Al dar la vuelta el DISCARD invalida todos los offsets entregados antes:
+//   un offset solo sirve hasta la siguiente vuelta, por eso se usa en el draw
+//   que sigue a su Upload (RenderQueue sube en Submit, no al grabar).
+//   Si un frame dio la vuelta, el siguiente BeginFrame recrea el buffer con
+//   lo que ese frame necesito; quien lo enlazo con SetBufferRange debe volver
+//   a enlazarlo (BeginFrame devuelve true).
+// -----------------------------------------------------------------------------
+class DynamicUploadRing
+{
+public:
+    struct FrameStats
+    {
+        Uint32 MapCalls      = 0;
+        Uint64 BytesUploaded = 0;
+        Uint32 Wraps         = 0; // veces que el anillo se lleno dentro del frame
+        Uint32 Grows         = 0; // el buffer se recreo mas grande al terminar el frame
+    };
+
+    void Initialize(IRenderDevice* pDevice,
+                    const char*    Name,
+                    Uint64         Size,
+                    BIND_FLAGS     BindFlags,
+                    Uint32         Alignment)
+    {
+        m_pDevice   = pDevice;
+        m_Name      = Name;
+        m_BindFlags = BindFlags;
+        m_Alignment = Alignment > 0 ? Alignment : 16;
+        CreateBuffer(Size);
+    }
+
+    // Llamar una vez al inicio de cada frame. Devuelve true si el buffer se
+    // recreo mas grande (el frame anterior dio la vuelta): hay que volver a
+    // enlazar GetBuffer() en las variables que lo usan
+    bool BeginFrame()
+    {
+        bool Grew = false;
+        if (m_Stats.Wraps > 0)
+        {
+            // Lo que uso el frame: cada vuelta lleno el anillo, mas lo de la ultima
+            const Uint64 Needed  = Uint64{m_Stats.Wraps} * m_Size + m_Offset;
+            Uint64       NewSize = m_Size * 2;
+            while (NewSize < Needed)
+                NewSize *= 2;
+            CreateBuffer(NewSize);
+            ++m_Stats.Grows;
+            Grew = true;
+        }
+
+        m_LastStats   = m_Stats;
+        m_Stats       = {};
+        m_NeedDiscard = true;
+        return Grew;
+    }
+
+    // Copia Size bytes al anillo y devuelve el offset donde quedaron
+    Uint32 Upload(IDeviceContext* pCtx, const void* pData, Uint32 Size)
+    {
+        const Uint64 AlignedSize = GetAlignedSize(Size);
+        if (!m_NeedDiscard && m_Offset + AlignedSize > m_Size)
+        {
+            ++m_Stats.Wraps;
+            m_NeedDiscard = true;
+        }
+
+        const MAP_FLAGS Flags = m_NeedDiscard ? MAP_FLAG_DISCARD : MAP_FLAG_NO_OVERWRITE;
+        if (m_NeedDiscard)
+        {
+            m_Offset      = 0;
+            m_NeedDiscard = false;
+        }
+
+        PVoid pMapped = nullptr;
+        pCtx->MapBuffer(m_pBuffer, MAP_WRITE, Flags, pMapped);
+        std::memcpy(static_cast<Uint8*>(pMapped) + m_Offset, pData, Size);
+        pCtx->UnmapBuffer(m_pBuffer, MAP_WRITE);
+
+        ++m_Stats.MapCalls;
+        m_Stats.BytesUploaded += Size;
+
+        const Uint32 Offset = static_cast<Uint32>(m_Offset);
+        m_Offset += AlignedSize;
+        return Offset;
+    }
+
+    template <typename T>
+    Uint32 Upload(IDeviceContext* pCtx, const T& Data)
+    {
+        return Upload(pCtx, &Data, static_cast<Uint32>(sizeof(T)));
+    }
+
+    // Tamano del rango que se debe pasar a SetBufferRange para un bloque de Size bytes
+    Uint32 GetAlignedSize(Uint32 Size) const
+    {
+        return (Size + m_Alignment - 1) / m_Alignment * m_Alignment;
+    }
+
+    IBuffer*          GetBuffer() const { return m_pBuffer; }
+    Uint64            GetSize() const { return m_Size; }
+    const FrameStats& GetStats() const { return m_Stats; } // frame en curso
+    const FrameStats& GetLastFrameStats() const { return m_LastStats; }
+
+private:
+    void CreateBuffer(Uint64 Size)
+    {
+        BufferDesc Desc;
+        Desc.Name           = m_Name.c_str();
+        Desc.Size           = Size;
+        Desc.Usage          = USAGE_DYNAMIC;
+        Desc.BindFlags      = m_BindFlags;
+        Desc.CPUAccessFlags = CPU_ACCESS_WRITE;
+        m_pBuffer.Release();
+        m_pDevice->CreateBuffer(Desc, nullptr, &m_pBuffer);
+
+        m_Size        = Size;
+        m_Offset      = 0;
+        m_NeedDiscard = true;
+    }
+
+    IRenderDevice*         m_pDevice   = nullptr;
+    std::string            m_Name;
+    BIND_FLAGS             m_BindFlags = BIND_NONE;
+    RefCntAutoPtr<IBuffer> m_pBuffer;
+    Uint64                 m_Size        = 0;
+    Uint64                 m_Offset      = 0;
+    Uint32                 m_Alignment   = 16;
+    bool                   m_NeedDiscard = true;
+
+    FrameStats m_Stats;
+    FrameStats m_LastStats;
+};
+
+} // namespace Diligent
@@ -8,7 +8,10 @@
 #include "MapHelper.hpp"
 #include "BasicMath.hpp"
 #include <vector>
+#include <algorithm>
+#include <cmath>
 #include "POMMaterial.h"
+#include "GeometryPool.h"
 #include <Windows.h>
 
 
@@ -39,18 +42,32 @@ protected:
     std::vector<std::unique_ptr<Objeto3D>> m_Children;
     std::uint32_t                          m_NumIndices;
     POMMaterial *                        m_Material = nullptr; // Material asociado al objeto
+    GeometryPool*                          m_pGeometryPool = nullptr; // != nullptr: la malla vive en el pool
+    GeometryRange                          m_Geometry;
 
 
 
 
 
 public:
+    virtual ~Objeto3D()
+    {
+        if (m_pGeometryPool != nullptr)
+            m_pGeometryPool->Release(m_Geometry);
+    }
+
     void      SetPosition(const float3& pos) { m_Posicion = pos; }
     void      SetRotation(const float3& rot) { m_Rotacion = rot; }
     void      SetScale(const float3& scale) { m_Escala = scale; }
-    IBuffer*  GetVertexBuffer() { return m_VertexBuffer; }
-    IBuffer*  GetIndexBuffer() { return m_IndexBuffer; }
+    IBuffer*  GetVertexBuffer() { return m_pGeometryPool != nullptr ? m_pGeometryPool->GetVertexBuffer() : m_VertexBuffer.RawPtr(); }
+    IBuffer*  GetIndexBuffer() { return m_pGeometryPool != nullptr ? m_pGeometryPool->GetIndexBuffer() : m_IndexBuffer.RawPtr(); }
     int       GetNumIndices() { return m_NumIndices; }
+    // Offsets del draw: 0 con buffers propios, el rango del pool si no
+    Uint32    GetFirstIndex() const { return m_Geometry.FirstIndex; }
+    Uint32    GetBaseVertex() const { return m_Geometry.BaseVertex; }
+    // Descuantizacion de las posiciones del rango (identidad en formato
+    // float): va delante de la matriz de mundo al dibujar
+    float4x4  GetMeshTransform() const { return m_Geometry.GetDequantTransform(); }
 
     const std::vector<std::unique_ptr<Objeto3D>>& getChildren() const { return m_Children; }
     float3                                        getPosition() { return m_Posicion; }
@@ -88,18 +105,28 @@ public:
         return nullptr;
     }
 
+    // Esfera envolvente en mundo. m_Posicion ya va dentro de la transformacion,
+    // asi que el centro es el origen local transformado.
     virtual float3 GetBoundingSphereCenter() const
     {
-        float4 localCenter = float4(m_Posicion, 1.0f);
-        float4 worldCenter = localCenter * GetWorldTransform();
+        float4 worldCenter = float4(0.0f, 0.0f, 0.0f, 1.0f) * GetWorldTransform();
         return float3{worldCenter.x, worldCenter.y, worldCenter.z};
     }
 
     virtual float GetBoundingSphereRadius() const
     {
-        // Por defecto, retorna un valor fijo o calcula en funcin de la escala.
-        // Por ejemplo:
-        return 1.0f; // Ajusta segn el tamao del objeto.
+        // Radio local escalado por el eje mas estirado de la transformacion
+        const float4x4 W = GetWorldTransform();
+        float          maxScale2 = 0.0f;
+        for (int r = 0; r < 3; ++r)
+            maxScale2 = (std::max)(maxScale2, W.m[r][0] * W.m[r][0] + W.m[r][1] * W.m[r][1] + W.m[r][2] * W.m[r][2]);
+        return GetLocalBoundingRadius() * std::sqrt(maxScale2);
+    }
+
+    // Radio de la malla en espacio local (cada figura sabe su tamano)
+    virtual float GetLocalBoundingRadius() const
+    {
+        return 1.0f;
     }
 
 
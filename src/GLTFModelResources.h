@@ -0,0 +1,171 @@
+#pragma once
+#include "StaticModel.h"
+#include "RefCntAutoPtr.hpp"
+#include "RenderDevice.h"
+#include "PipelineState.h"
+#include "ShaderResourceBinding.h"
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Diligent
+{
+
+// Recursos de dibujo de un material: su propio SRB con texturas, shadow map y
+// constantes por draw ya enlazadas.
+struct GLTFMaterialResources
+{
+    RefCntAutoPtr<IShaderResourceBinding> SRB;
+    IShaderResourceVariable*              pConstantsVar = nullptr; // "Constants" (world), offset por draw
+    IShaderResourceVariable*              pMaterialVar  = nullptr; // "materialConstants", offset por draw
+    Uint32                                SortId        = 0;       // indice global, va en la clave de la cola
+
+    // Mismo material para el PSO instanciado: world por instancia, sin "Constants"
+    RefCntAutoPtr<IShaderResourceBinding> InstancedSRB;
+    IShaderResourceVariable*              pInstancedMaterialVar = nullptr;
+};
+
+// -----------------------------------------------------------------------------
+// Recursos por modelo creados una sola vez al cargar el modelo.
+//   Cada material recibe un SRB propio; dibujar una primitiva se reduce a un
+//   CommitShaderResources de ese SRB, sin busquedas por nombre en el hot path.
+//   Los atributos que el material no trae se cubren con texturas por defecto.
+//   Los nodos con malla y sus matrices globales ya vienen del cooker
+//   (StaticModel::GetMeshNodes).
+// -----------------------------------------------------------------------------
+class GLTFModelResources
+{
+public:
+    // Lo que comparten todos los SRB de todos los modelos
+    struct SharedBindings
+    {
+        IBuffer*      pConstantRing      = nullptr;
+        Uint64        ConstantsRangeSize = 0; // sizeof(ConstantsData) alineado
+        Uint64        MaterialRangeSize  = 0; // sizeof(materialConstants) alineado
+        ITextureView* pShadowMapSRV      = nullptr;
+
+        std::vector<std::pair<const char*, ITextureView*>> DefaultTextures; // variable del PS -> vista
+    };
+
+    // pInstancedPSO (opcional): variante con la matriz de mundo por instancia;
+    // cada material recibe tambien un SRB para ella
+    void Create(const StaticModel&                                  Model,
+                IPipelineState*                                     pPSO,
+                IPipelineState*                                     pInstancedPSO,
+                Uint32                                              ModelId,
+                Uint32&                                             NextSortId,
+                const std::unordered_map<std::string, std::string>& TexAttrToVar,
+                const SharedBindings&                               Shared)
+    {
+        m_ModelId = ModelId;
+        m_Materials.clear();
+        m_Materials.resize(Model.GetNumMaterials());
+
+        for (Uint32 m = 0; m < Model.GetNumMaterials(); ++m)
+        {
+            const auto& Mat = Model.GetMaterial(m);
+            auto&       Res = m_Materials[m];
+            Res.SortId      = NextSortId++;
+
+            CreateMaterialSRB(Mat, pPSO, TexAttrToVar, Shared, Res.SRB);
+
+            Res.pConstantsVar = Res.SRB->GetVariableByName(SHADER_TYPE_VERTEX, "Constants");
+            Res.pMaterialVar  = Res.SRB->GetVariableByName(SHADER_TYPE_PIXEL, "materialConstants");
+
+            if (pInstancedPSO != nullptr)
+            {
+                CreateMaterialSRB(Mat, pInstancedPSO, TexAttrToVar, Shared, Res.InstancedSRB);
+                Res.pInstancedMaterialVar = Res.InstancedSRB->GetVariableByName(SHADER_TYPE_PIXEL, "materialConstants");
+            }
+        }
+        BindConstantRing(Shared);
+    }
+
+    // Enlaza las constantes por draw al anillo. Se repite cuando el anillo se
+    // recrea mas grande; solo se usan pConstantRing y los tamanos de rango
+    void BindConstantRing(const SharedBindings& Shared)
+    {
+        for (auto& Res : m_Materials)
+        {
+            Res.pConstantsVar->SetBufferRange(Shared.pConstantRing, 0, Shared.ConstantsRangeSize);
+            Res.pMaterialVar->SetBufferRange(Shared.pConstantRing, 0, Shared.MaterialRangeSize);
+            if (Res.pInstancedMaterialVar != nullptr)
+                Res.pInstancedMaterialVar->SetBufferRange(Shared.pConstantRing, 0, Shared.MaterialRangeSize);
+        }
+    }
+
+    // Textura 1x1 de un color (RGBA8, little endian: 0xAABBGGRR) para rellenar
+    // los atributos que falten. Es Texture2DArray como las de StaticModel.
+    static RefCntAutoPtr<ITexture> CreateSolidTexture(IRenderDevice* pDevice, const char* Name, Uint32 RGBA)
+    {
+        TextureDesc Desc;
+        Desc.Name      = Name;
+        Desc.Type      = RESOURCE_DIM_TEX_2D_ARRAY;
+        Desc.Width     = 1;
+        Desc.Height    = 1;
+        Desc.ArraySize = 1;
+        Desc.MipLevels = 1;
+        Desc.Format    = TEX_FORMAT_RGBA8_UNORM;
+        Desc.Usage     = USAGE_IMMUTABLE;
+        Desc.BindFlags = BIND_SHADER_RESOURCE;
+
+        TextureSubResData SubRes;
+        SubRes.pData  = &RGBA;
+        SubRes.Stride = sizeof(RGBA);
+
+        TextureData InitData;
+        InitData.pSubResources   = &SubRes;
+        InitData.NumSubresources = 1;
+
+        RefCntAutoPtr<ITexture> pTex;
+        pDevice->CreateTexture(Desc, &InitData, &pTex);
+        return pTex;
+    }
+
+    Uint32                       GetModelId() const { return m_ModelId; }
+    size_t                       GetNumMaterials() const { return m_Materials.size(); }
+    const GLTFMaterialResources& GetMaterial(Uint32 MaterialId) const { return m_Materials[MaterialId]; }
+
+private:
+    // SRB de un material para pPSO: texturas (o las por defecto) y shadow map
+    static void CreateMaterialSRB(const StaticModel::Material&                        Mat,
+                                  IPipelineState*                                     pPSO,
+                                  const std::unordered_map<std::string, std::string>& TexAttrToVar,
+                                  const SharedBindings&                               Shared,
+                                  RefCntAutoPtr<IShaderResourceBinding>&              SRB)
+    {
+        pPSO->CreateShaderResourceBinding(&SRB, true);
+
+        for (const auto& Default : Shared.DefaultTextures)
+        {
+            if (auto* pVar = SRB->GetVariableByName(SHADER_TYPE_PIXEL, Default.first))
+                pVar->Set(Default.second);
+        }
+
+        for (Uint32 Slot = 0; Slot < COOKED_TEXTURE_SLOT_COUNT; ++Slot)
+        {
+            auto* pTex = Mat.pTextures[Slot];
+            if (pTex == nullptr)
+                continue;
+
+            auto NameIt = TexAttrToVar.find(CookedTextureSlotNames[Slot]);
+            if (NameIt == TexAttrToVar.end())
+                continue;
+
+            auto* pVar = SRB->GetVariableByName(SHADER_TYPE_PIXEL, NameIt->second.c_str());
+            if (pVar == nullptr)
+                continue;
+
+            pVar->Set(pTex->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE), SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
+        }
+
+        if (auto* pVar = SRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_ShadowMap"))
+            pVar->Set(Shared.pShadowMapSRV);
+    }
+
+    Uint32                             m_ModelId = 0;
+    std::vector<GLTFMaterialResources> m_Materials;
+};
+
+} // namespace Diligent
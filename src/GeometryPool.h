@@ -0,0 +1,363 @@
+#pragma once
+#include "RefCntAutoPtr.hpp"
+#include "RenderDevice.h"
+#include "DeviceContext.h"
+#include "Buffer.h"
+#include "VertexQuantization.h"
+#include <algorithm>
+#include <cstring> // std::memcpy
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Diligent
+{
+
+// Donde vive una malla dentro del pool: se dibuja con
+// DrawIndexedAttribs{NumIndices, FirstIndexLocation = FirstIndex, BaseVertex}
+struct GeometryRange
+{
+    Uint32 BaseVertex  = 0;
+    Uint32 NumVertices = 0;
+    Uint32 FirstIndex  = 0;
+    Uint32 NumIndices  = 0;
+    float4 PosDequant  = {0, 0, 0, 1}; // caja de cuantizacion (centro, escala); identidad en formato float
+
+    bool IsValid() const { return NumIndices > 0; }
+
+    // Anteponer a la matriz de mundo de la malla (o del nodo) al dibujar
+    float4x4 GetDequantTransform() const { return VertexQuantizer::GetDequantTransform(PosDequant); }
+};
+
+// -----------------------------------------------------------------------------
+// Sub-asignador first-fit de rangos [Offset, Offset + Size) en unidades
+// (vertices o indices). Los huecos se guardan ordenados por offset y se
+// funden con sus vecinos al liberar.
+// -----------------------------------------------------------------------------
+class RangeAllocator
+{
+public:
+    static constexpr Uint32 InvalidOffset = ~0u;
+
+    void Reset(Uint32 Capacity)
+    {
+        m_Free.clear();
+        m_Capacity = 0;
+        m_Used     = 0;
+        Grow(Capacity);
+    }
+
+    // Anade [Capacidad actual, NewCapacity) como hueco al final
+    void Grow(Uint32 NewCapacity)
+    {
+        if (NewCapacity <= m_Capacity)
+            return;
+        if (!m_Free.empty() && m_Free.back().Offset + m_Free.back().Size == m_Capacity)
+            m_Free.back().Size += NewCapacity - m_Capacity;
+        else
+            m_Free.push_back({m_Capacity, NewCapacity - m_Capacity});
+        m_Capacity = NewCapacity;
+    }
+
+    Uint32 Allocate(Uint32 Size)
+    {
+        for (size_t i = 0; i < m_Free.size(); ++i)
+        {
+            Block& B = m_Free[i];
+            if (B.Size < Size)
+                continue;
+
+            const Uint32 Offset = B.Offset;
+            B.Offset += Size;
+            B.Size -= Size;
+            if (B.Size == 0)
+                m_Free.erase(m_Free.begin() + i);
+            m_Used += Size;
+            return Offset;
+        }
+        return InvalidOffset;
+    }
+
+    void Free(Uint32 Offset, Uint32 Size)
+    {
+        auto it = std::lower_bound(m_Free.begin(), m_Free.end(), Offset,
+                                   [](const Block& B, Uint32 Off) { return B.Offset < Off; });
+        it = m_Free.insert(it, {Offset, Size});
+        m_Used -= Size;
+
+        // Fundir con el siguiente y con el anterior
+        auto next = it + 1;
+        if (next != m_Free.end() && it->Offset + it->Size == next->Offset)
+        {
+            it->Size += next->Size;
+            m_Free.erase(next);
+        }
+        if (it != m_Free.begin())
+        {
+            auto prev = it - 1;
+            if (prev->Offset + prev->Size == it->Offset)
+            {
+                prev->Size += it->Size;
+                m_Free.erase(it);
+            }
+        }
+    }
+
+    Uint32 GetCapacity() const { return m_Capacity; }
+    Uint32 GetUsed() const { return m_Used; }
+    Uint32 GetNumFreeBlocks() const { return static_cast<Uint32>(m_Free.size()); }
+
+private:
+    struct Block
+    {
+        Uint32 Offset;
+        Uint32 Size;
+    };
+    std::vector<Block> m_Free; // ordenados por Offset
+    Uint32             m_Capacity = 0;
+    Uint32             m_Used     = 0;
+};
+
+// -----------------------------------------------------------------------------
+// Pool de geometria estatica: un VB y un IB grandes compartidos por todas las
+// mallas (cubos, piso combinado, modelos GLTF cocinados). Cada malla es un
+// GeometryRange; con todo en los mismos buffers la escena enlaza la geometria
+// una vez por pase y solo cambian FirstIndex/BaseVertex entre draws, que es lo
+// que necesita un multi-draw o un draw indirecto.
+//   Allocate() solo reserva el rango y copia los datos a una cola; Flush(), en
+//   el render thread antes de dibujar, crece los buffers si hizo falta
+//   (CopyBuffer de lo que ya habia) y sube lo pendiente con UpdateBuffer.
+//   Con Key no vacia las mallas iguales se comparten por referencia.
+//   En MESH_VERTEX_FORMAT_COMPACT los vertices se cuantizan en Allocate()
+//   (20 bytes en vez de 48) y cada rango trae su PosDequant; la conversion
+//   se comprueba contra los float de entrada (GetStats().Quantization).
+// -----------------------------------------------------------------------------
+class GeometryPool
+{
+public:
+    static constexpr Uint32 VertexStride = sizeof(FloatMeshVertex); // vertice de entrada (TangentVertex / TileVertex / CookedVertex)
+
+    struct Stats
+    {
+        Uint32 Allocations   = 0; // rangos vivos
+        Uint32 SharedHits    = 0; // Allocate() resueltos con una malla ya presente
+        Uint32 Grows         = 0; // veces que se recrearon los buffers
+        Uint32 FreeBlocks    = 0; // huecos (VB + IB): fragmentacion
+        Uint64 UploadedBytes = 0;
+        Uint64 FloatBytes    = 0; // lo que habrian ocupado esos vertices en float
+
+        VertexQuantizer::ErrorStats Quantization; // solo COMPACT
+        Uint32                      QuantizationFailures = 0; // mallas fuera de tolerancia
+    };
+
+    void Initialize(IRenderDevice* pDevice, Uint32 VertexCapacity, Uint32 IndexCapacity, MESH_VERTEX_FORMAT Format = MESH_VERTEX_FORMAT_FLOAT)
+    {
+        m_pDevice         = pDevice;
+        m_Format          = Format;
+        m_GPUVertexStride = VertexQuantizer::GetVertexStride(Format);
+        m_Vertices.Reset((std::max)(VertexCapacity, 1u));
+        m_Indices.Reset((std::max)(IndexCapacity, 1u));
+        m_pVertexBuffer.Release();
+        m_pIndexBuffer.Release();
+        m_Allocations.clear();
+        m_SharedByKey.clear();
+        m_Pending.clear();
+        m_Stats = {};
+    }
+
+    template <typename VertexType>
+    GeometryRange Allocate(const std::string& Key, const VertexType* pVertices, Uint32 NumVertices, const Uint32* pIndices, Uint32 NumIndices)
+    {
+        static_assert(sizeof(VertexType) == VertexStride, "El pool solo acepta vertices de 48 bytes");
+        return AllocateRaw(Key, pVertices, NumVertices, pIndices, NumIndices);
+    }
+
+    void Release(const GeometryRange& Range)
+    {
+        auto it = m_Allocations.find(Range.FirstIndex);
+        if (!Range.IsValid() || it == m_Allocations.end())
+            return;
+        if (--it->second.RefCount > 0)
+            return;
+
+        if (!it->second.Key.empty())
+            m_SharedByKey.erase(it->second.Key);
+        m_Pending.erase(std::remove_if(m_Pending.begin(), m_Pending.end(),
+                                       [&](const PendingUpload& P) { return P.FirstIndex == Range.FirstIndex; }),
+                        m_Pending.end());
+
+        m_Vertices.Free(Range.BaseVertex, Range.NumVertices);
+        m_Indices.Free(Range.FirstIndex, Range.NumIndices);
+        m_Allocations.erase(it);
+    }
+
+    // Render thread, antes de grabar draws: a partir de aqui GetVertexBuffer()
+    // y GetIndexBuffer() son validos para este frame (pueden cambiar al crecer)
+    void Flush(IDeviceContext* pCtx)
+    {
+        if (m_pDevice == nullptr)
+            return;
+
+        const Uint64 VBSize = Uint64{m_Vertices.GetCapacity()} * m_GPUVertexStride;
+        const Uint64 IBSize = Uint64{m_Indices.GetCapacity()} * sizeof(Uint32);
+        const bool   Grew   = (m_pVertexBuffer && m_pVertexBuffer->GetDesc().Size < VBSize) ||
+            (m_pIndexBuffer && m_pIndexBuffer->GetDesc().Size < IBSize);
+        ResizeBuffer(pCtx, m_pVertexBuffer, "Geometry pool VB", BIND_VERTEX_BUFFER, VBSize);
+        ResizeBuffer(pCtx, m_pIndexBuffer, "Geometry pool IB", BIND_INDEX_BUFFER, IBSize);
+        if (Grew)
+            ++m_Stats.Grows;
+
+        for (const auto& P : m_Pending)
+        {
+            const Uint32 VBBytes = static_cast<Uint32>(P.Vertices.size());
+            const Uint32 IBBytes = static_cast<Uint32>(P.Indices.size() * sizeof(Uint32));
+            pCtx->UpdateBuffer(m_pVertexBuffer, Uint64{P.BaseVertex} * m_GPUVertexStride, VBBytes, P.Vertices.data(),
+                               RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+            pCtx->UpdateBuffer(m_pIndexBuffer, Uint64{P.FirstIndex} * sizeof(Uint32), IBBytes, P.Indices.data(),
+                               RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+            m_Stats.UploadedBytes += VBBytes + IBBytes;
+        }
+        m_Pending.clear();
+    }
+
+    IBuffer* GetVertexBuffer() const { return m_pVertexBuffer; }
+    IBuffer* GetIndexBuffer() const { return m_pIndexBuffer; }
+    bool     HasPending() const { return !m_Pending.empty(); }
+
+    MESH_VERTEX_FORMAT GetVertexFormat() const { return m_Format; }
+    Uint32             GetGPUVertexStride() const { return m_GPUVertexStride; }
+
+    Uint32 GetUsedVertices() const { return m_Vertices.GetUsed(); }
+    Uint32 GetVertexCapacity() const { return m_Vertices.GetCapacity(); }
+    Uint32 GetUsedIndices() const { return m_Indices.GetUsed(); }
+    Uint32 GetIndexCapacity() const { return m_Indices.GetCapacity(); }
+
+    const Stats& GetStats()
+    {
+        m_Stats.Allocations = static_cast<Uint32>(m_Allocations.size());
+        m_Stats.FreeBlocks  = m_Vertices.GetNumFreeBlocks() + m_Indices.GetNumFreeBlocks();
+        return m_Stats;
+    }
+
+private:
+    GeometryRange AllocateRaw(const std::string& Key, const void* pVertices, Uint32 NumVertices, const Uint32* pIndices, Uint32 NumIndices)
+    {
+        if (NumVertices == 0 || NumIndices == 0)
+            return {};
+
+        if (!Key.empty())
+        {
+            auto shared = m_SharedByKey.find(Key);
+            if (shared != m_SharedByKey.end())
+            {
+                Allocation& A = m_Allocations[shared->second];
+                ++A.RefCount;
+                ++m_Stats.SharedHits;
+                return A.Range;
+            }
+        }
+
+        GeometryRange Range;
+        Range.NumVertices = NumVertices;
+        Range.NumIndices  = NumIndices;
+        Range.BaseVertex  = AllocateGrowing(m_Vertices, NumVertices);
+        Range.FirstIndex  = AllocateGrowing(m_Indices, NumIndices);
+
+        PendingUpload P;
+        P.BaseVertex = Range.BaseVertex;
+        P.FirstIndex = Range.FirstIndex;
+        P.Vertices.resize(size_t{NumVertices} * m_GPUVertexStride);
+        if (m_Format == MESH_VERTEX_FORMAT_COMPACT)
+            Range.PosDequant = Quantize(static_cast<const FloatMeshVertex*>(pVertices), NumVertices, P.Vertices.data());
+        else
+            std::memcpy(P.Vertices.data(), pVertices, P.Vertices.size());
+        m_Stats.FloatBytes += Uint64{NumVertices} * VertexStride;
+        P.Indices.assign(pIndices, pIndices + NumIndices);
+        m_Pending.push_back(std::move(P));
+
+        // FirstIndex identifica el rango: los rangos de indices no se solapan
+        m_Allocations[Range.FirstIndex] = {Key, Range, 1};
+        if (!Key.empty())
+            m_SharedByKey[Key] = Range.FirstIndex;
+        return Range;
+    }
+
+    // Cuantiza y comprueba el resultado decodificado contra los float
+    float4 Quantize(const FloatMeshVertex* pSrc, Uint32 NumVertices, Uint8* pDst)
+    {
+        auto* pCompact = reinterpret_cast<CompactMeshVertex*>(pDst);
+
+        const float4 Dequant = VertexQuantizer::ComputeDequant(pSrc, NumVertices);
+        VertexQuantizer::Encode(pSrc, NumVertices, Dequant, pCompact);
+
+        const auto Error = VertexQuantizer::Measure(pSrc, pCompact, NumVertices, Dequant);
+        m_Stats.Quantization.Merge(Error);
+        if (!VertexQuantizer::IsWithinTolerance(Error))
+            ++m_Stats.QuantizationFailures;
+        return Dequant;
+    }
+
+    // Sin hueco suficiente: se dobla la capacidad (como minimo lo justo para
+    // Count). Los buffers de GPU se recrean en el siguiente Flush()
+    static Uint32 AllocateGrowing(RangeAllocator& Allocator, Uint32 Count)
+    {
+        Uint32 Offset = Allocator.Allocate(Count);
+        if (Offset == RangeAllocator::InvalidOffset)
+        {
+            Allocator.Grow((std::max)(Allocator.GetCapacity() * 2, Allocator.GetCapacity() + Count));
+            Offset = Allocator.Allocate(Count);
+        }
+        return Offset;
+    }
+
+    void ResizeBuffer(IDeviceContext* pCtx, RefCntAutoPtr<IBuffer>& pBuffer, const char* Name, BIND_FLAGS BindFlags, Uint64 Size)
+    {
+        if (pBuffer && pBuffer->GetDesc().Size >= Size)
+            return;
+
+        BufferDesc Desc;
+        Desc.Name      = Name;
+        Desc.Usage     = USAGE_DEFAULT;
+        Desc.BindFlags = BindFlags;
+        Desc.Size      = Size;
+        RefCntAutoPtr<IBuffer> pNewBuffer;
+        m_pDevice->CreateBuffer(Desc, nullptr, &pNewBuffer);
+
+        // Lo ya subido se copia en GPU; lo pendiente se sube despues encima
+        if (pBuffer)
+        {
+            pCtx->CopyBuffer(pBuffer, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION,
+                             pNewBuffer, 0, pBuffer->GetDesc().Size, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        }
+        pBuffer = pNewBuffer;
+    }
+
+    struct Allocation
+    {
+        std::string   Key;
+        GeometryRange Range;
+        Uint32        RefCount = 0;
+    };
+
+    struct PendingUpload
+    {
+        Uint32              BaseVertex = 0;
+        Uint32              FirstIndex = 0;
+        std::vector<Uint8>  Vertices;
+        std::vector<Uint32> Indices;
+    };
+
+    IRenderDevice*                          m_pDevice         = nullptr;
+    MESH_VERTEX_FORMAT                      m_Format          = MESH_VERTEX_FORMAT_FLOAT;
+    Uint32                                  m_GPUVertexStride = VertexStride;
+    RefCntAutoPtr<IBuffer>                  m_pVertexBuffer;
+    RefCntAutoPtr<IBuffer>                  m_pIndexBuffer;
+    RangeAllocator                          m_Vertices;
+    RangeAllocator                          m_Indices;
+    std::unordered_map<Uint32, Allocation>  m_Allocations; // por FirstIndex
+    std::unordered_map<std::string, Uint32> m_SharedByKey;
+    std::vector<PendingUpload>              m_Pending;
+    Stats                                   m_Stats;
+};
+
+} // namespace Diligent
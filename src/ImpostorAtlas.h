@@ -0,0 +1,525 @@
+// ImpostorAtlas.h
+#pragma once
+
+#include "RenderDevice.h"
+#include "DeviceContext.h"
+#include "RefCntAutoPtr.hpp"
+#include "Texture.h"
+#include "MapHelper.hpp"
+#include "BasicMath.hpp"
+#include "StaticModel.h"
+#include "VertexQuantization.h"
+#include "ShaderSourceFactoryUtils.hpp"
+#include "Utilities/interface/DiligentFXShaderSourceStreamFactory.hpp"
+#include <algorithm>
+#include <chrono>
+#include <unordered_map>
+#include <vector>
+#include <string>
+
+
+namespace Diligent
+{
+
+// Un impostor en el instance buffer: esfera del modelo en mundo y los ejes del
+// modelo en mundo (unitarios, la escala va en el radio). Axis0.w = slice
+struct ImpostorInstance
+{
+    float4 CenterRadius;
+    float4 Axis0;
+    float4 Axis1;
+    float4 Axis2;
+};
+
+struct ImpostorBakeConstants
+{
+    float4x4 g_World;         // nodo -> modelo (incluye la descuantizacion)
+    float4x4 g_FrameViewProj; // ortografica de la vista del frame
+};
+
+
+/* Atlas de impostores octaedricos: un slice por modelo con una rejilla de
+   FramesPerSide x FramesPerSide vistas ortograficas de su esfera. La vista
+   (i, j) mira desde la direccion que decodifica el octaedro en ese punto de
+   la rejilla (Impostor.fxh hace lo mismo en el VS). Dos Texture2DArray:
+     albedo:       rgb + cobertura en a
+     normal/depth: normal en espacio del modelo * 0.5 + 0.5, a = profundidad
+                   en la esfera (0 = el punto mas cercano a la vista)
+   En runtime todos los impostores van en un draw instanciado: un quad de 4
+   vertices (sin VB, SV_VertexID) por instancia orientado a la vista del
+   frame mas cercano a la camara. */
+class ImpostorAtlas
+{
+public:
+    static constexpr Uint32 FramesPerSide = 8;
+    static constexpr Uint32 FrameSize     = 64; // texels por vista
+    static constexpr Uint32 AtlasSize     = FramesPerSide * FrameSize;
+    static constexpr Uint32 MaxSlices     = 32; // modelos con impostor a la vez
+    static constexpr Uint32 MaxInstances  = 4096; // por Map del instance buffer
+
+    struct Stats
+    {
+        Uint32 BakedModels = 0;
+        Uint32 Failed      = 0; // atlas lleno
+        double BakeMs      = 0; // CPU de grabar los bakes (acumulado)
+    };
+
+    ImpostorAtlas() = default;
+
+    // Crea las texturas y los dos PSO. RTVFormat/DSVFormat son los del pase
+    // principal; FrameConstants y cbLightAttribs los del frame (estaticos)
+    void Initialize(IRenderDevice* pDevice, TEXTURE_FORMAT RTVFormat, TEXTURE_FORMAT DSVFormat, MESH_VERTEX_FORMAT VertexFormat,
+                    IBuffer* pFrameConstants, IBuffer* pLightAttribs)
+    {
+        TextureDesc Desc;
+        Desc.Type      = RESOURCE_DIM_TEX_2D_ARRAY;
+        Desc.Width     = AtlasSize;
+        Desc.Height    = AtlasSize;
+        Desc.ArraySize = MaxSlices;
+        Desc.MipLevels = 1;
+        Desc.Format    = TEX_FORMAT_RGBA8_UNORM;
+        Desc.Usage     = USAGE_DEFAULT;
+        Desc.BindFlags = BIND_SHADER_RESOURCE | BIND_RENDER_TARGET;
+
+        Desc.Name = "Impostor albedo atlas";
+        pDevice->CreateTexture(Desc, nullptr, &m_pAlbedo);
+        Desc.Name = "Impostor normal/depth atlas";
+        pDevice->CreateTexture(Desc, nullptr, &m_pNormalDepth);
+
+        TextureDesc DepthDesc;
+        DepthDesc.Name      = "Impostor bake depth";
+        DepthDesc.Type      = RESOURCE_DIM_TEX_2D;
+        DepthDesc.Width     = AtlasSize;
+        DepthDesc.Height    = AtlasSize;
+        DepthDesc.Format    = TEX_FORMAT_D32_FLOAT;
+        DepthDesc.Usage     = USAGE_DEFAULT;
+        DepthDesc.BindFlags = BIND_DEPTH_STENCIL;
+        pDevice->CreateTexture(DepthDesc, nullptr, &m_pBakeDepth);
+
+        // Albedo por defecto de los materiales sin textura (como el de gltf.psh)
+        TextureDesc WhiteDesc;
+        WhiteDesc.Name      = "Impostor default albedo";
+        WhiteDesc.Type      = RESOURCE_DIM_TEX_2D_ARRAY;
+        WhiteDesc.Width     = 1;
+        WhiteDesc.Height    = 1;
+        WhiteDesc.ArraySize = 1;
+        WhiteDesc.Format    = TEX_FORMAT_RGBA8_UNORM;
+        WhiteDesc.Usage     = USAGE_IMMUTABLE;
+        WhiteDesc.BindFlags = BIND_SHADER_RESOURCE;
+
+        const Uint32      White = 0xFFFFFFFFu;
+        TextureSubResData WhiteMip;
+        WhiteMip.pData  = &White;
+        WhiteMip.Stride = sizeof(White);
+        TextureData WhiteData;
+        WhiteData.pSubResources   = &WhiteMip;
+        WhiteData.NumSubresources = 1;
+        pDevice->CreateTexture(WhiteDesc, &WhiteData, &m_pWhite);
+
+        BufferDesc CBDesc;
+        CBDesc.Name           = "Impostor bake constants";
+        CBDesc.Size           = sizeof(ImpostorBakeConstants);
+        CBDesc.Usage          = USAGE_DYNAMIC;
+        CBDesc.BindFlags      = BIND_UNIFORM_BUFFER;
+        CBDesc.CPUAccessFlags = CPU_ACCESS_WRITE;
+        pDevice->CreateBuffer(CBDesc, nullptr, &m_pBakeConstants);
+
+        BufferDesc InstDesc;
+        InstDesc.Name           = "Impostor instances";
+        InstDesc.Size           = sizeof(ImpostorInstance) * MaxInstances;
+        InstDesc.Usage          = USAGE_DYNAMIC;
+        InstDesc.BindFlags      = BIND_VERTEX_BUFFER;
+        InstDesc.CPUAccessFlags = CPU_ACCESS_WRITE;
+        pDevice->CreateBuffer(InstDesc, nullptr, &m_pInstanceBuffer);
+
+        InitializePSOs(pDevice, RTVFormat, DSVFormat, VertexFormat, pFrameConstants, pLightAttribs);
+    }
+
+    // Direccion (espacio del modelo, hacia la camara) de la vista (i, j):
+    // decodificacion octaedrica de la rejilla con los bordes incluidos
+    static float3 GetFrameDirection(Uint32 i, Uint32 j)
+    {
+        const float ex = static_cast<float>(i) / (FramesPerSide - 1) * 2.f - 1.f;
+        const float ey = static_cast<float>(j) / (FramesPerSide - 1) * 2.f - 1.f;
+
+        float3      n{ex, ey, 1.f - std::abs(ex) - std::abs(ey)};
+        const float t = (std::max)(-n.z, 0.f);
+        n.x += n.x >= 0.f ? -t : t;
+        n.y += n.y >= 0.f ? -t : t;
+        return n / length(n);
+    }
+
+    // Base de la vista que mira en -Dir. Misma construccion que ImpostorFrameBasis
+    static void GetFrameBasis(const float3& Dir, float3& Right, float3& Up)
+    {
+        const float3 Fwd = Dir * -1.f;
+        const float3 Up0 = std::abs(Dir.y) > 0.99f ? float3{0, 0, 1} : float3{0, 1, 0};
+        Right            = cross(Up0, Fwd);
+        Right            = Right / length(Right);
+        Up               = cross(Fwd, Right);
+    }
+
+    // Ortografica de la esfera vista desde Dir: x, y en [-1, 1] sobre el
+    // radio, z en [0, 1] de delante a atras
+    static float4x4 GetFrameViewProj(const float3& Dir, const float4& Sphere)
+    {
+        float3 Right, Up;
+        GetFrameBasis(Dir, Right, Up);
+        const float3 Fwd = Dir * -1.f;
+        const float3 C{Sphere.x, Sphere.y, Sphere.z};
+        const float  R  = (std::max)(Sphere.w, 1e-4f);
+        const float  R2 = 2.f * R;
+
+        // clang-format off
+        return float4x4{
+            Right.x / R,         Up.x / R,         Fwd.x / R2,             0.f,
+            Right.y / R,         Up.y / R,         Fwd.y / R2,             0.f,
+            Right.z / R,         Up.z / R,         Fwd.z / R2,             0.f,
+            -dot(C, Right) / R, -dot(C, Up) / R,   (R - dot(C, Fwd)) / R2, 1.f};
+        // clang-format on
+    }
+
+    // Hornea las FramesPerSide^2 vistas del modelo en un slice libre. La
+    // geometria tiene que estar ya en el GPU (despues del Flush del pool).
+    // Cambia los render targets y el viewport. false si el atlas esta lleno.
+    bool Bake(IDeviceContext* pCtx, const StaticModel& Model)
+    {
+        if (m_Slices.count(&Model) != 0)
+            return true;
+        if (Model.GetMeshNodes().empty() || Model.GetBoundingSphere().w <= 0.f)
+            return false;
+
+        const int Slice = AllocateSlice();
+        if (Slice < 0)
+        {
+            ++m_Stats.Failed;
+            OutputDebugStringA(("Impostor: atlas lleno, " + Model.GetName() + " se queda con su LOD mas simple\n").c_str());
+            return false;
+        }
+
+        const auto tStart = std::chrono::high_resolution_clock::now();
+
+        RefCntAutoPtr<ITextureView> pAlbedoRTV, pNormalRTV;
+        {
+            TextureViewDesc ViewDesc;
+            ViewDesc.ViewType        = TEXTURE_VIEW_RENDER_TARGET;
+            ViewDesc.TextureDim      = RESOURCE_DIM_TEX_2D_ARRAY;
+            ViewDesc.FirstArraySlice = static_cast<Uint32>(Slice);
+            ViewDesc.NumArraySlices  = 1;
+            m_pAlbedo->CreateView(ViewDesc, &pAlbedoRTV);
+            m_pNormalDepth->CreateView(ViewDesc, &pNormalRTV);
+        }
+        ITextureView* pRTVs[] = {pAlbedoRTV, pNormalRTV};
+        auto*         pDSV    = m_pBakeDepth->GetDefaultView(TEXTURE_VIEW_DEPTH_STENCIL);
+
+        const float Zero[4] = {};
+        pCtx->SetRenderTargets(2, pRTVs, pDSV, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        pCtx->ClearRenderTarget(pRTVs[0], Zero, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        pCtx->ClearRenderTarget(pRTVs[1], Zero, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        pCtx->ClearDepthStencil(pDSV, CLEAR_DEPTH_FLAG, 1.f, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+        // Un SRB por material solo mientras dura el bake
+        std::vector<RefCntAutoPtr<IShaderResourceBinding>> MaterialSRBs(Model.GetNumMaterials());
+        for (Uint32 m = 0; m < Model.GetNumMaterials(); ++m)
+        {
+            ITexture* pTex = Model.GetMaterial(m).pTextures[COOKED_TEXTURE_SLOT_BASE_COLOR];
+            m_pBakePSO->CreateShaderResourceBinding(&MaterialSRBs[m], true);
+            MaterialSRBs[m]->GetVariableByName(SHADER_TYPE_PIXEL, "g_Albedo")->Set((pTex != nullptr ? pTex : m_pWhite.RawPtr())->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE));
+        }
+
+        IBuffer* pVBs[]    = {Model.GetVertexBuffer()};
+        Uint64   Offsets[] = {0};
+        pCtx->SetPipelineState(m_pBakePSO);
+        pCtx->SetVertexBuffers(0, 1, pVBs, Offsets, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, SET_VERTEX_BUFFERS_FLAG_RESET);
+        pCtx->SetIndexBuffer(Model.GetIndexBuffer(), 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+        const float4& Sphere = Model.GetBoundingSphere();
+        for (Uint32 j = 0; j < FramesPerSide; ++j)
+        {
+            for (Uint32 i = 0; i < FramesPerSide; ++i)
+            {
+                Viewport VP;
+                VP.TopLeftX = static_cast<float>(i * FrameSize);
+                VP.TopLeftY = static_cast<float>(j * FrameSize);
+                VP.Width    = static_cast<float>(FrameSize);
+                VP.Height   = static_cast<float>(FrameSize);
+                pCtx->SetViewports(1, &VP, AtlasSize, AtlasSize);
+
+                const float4x4 FrameViewProj = GetFrameViewProj(GetFrameDirection(i, j), Sphere);
+                for (const auto& Node : Model.GetMeshNodes())
+                {
+                    {
+                        MapHelper<ImpostorBakeConstants> CB(pCtx, m_pBakeConstants, MAP_WRITE, MAP_FLAG_DISCARD);
+                        CB->g_World         = Node.GlobalMatrix;
+                        CB->g_FrameViewProj = FrameViewProj;
+                    }
+                    for (const auto& Prim : Node.pMesh->Primitives)
+                    {
+                        pCtx->CommitShaderResources(MaterialSRBs[Prim.MaterialId], RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+                        const auto&        Range = Prim.GetLod(0);
+                        DrawIndexedAttribs DrawAttrs;
+                        DrawAttrs.IndexType          = VT_UINT32;
+                        DrawAttrs.NumIndices         = Range.IndexCount;
+                        DrawAttrs.FirstIndexLocation = Range.FirstIndex;
+                        DrawAttrs.BaseVertex         = Model.GetBaseVertex();
+                        DrawAttrs.Flags              = DRAW_FLAG_VERIFY_ALL;
+                        pCtx->DrawIndexed(DrawAttrs);
+                    }
+                }
+            }
+        }
+
+        m_Slices[&Model] = Slice;
+        ++m_Stats.BakedModels;
+        const std::chrono::duration<double, std::milli> Elapsed = std::chrono::high_resolution_clock::now() - tStart;
+        m_Stats.BakeMs += Elapsed.count();
+        return true;
+    }
+
+    // El slice queda libre para el siguiente bake (modelo descargado o recocinado)
+    void Release(const StaticModel* pModel)
+    {
+        auto it = m_Slices.find(pModel);
+        if (it == m_Slices.end())
+            return;
+        m_FreeSlices.push_back(it->second);
+        m_Slices.erase(it);
+    }
+
+    // -1 si el modelo no tiene impostor
+    int GetSlice(const StaticModel* pModel) const
+    {
+        auto it = m_Slices.find(pModel);
+        return it != m_Slices.end() ? it->second : -1;
+    }
+
+    // World = matriz del placement. La esfera del modelo se lleva a mundo con
+    // la escala mayor de sus ejes
+    static ImpostorInstance MakeInstance(const float4x4& World, const float4& ModelSphere, int Slice)
+    {
+        const float3 Center = float4{ModelSphere.x, ModelSphere.y, ModelSphere.z, 1.f} * World;
+
+        float3 Axes[3] = {{World._11, World._12, World._13}, {World._21, World._22, World._23}, {World._31, World._32, World._33}};
+        float  Scale   = 0.f;
+        for (int a = 0; a < 3; ++a)
+        {
+            const float L = length(Axes[a]);
+            Scale         = (std::max)(Scale, L);
+            Axes[a]       = L > 0.f ? Axes[a] / L : Axes[a];
+        }
+
+        ImpostorInstance Inst;
+        Inst.CenterRadius = float4{Center, ModelSphere.w * Scale};
+        Inst.Axis0        = float4{Axes[0], static_cast<float>(Slice)};
+        Inst.Axis1        = float4{Axes[1], 0.f};
+        Inst.Axis2        = float4{Axes[2], 0.f};
+        return Inst;
+    }
+
+    // Todos los impostores en un draw instanciado (uno por cada MaxInstances).
+    // Los render targets del pase principal ya tienen que estar puestos
+    Uint32 Draw(IDeviceContext* pCtx, const std::vector<ImpostorInstance>& Instances)
+    {
+        if (Instances.empty())
+            return 0;
+
+        pCtx->SetPipelineState(m_pPSO);
+        pCtx->CommitShaderResources(m_pSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+        Uint32 NumDraws = 0;
+        for (size_t First = 0; First < Instances.size(); First += MaxInstances)
+        {
+            const Uint32 Count = static_cast<Uint32>((std::min)(Instances.size() - First, size_t{MaxInstances}));
+            {
+                MapHelper<ImpostorInstance> Data(pCtx, m_pInstanceBuffer, MAP_WRITE, MAP_FLAG_DISCARD);
+                std::copy(Instances.begin() + First, Instances.begin() + First + Count, static_cast<ImpostorInstance*>(Data));
+            }
+
+            IBuffer* pVBs[]    = {m_pInstanceBuffer};
+            Uint64   Offsets[] = {0};
+            pCtx->SetVertexBuffers(0, 1, pVBs, Offsets, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, SET_VERTEX_BUFFERS_FLAG_RESET);
+
+            DrawAttribs DrawAttrs;
+            DrawAttrs.NumVertices  = 4;
+            DrawAttrs.NumInstances = Count;
+            DrawAttrs.Flags        = DRAW_FLAG_VERIFY_ALL;
+            pCtx->Draw(DrawAttrs);
+            ++NumDraws;
+        }
+        return NumDraws;
+    }
+
+    Uint32       GetNumSlicesUsed() const { return static_cast<Uint32>(m_Slices.size()); }
+    const Stats& GetStats() const { return m_Stats; }
+
+private:
+    void InitializePSOs(IRenderDevice* pDevice, TEXTURE_FORMAT RTVFormat, TEXTURE_FORMAT DSVFormat, MESH_VERTEX_FORMAT VertexFormat,
+                        IBuffer* pFrameConstants, IBuffer* pLightAttribs)
+    {
+        ShaderCreateInfo ShaderCI;
+        ShaderCI.SourceLanguage                  = SHADER_SOURCE_LANGUAGE_HLSL;
+        ShaderCI.CompileFlags                    = SHADER_COMPILE_FLAG_PACK_MATRIX_ROW_MAJOR;
+        ShaderCI.Desc.UseCombinedTextureSamplers = true;
+
+        RefCntAutoPtr<IShaderSourceInputStreamFactory> pShaderSourceFactory;
+        pDevice->GetEngineFactory()->CreateDefaultShaderSourceStreamFactory(nullptr, &pShaderSourceFactory);
+        auto*                                          pFXRaw = &DiligentFXShaderSourceStreamFactory::GetInstance();
+        RefCntAutoPtr<IShaderSourceInputStreamFactory> pFXFactory{pFXRaw};
+        RefCntAutoPtr<IShaderSourceInputStreamFactory> pCompound = CreateCompoundShaderSourceFactory({pShaderSourceFactory, pFXFactory});
+        ShaderCI.pShaderSourceStreamFactory                      = pCompound;
+
+        const std::string FramesPerSideStr = std::to_string(FramesPerSide);
+        ShaderMacro       Macros[]         = {{"COMPACT_VERTEX", VertexFormat == MESH_VERTEX_FORMAT_COMPACT ? "1" : "0"},
+                                              {"IMPOSTOR_FRAMES", FramesPerSideStr.c_str()}};
+        ShaderCI.Macros                    = {Macros, _countof(Macros)};
+        ShaderCI.EntryPoint                = "main";
+
+        SamplerDesc SamLinearClampDesc{
+            FILTER_TYPE_LINEAR, FILTER_TYPE_LINEAR, FILTER_TYPE_LINEAR,
+            TEXTURE_ADDRESS_CLAMP, TEXTURE_ADDRESS_CLAMP, TEXTURE_ADDRESS_CLAMP};
+        SamplerDesc SamLinearWrapDesc{
+            FILTER_TYPE_LINEAR, FILTER_TYPE_LINEAR, FILTER_TYPE_LINEAR,
+            TEXTURE_ADDRESS_WRAP, TEXTURE_ADDRESS_WRAP, TEXTURE_ADDRESS_WRAP};
+
+        // ---------------------------- Bake ----------------------------
+        {
+            RefCntAutoPtr<IShader> pVS, pPS;
+            ShaderCI.Desc.ShaderType = SHADER_TYPE_VERTEX;
+            ShaderCI.Desc.Name       = "Impostor bake VS";
+            ShaderCI.FilePath        = "ImpostorBake.vsh";
+            pDevice->CreateShader(ShaderCI, &pVS);
+
+            ShaderCI.Desc.ShaderType = SHADER_TYPE_PIXEL;
+            ShaderCI.Desc.Name       = "Impostor bake PS";
+            ShaderCI.FilePath        = "ImpostorBake.psh";
+            pDevice->CreateShader(ShaderCI, &pPS);
+
+            GraphicsPipelineStateCreateInfo PSOCreateInfo;
+            PSOCreateInfo.PSODesc.Name         = "Impostor bake PSO";
+            PSOCreateInfo.PSODesc.PipelineType = PIPELINE_TYPE_GRAPHICS;
+
+            PSOCreateInfo.GraphicsPipeline.NumRenderTargets             = 2;
+            PSOCreateInfo.GraphicsPipeline.RTVFormats[0]                = m_pAlbedo->GetDesc().Format;
+            PSOCreateInfo.GraphicsPipeline.RTVFormats[1]                = m_pNormalDepth->GetDesc().Format;
+            PSOCreateInfo.GraphicsPipeline.DSVFormat                    = m_pBakeDepth->GetDesc().Format;
+            PSOCreateInfo.GraphicsPipeline.PrimitiveTopology            = PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+            PSOCreateInfo.GraphicsPipeline.RasterizerDesc.CullMode      = CULL_MODE_NONE;
+            PSOCreateInfo.GraphicsPipeline.DepthStencilDesc.DepthEnable = True;
+
+            LayoutElement LayoutElems[] =
+                {
+                    LayoutElement{0, 0, 3, VT_FLOAT32, False},
+                    LayoutElement{1, 0, 3, VT_FLOAT32, False},
+                    LayoutElement{2, 0, 2, VT_FLOAT32, False},
+                    LayoutElement{3, 0, 4, VT_FLOAT32, False},
+                };
+            VertexQuantizer::WriteVertexLayout(VertexFormat, LayoutElems);
+            PSOCreateInfo.GraphicsPipeline.InputLayout.LayoutElements = LayoutElems;
+            PSOCreateInfo.GraphicsPipeline.InputLayout.NumElements    = _countof(LayoutElems);
+
+            PSOCreateInfo.pVS = pVS;
+            PSOCreateInfo.pPS = pPS;
+
+            ShaderResourceVariableDesc Vars[] =
+                {
+                    {SHADER_TYPE_PIXEL, "g_Albedo", SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE}};
+            ImmutableSamplerDesc ImtblSamplers[] =
+                {
+                    {SHADER_TYPE_PIXEL, "g_Albedo", SamLinearWrapDesc}};
+            PSOCreateInfo.PSODesc.ResourceLayout.DefaultVariableType  = SHADER_RESOURCE_VARIABLE_TYPE_STATIC;
+            PSOCreateInfo.PSODesc.ResourceLayout.Variables            = Vars;
+            PSOCreateInfo.PSODesc.ResourceLayout.NumVariables         = _countof(Vars);
+            PSOCreateInfo.PSODesc.ResourceLayout.ImmutableSamplers    = ImtblSamplers;
+            PSOCreateInfo.PSODesc.ResourceLayout.NumImmutableSamplers = _countof(ImtblSamplers);
+
+            pDevice->CreateGraphicsPipelineState(PSOCreateInfo, &m_pBakePSO);
+            m_pBakePSO->GetStaticVariableByName(SHADER_TYPE_VERTEX, "ImpostorBakeConstants")->Set(m_pBakeConstants);
+        }
+
+        // --------------------------- Runtime ---------------------------
+        {
+            RefCntAutoPtr<IShader> pVS, pPS;
+            ShaderCI.Desc.ShaderType = SHADER_TYPE_VERTEX;
+            ShaderCI.Desc.Name       = "Impostor VS";
+            ShaderCI.FilePath        = "Impostor.vsh";
+            pDevice->CreateShader(ShaderCI, &pVS);
+
+            ShaderCI.Desc.ShaderType = SHADER_TYPE_PIXEL;
+            ShaderCI.Desc.Name       = "Impostor PS";
+            ShaderCI.FilePath        = "Impostor.psh";
+            pDevice->CreateShader(ShaderCI, &pPS);
+
+            GraphicsPipelineStateCreateInfo PSOCreateInfo;
+            PSOCreateInfo.PSODesc.Name         = "Impostor PSO";
+            PSOCreateInfo.PSODesc.PipelineType = PIPELINE_TYPE_GRAPHICS;
+
+            PSOCreateInfo.GraphicsPipeline.NumRenderTargets             = 1;
+            PSOCreateInfo.GraphicsPipeline.RTVFormats[0]                = RTVFormat;
+            PSOCreateInfo.GraphicsPipeline.DSVFormat                    = DSVFormat;
+            PSOCreateInfo.GraphicsPipeline.PrimitiveTopology            = PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+            PSOCreateInfo.GraphicsPipeline.RasterizerDesc.CullMode      = CULL_MODE_NONE;
+            PSOCreateInfo.GraphicsPipeline.DepthStencilDesc.DepthEnable = True;
+
+            // Solo datos por instancia: las esquinas del quad salen de SV_VertexID
+            constexpr Uint32 InstanceStride = sizeof(ImpostorInstance);
+            LayoutElement    LayoutElems[] =
+                {
+                    LayoutElement{0, 0, 4, VT_FLOAT32, False, LAYOUT_ELEMENT_AUTO_OFFSET, InstanceStride, INPUT_ELEMENT_FREQUENCY_PER_INSTANCE},
+                    LayoutElement{1, 0, 4, VT_FLOAT32, False, LAYOUT_ELEMENT_AUTO_OFFSET, InstanceStride, INPUT_ELEMENT_FREQUENCY_PER_INSTANCE},
+                    LayoutElement{2, 0, 4, VT_FLOAT32, False, LAYOUT_ELEMENT_AUTO_OFFSET, InstanceStride, INPUT_ELEMENT_FREQUENCY_PER_INSTANCE},
+                    LayoutElement{3, 0, 4, VT_FLOAT32, False, LAYOUT_ELEMENT_AUTO_OFFSET, InstanceStride, INPUT_ELEMENT_FREQUENCY_PER_INSTANCE},
+                };
+            PSOCreateInfo.GraphicsPipeline.InputLayout.LayoutElements = LayoutElems;
+            PSOCreateInfo.GraphicsPipeline.InputLayout.NumElements    = _countof(LayoutElems);
+
+            PSOCreateInfo.pVS = pVS;
+            PSOCreateInfo.pPS = pPS;
+
+            ImmutableSamplerDesc ImtblSamplers[] =
+                {
+                    {SHADER_TYPE_PIXEL, "g_ImpostorAlbedo", SamLinearClampDesc},
+                    {SHADER_TYPE_PIXEL, "g_ImpostorNormalDepth", SamLinearClampDesc}};
+            PSOCreateInfo.PSODesc.ResourceLayout.DefaultVariableType  = SHADER_RESOURCE_VARIABLE_TYPE_STATIC;
+            PSOCreateInfo.PSODesc.ResourceLayout.ImmutableSamplers    = ImtblSamplers;
+            PSOCreateInfo.PSODesc.ResourceLayout.NumImmutableSamplers = _countof(ImtblSamplers);
+
+            pDevice->CreateGraphicsPipelineState(PSOCreateInfo, &m_pPSO);
+            m_pPSO->GetStaticVariableByName(SHADER_TYPE_VERTEX, "FrameConstants")->Set(pFrameConstants);
+            m_pPSO->GetStaticVariableByName(SHADER_TYPE_PIXEL, "cbLightAttribs")->Set(pLightAttribs);
+            m_pPSO->GetStaticVariableByName(SHADER_TYPE_PIXEL, "g_ImpostorAlbedo")->Set(m_pAlbedo->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE));
+            m_pPSO->GetStaticVariableByName(SHADER_TYPE_PIXEL, "g_ImpostorNormalDepth")->Set(m_pNormalDepth->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE));
+            m_pPSO->CreateShaderResourceBinding(&m_pSRB, true);
+        }
+    }
+
+    int AllocateSlice()
+    {
+        if (!m_FreeSlices.empty())
+        {
+            const int Slice = m_FreeSlices.back();
+            m_FreeSlices.pop_back();
+            return Slice;
+        }
+        if (m_NextSlice >= MaxSlices)
+            return -1;
+        return static_cast<int>(m_NextSlice++);
+    }
+
+    RefCntAutoPtr<ITexture>               m_pAlbedo;
+    RefCntAutoPtr<ITexture>               m_pNormalDepth;
+    RefCntAutoPtr<ITexture>               m_pBakeDepth;
+    RefCntAutoPtr<ITexture>               m_pWhite;
+    RefCntAutoPtr<IBuffer>                m_pBakeConstants;
+    RefCntAutoPtr<IBuffer>                m_pInstanceBuffer;
+    RefCntAutoPtr<IPipelineState>         m_pBakePSO;
+    RefCntAutoPtr<IPipelineState>         m_pPSO;
+    RefCntAutoPtr<IShaderResourceBinding> m_pSRB;
+
+    std::unordered_map<const StaticModel*, int> m_Slices;
+    std::vector<int>                            m_FreeSlices;
+    Uint32                                      m_NextSlice = 0;
+    Stats                                       m_Stats;
+};
+
+} // namespace Diligent
@@ -0,0 +1,121 @@
+#pragma once
+#include "BasicTypes.h"
+#include <cstddef>
+#include <string>
+
+#ifdef _WIN32
+#    ifndef WIN32_LEAN_AND_MEAN
+#        define WIN32_LEAN_AND_MEAN
+#    endif
+#    include <Windows.h>
+#else
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+namespace Diligent
+{
+
+// -----------------------------------------------------------------------------
+// Fichero de solo lectura proyectado en memoria.
+//   El SO pagina el contenido bajo demanda: leer un blob de la cache no copia
+//   nada hasta que se toca, y CreateBuffer/CreateTexture pueden tomar los
+//   punteros directamente como datos iniciales.
+// -----------------------------------------------------------------------------
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile() { Close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool Open(const std::string& Path)
+    {
+        Close();
+#ifdef _WIN32
+        m_hFile = CreateFileA(Path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (m_hFile == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER Size{};
+        if (!GetFileSizeEx(m_hFile, &Size) || Size.QuadPart == 0)
+        {
+            Close();
+            return false;
+        }
+        m_Size = static_cast<size_t>(Size.QuadPart);
+
+        m_hMapping = CreateFileMappingA(m_hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (m_hMapping == nullptr)
+        {
+            Close();
+            return false;
+        }
+        m_pData = static_cast<const Uint8*>(MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0));
+#else
+        m_FD = open(Path.c_str(), O_RDONLY);
+        if (m_FD < 0)
+            return false;
+
+        struct stat St = {};
+        if (fstat(m_FD, &St) != 0 || St.st_size == 0)
+        {
+            Close();
+            return false;
+        }
+        m_Size = static_cast<size_t>(St.st_size);
+
+        void* pData = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, m_FD, 0);
+        m_pData     = pData != MAP_FAILED ? static_cast<const Uint8*>(pData) : nullptr;
+#endif
+        if (m_pData == nullptr)
+        {
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    void Close()
+    {
+#ifdef _WIN32
+        if (m_pData != nullptr)
+            UnmapViewOfFile(m_pData);
+        if (m_hMapping != nullptr)
+            CloseHandle(m_hMapping);
+        if (m_hFile != INVALID_HANDLE_VALUE)
+            CloseHandle(m_hFile);
+        m_hMapping = nullptr;
+        m_hFile    = INVALID_HANDLE_VALUE;
+#else
+        if (m_pData != nullptr)
+            munmap(const_cast<Uint8*>(m_pData), m_Size);
+        if (m_FD >= 0)
+            close(m_FD);
+        m_FD = -1;
+#endif
+        m_pData = nullptr;
+        m_Size  = 0;
+    }
+
+    bool         IsOpen() const { return m_pData != nullptr; }
+    const Uint8* GetData() const { return m_pData; }
+    size_t       GetSize() const { return m_Size; }
+
+private:
+#ifdef _WIN32
+    HANDLE m_hFile    = INVALID_HANDLE_VALUE;
+    HANDLE m_hMapping = nullptr;
+#else
+    int m_FD = -1;
+#endif
+    const Uint8* m_pData = nullptr;
+    size_t       m_Size  = 0;
+};
+
+} // namespace Diligent
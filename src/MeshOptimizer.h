@@ -0,0 +1,339 @@
+#pragma once
+#include "BasicTypes.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring> // std::memcpy
+#include <vector>
+
+namespace Diligent
+{
+
+// -----------------------------------------------------------------------------
+// Optimizacion de mallas indexadas (triangulos) en tiempo de cocinado:
+//   1) OptimizeVertexCache: Tipsify (Sander, Nehab, Barczak 2007). Abanicos
+//      alrededor de un vertice eligiendo el siguiente que sigue en la cache
+//      FIFO simulada; los saltos por callejon sin salida marcan los limites
+//      duros de cluster.
+//   2) OptimizeOverdraw: parte esos clusters donde el ACMR acumulado ya es
+//      bueno y los ordena de fuera hacia dentro (centroide del cluster contra
+//      el de la malla, en la direccion de su normal) para que lo que tapa se
+//      dibuje antes.
+//   3) OptimizeVertexFetch: renumera los vertices por orden de primer uso
+//      (lecturas secuenciales del VB) y descarta los no referenciados.
+// Solo CPU y sin estado: el cooker lo llama por primitiva en sus workers.
+// -----------------------------------------------------------------------------
+class MeshOptimizer
+{
+public:
+    static constexpr Uint32 CacheSize      = 16;    // FIFO post-transform simulada
+    static constexpr Uint32 FetchLineSize  = 64;    // bytes por linea de la cache de vertex fetch
+    static constexpr Uint32 FetchLines     = 64;    // lineas en esa cache (FIFO)
+    static constexpr float  ClusterAcmrTol = 1.05f; // lambda del paper: corte de clusters blandos
+    static constexpr Uint32 MinClusterTris = 16;    // evita clusters de un triangulo en mallas sin compartir
+
+    // Vertices transformados (fallos de la FIFO) al dibujar los indices en orden
+    static Uint32 CountCacheMisses(const Uint32* pIndices, Uint32 NumIndices, Uint32 NumVertices, Uint32 Size = CacheSize)
+    {
+        std::vector<Uint32> Stamp(NumVertices, 0);
+        Uint32              Time   = Size + 1;
+        Uint32              Misses = 0;
+        for (Uint32 i = 0; i < NumIndices; ++i)
+        {
+            const Uint32 v = pIndices[i];
+            if (Time - Stamp[v] > Size)
+            {
+                Stamp[v] = Time++;
+                ++Misses;
+            }
+        }
+        return Misses;
+    }
+
+    // Lineas de FetchLineSize bytes leidas del VB (FIFO de FetchLines lineas)
+    static Uint32 CountFetchMisses(const Uint32* pIndices, Uint32 NumIndices, Uint32 NumVertices, Uint32 VertexSize)
+    {
+        const Uint32        NumLines = static_cast<Uint32>((Uint64{NumVertices} * VertexSize + FetchLineSize - 1) / FetchLineSize);
+        std::vector<Uint32> Stamp(NumLines, 0);
+        Uint32              Time   = FetchLines + 1;
+        Uint32              Misses = 0;
+        for (Uint32 i = 0; i < NumIndices; ++i)
+        {
+            const Uint64 Begin = Uint64{pIndices[i]} * VertexSize;
+            for (Uint64 Line = Begin / FetchLineSize; Line <= (Begin + VertexSize - 1) / FetchLineSize; ++Line)
+            {
+                if (Time - Stamp[Line] > FetchLines)
+                {
+                    Stamp[Line] = Time++;
+                    ++Misses;
+                }
+            }
+        }
+        return Misses;
+    }
+
+    static Uint32 CountReferencedVertices(const Uint32* pIndices, Uint32 NumIndices, Uint32 NumVertices)
+    {
+        std::vector<bool> Used(NumVertices, false);
+        Uint32            Count = 0;
+        for (Uint32 i = 0; i < NumIndices; ++i)
+        {
+            if (!Used[pIndices[i]])
+            {
+                Used[pIndices[i]] = true;
+                ++Count;
+            }
+        }
+        return Count;
+    }
+
+    // Tipsify. pOut puede ser pIndices. HardClusters recibe el primer
+    // triangulo de cada cluster duro (siempre empieza por 0).
+    static void OptimizeVertexCache(const Uint32* pIndices, Uint32 NumIndices, Uint32 NumVertices, Uint32* pOut,
+                                    std::vector<Uint32>& HardClusters, Uint32 Size = CacheSize)
+    {
+        const Uint32 NumTris = NumIndices / 3;
+        HardClusters.assign(1, 0);
+        if (NumTris == 0)
+            return;
+
+        // Triangulos de cada vertice (CSR) y cuantos quedan por emitir
+        std::vector<Uint32> Live(NumVertices, 0);
+        for (Uint32 i = 0; i < NumTris * 3; ++i)
+            ++Live[pIndices[i]];
+        std::vector<Uint32> Offsets(NumVertices + 1, 0);
+        for (Uint32 v = 0; v < NumVertices; ++v)
+            Offsets[v + 1] = Offsets[v] + Live[v];
+        std::vector<Uint32> Adjacency(NumTris * 3);
+        {
+            std::vector<Uint32> Cursor(Offsets.begin(), Offsets.end() - 1);
+            for (Uint32 i = 0; i < NumTris * 3; ++i)
+                Adjacency[Cursor[pIndices[i]]++] = i / 3;
+        }
+
+        const std::vector<Uint32> Input(pIndices, pIndices + NumTris * 3); // pOut puede pisar pIndices
+        std::vector<Uint32>       Stamp(NumVertices, 0);
+        std::vector<bool>         Emitted(NumTris, false);
+        std::vector<Uint32>       DeadEnd;
+        std::vector<Uint32>       Candidates;
+        Uint32                    Time      = Size + 1;
+        Uint32                    Scan      = 0; // siguiente vertice a probar cuando no quedan callejones
+        Uint32                    OutPos    = 0;
+        Int64                     FanVertex = Input[0];
+
+        while (FanVertex >= 0)
+        {
+            Candidates.clear();
+            const Uint32 f = static_cast<Uint32>(FanVertex);
+            for (Uint32 a = Offsets[f]; a < Offsets[f + 1]; ++a)
+            {
+                const Uint32 t = Adjacency[a];
+                if (Emitted[t])
+                    continue;
+                Emitted[t] = true;
+                for (Uint32 k = 0; k < 3; ++k)
+                {
+                    const Uint32 v = Input[t * 3 + k];
+                    pOut[OutPos++] = v;
+                    DeadEnd.push_back(v);
+                    Candidates.push_back(v);
+                    --Live[v];
+                    if (Time - Stamp[v] > Size)
+                        Stamp[v] = Time++;
+                }
+            }
+
+            // Siguiente abanico: el candidato con triangulos pendientes que
+            // mas tiempo lleva en cache sin que sus triangulos lo expulsen
+            Int64 Next     = -1;
+            Int64 Priority = -1;
+            for (const Uint32 v : Candidates)
+            {
+                if (Live[v] == 0)
+                    continue;
+                Int64 p = 0;
+                if (Time - Stamp[v] + 2 * Live[v] <= Size)
+                    p = Time - Stamp[v];
+                if (p > Priority)
+                {
+                    Priority = p;
+                    Next     = v;
+                }
+            }
+            if (Next < 0)
+            {
+                Next = SkipDeadEnd(Live, DeadEnd, Scan);
+                if (Next >= 0)
+                    HardClusters.push_back(OutPos / 3);
+            }
+            FanVertex = Next;
+        }
+    }
+
+    // Reordena clusters de triangulos de pIndices (ya pasados por Tipsify)
+    // para reducir overdraw. pPositions: float3 con PositionStride bytes
+    // entre vertices. Devuelve el numero de clusters.
+    static Uint32 OptimizeOverdraw(Uint32* pIndices, Uint32 NumIndices, Uint32 NumVertices, const std::vector<Uint32>& HardClusters,
+                                   const void* pPositions, Uint32 PositionStride, Uint32 Size = CacheSize)
+    {
+        const Uint32 NumTris = NumIndices / 3;
+        if (NumTris == 0)
+            return 0;
+
+        auto Pos = [&](Uint32 v) {
+            return reinterpret_cast<const float*>(static_cast<const Uint8*>(pPositions) + size_t{v} * PositionStride);
+        };
+
+        // Clusters blandos: dentro de cada duro se corta en cuanto el ACMR del
+        // tramo (empezando con la cache fria, como quedara tras reordenar)
+        // llega a lambda veces el de la malla entera
+        const float         MeshAcmr = static_cast<float>(CountCacheMisses(pIndices, NumTris * 3, NumVertices, Size)) / NumTris;
+        std::vector<Uint32> Clusters;
+        std::vector<Uint32> Stamp(NumVertices, 0);
+        Uint32              Time = Size + 1;
+        for (size_t h = 0; h < HardClusters.size(); ++h)
+        {
+            const Uint32 Begin  = HardClusters[h];
+            const Uint32 End    = h + 1 < HardClusters.size() ? HardClusters[h + 1] : NumTris;
+            Uint32       Misses = 0;
+            Uint32       Start  = Begin;
+            Time += Size + 1; // cache fria
+            Clusters.push_back(Begin);
+            for (Uint32 t = Begin; t < End; ++t)
+            {
+                for (Uint32 k = 0; k < 3; ++k)
+                {
+                    const Uint32 v = pIndices[t * 3 + k];
+                    if (Time - Stamp[v] > Size)
+                    {
+                        Stamp[v] = Time++;
+                        ++Misses;
+                    }
+                }
+                if (t + 1 < End && t + 1 - Start >= MinClusterTris && static_cast<float>(Misses) / (t + 1 - Start) <= ClusterAcmrTol * MeshAcmr)
+                {
+                    Clusters.push_back(t + 1);
+                    Start  = t + 1;
+                    Misses = 0;
+                    Time += Size + 1;
+                }
+            }
+        }
+        const Uint32 NumClusters = static_cast<Uint32>(Clusters.size());
+        Clusters.push_back(NumTris);
+
+        // Centroide y normal de cada cluster ponderados por area; el de la
+        // malla es la media de los de los clusters con el mismo peso
+        struct ClusterInfo
+        {
+            Uint32 Begin, End;
+            double Center[3];
+            double Normal[3];
+            float  Sort;
+        };
+        std::vector<ClusterInfo> Infos(NumClusters);
+        double                   MeshCenter[3] = {};
+        double                   MeshArea      = 0.0;
+        for (Uint32 c = 0; c < NumClusters; ++c)
+        {
+            auto& Info = Infos[c];
+            Info       = {Clusters[c], Clusters[c + 1], {}, {}, 0.f};
+            double Area = 0.0;
+            for (Uint32 t = Info.Begin; t < Info.End; ++t)
+            {
+                const float* p0    = Pos(pIndices[t * 3 + 0]);
+                const float* p1    = Pos(pIndices[t * 3 + 1]);
+                const float* p2    = Pos(pIndices[t * 3 + 2]);
+                const double e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+                const double e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+                const double n[3]  = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+                const double a     = 0.5 * std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+                for (int i = 0; i < 3; ++i)
+                {
+                    Info.Center[i] += a * (double{p0[i]} + p1[i] + p2[i]) / 3.0;
+                    Info.Normal[i] += n[i];
+                }
+                Area += a;
+            }
+            for (int i = 0; i < 3; ++i)
+                MeshCenter[i] += Info.Center[i];
+            MeshArea += Area;
+
+            const double InvArea = Area > 0.0 ? 1.0 / Area : 0.0;
+            const double NLen    = std::sqrt(Info.Normal[0] * Info.Normal[0] + Info.Normal[1] * Info.Normal[1] + Info.Normal[2] * Info.Normal[2]);
+            const double InvNLen = NLen > 0.0 ? 1.0 / NLen : 0.0;
+            for (int i = 0; i < 3; ++i)
+            {
+                Info.Center[i] *= InvArea;
+                Info.Normal[i] *= InvNLen;
+            }
+        }
+        const double InvMeshArea = MeshArea > 0.0 ? 1.0 / MeshArea : 0.0;
+        for (auto& Info : Infos)
+        {
+            double Dot = 0.0;
+            for (int i = 0; i < 3; ++i)
+                Dot += (Info.Center[i] - MeshCenter[i] * InvMeshArea) * Info.Normal[i];
+            Info.Sort = static_cast<float>(Dot);
+        }
+
+        // Los que miran hacia fuera desde mas lejos del centro, primero
+        std::stable_sort(Infos.begin(), Infos.end(), [](const ClusterInfo& a, const ClusterInfo& b) { return a.Sort > b.Sort; });
+
+        const std::vector<Uint32> Input(pIndices, pIndices + NumTris * 3);
+        Uint32                    OutPos = 0;
+        for (const auto& Info : Infos)
+        {
+            for (Uint32 i = Info.Begin * 3; i < Info.End * 3; ++i)
+                pIndices[OutPos++] = Input[i];
+        }
+        return NumClusters;
+    }
+
+    // Renumera los vertices por primer uso en pIndices y compacta pVertices
+    // (VertexSize bytes cada uno). Devuelve los vertices que quedan: los no
+    // referenciados se descartan.
+    static Uint32 OptimizeVertexFetch(Uint32* pIndices, Uint32 NumIndices, void* pVertices, Uint32 NumVertices, Uint32 VertexSize)
+    {
+        constexpr Uint32    Unused = ~0u;
+        std::vector<Uint32> Remap(NumVertices, Unused);
+        Uint32              NumUsed = 0;
+        for (Uint32 i = 0; i < NumIndices; ++i)
+        {
+            Uint32& r = Remap[pIndices[i]];
+            if (r == Unused)
+                r = NumUsed++;
+            pIndices[i] = r;
+        }
+
+        Uint8*             pData = static_cast<Uint8*>(pVertices);
+        std::vector<Uint8> Reordered(size_t{NumUsed} * VertexSize);
+        for (Uint32 v = 0; v < NumVertices; ++v)
+        {
+            if (Remap[v] != Unused)
+                std::memcpy(&Reordered[size_t{Remap[v]} * VertexSize], pData + size_t{v} * VertexSize, VertexSize);
+        }
+        if (!Reordered.empty())
+            std::memcpy(pData, Reordered.data(), Reordered.size());
+        return NumUsed;
+    }
+
+private:
+    static Int64 SkipDeadEnd(const std::vector<Uint32>& Live, std::vector<Uint32>& DeadEnd, Uint32& Scan)
+    {
+        while (!DeadEnd.empty())
+        {
+            const Uint32 v = DeadEnd.back();
+            DeadEnd.pop_back();
+            if (Live[v] > 0)
+                return v;
+        }
+        for (; Scan < Live.size(); ++Scan)
+        {
+            if (Live[Scan] > 0)
+                return Scan;
+        }
+        return -1;
+    }
+};
+
+} // namespace Diligent
@@ -0,0 +1,327 @@
+#pragma once
+#include "BasicTypes.h"
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+
+namespace Diligent
+{
+
+// -----------------------------------------------------------------------------
+// Simplificacion de mallas indexadas por colapso de aristas con cuadricas de
+// error (Garland-Heckbert), colapsando siempre un vertice sobre otro que ya
+// existe: el resultado es solo un index buffer nuevo sobre los mismos
+// vertices, asi los LOD comparten VB (y rango del GeometryPool) con el LOD0.
+//   - Los vertices de borde (aristas con un solo triangulo, que en mallas con
+//     vertices partidos incluye las costuras de UV/normales) y los de aristas
+//     no-manifold no se mueven.
+//   - Por pasada se colapsan las aristas mas baratas sin tocar dos veces el
+//     mismo entorno; se rechazan colapsos que dan la vuelta a un triangulo o
+//     que rompen la condicion de enlace (pliegues).
+// Solo CPU y sin estado, como MeshOptimizer.
+// -----------------------------------------------------------------------------
+class MeshSimplifier
+{
+public:
+    // pIndices: lista de triangulos con indices locales [0, NumVertices).
+    // Para en TargetIndexCount o cuando el siguiente colapso superaria
+    // MaxError (distancia relativa al lado mayor del AABB de la malla).
+    // Devuelve el numero de indices escritos en Out y el error alcanzado
+    // (relativo, como MaxError) en *pResultError.
+    static Uint32 Simplify(const Uint32* pIndices, Uint32 NumIndices, Uint32 NumVertices, const void* pPositions, Uint32 PositionStride,
+                           Uint32 TargetIndexCount, float MaxError, std::vector<Uint32>& Out, float* pResultError = nullptr)
+    {
+        Out.assign(pIndices, pIndices + NumIndices - NumIndices % 3);
+        if (pResultError != nullptr)
+            *pResultError = 0.f;
+        if (Out.size() <= TargetIndexCount || NumVertices == 0)
+            return static_cast<Uint32>(Out.size());
+
+        // Posiciones normalizadas al lado mayor del AABB: errores relativos
+        std::vector<double> Pos(size_t{NumVertices} * 3);
+        double              Min[3] = {1e30, 1e30, 1e30}, Max[3] = {-1e30, -1e30, -1e30};
+        for (Uint32 v = 0; v < NumVertices; ++v)
+        {
+            const float* p = reinterpret_cast<const float*>(static_cast<const Uint8*>(pPositions) + size_t{v} * PositionStride);
+            for (int i = 0; i < 3; ++i)
+            {
+                Pos[v * 3 + i] = p[i];
+                Min[i]         = (std::min)(Min[i], double{p[i]});
+                Max[i]         = (std::max)(Max[i], double{p[i]});
+            }
+        }
+        const double Extent    = (std::max)({Max[0] - Min[0], Max[1] - Min[1], Max[2] - Min[2], 1e-12});
+        const double InvExtent = 1.0 / Extent;
+        for (Uint32 v = 0; v < NumVertices; ++v)
+        {
+            for (int i = 0; i < 3; ++i)
+                Pos[v * 3 + i] = (Pos[v * 3 + i] - Min[i]) * InvExtent;
+        }
+
+        std::vector<bool>    Locked(NumVertices, false);
+        std::vector<Quadric> Quadrics(NumVertices);
+        LockBorders(Out, Locked);
+        for (size_t t = 0; t < Out.size(); t += 3)
+        {
+            double n[3], d;
+            const double Area = TrianglePlane(Pos, Out[t], Out[t + 1], Out[t + 2], n, d);
+            if (Area <= 0.0)
+                continue;
+            for (int k = 0; k < 3; ++k)
+                Quadrics[Out[t + k]].AddPlane(n, d, Area);
+        }
+
+        const double        MaxErrorSq = double{MaxError} * MaxError;
+        double              ResultSq   = 0.0;
+        std::vector<Uint32> Offsets, Adjacency, Remap(NumVertices);
+        std::vector<Uint32> Mark(NumVertices, 0), NeighborMark(NumVertices, 0);
+        std::vector<bool>   Touched(NumVertices);
+        std::vector<Edge>   Candidates;
+        Uint32              Stamp = 0;
+
+        while (Out.size() > TargetIndexCount)
+        {
+            const Uint32 NumTris = static_cast<Uint32>(Out.size() / 3);
+            BuildAdjacency(Out, NumVertices, Offsets, Adjacency);
+
+            Candidates.clear();
+            for (Uint32 t = 0; t < NumTris; ++t)
+            {
+                for (int k = 0; k < 3; ++k)
+                {
+                    const Uint32 a = Out[t * 3 + k];
+                    const Uint32 b = Out[t * 3 + (k + 1) % 3];
+                    if (!Locked[a])
+                        Candidates.push_back({a, b, CollapseCost(Quadrics, Pos, a, b)});
+                    if (!Locked[b])
+                        Candidates.push_back({b, a, CollapseCost(Quadrics, Pos, b, a)});
+                }
+            }
+            std::sort(Candidates.begin(), Candidates.end(), [](const Edge& x, const Edge& y) { return x.Cost < y.Cost; });
+
+            // Cada colapso quita ~2 triangulos
+            const Uint32 TrisToRemove = (static_cast<Uint32>(Out.size()) - TargetIndexCount + 2) / 3;
+            Uint32       Removed      = 0;
+            Uint32       Collapses    = 0;
+            for (Uint32 v = 0; v < NumVertices; ++v)
+                Remap[v] = v;
+            std::fill(Touched.begin(), Touched.end(), false);
+
+            for (const Edge& e : Candidates)
+            {
+                if (e.Cost > MaxErrorSq || Removed >= TrisToRemove)
+                    break;
+                if (Touched[e.From] || Touched[e.To])
+                    continue;
+
+                Uint32 Shared = 0;
+                if (!CanCollapse(Out, Pos, Offsets, Adjacency, e.From, e.To, Mark, NeighborMark, ++Stamp, Shared))
+                    continue;
+
+                Remap[e.From] = e.To;
+                Quadrics[e.To].Add(Quadrics[e.From]);
+                ResultSq = (std::max)(ResultSq, e.Cost);
+                Removed += Shared;
+                ++Collapses;
+
+                // El entorno de los dos extremos queda congelado hasta la siguiente pasada
+                for (const Uint32 v : {e.From, e.To})
+                {
+                    for (Uint32 a = Offsets[v]; a < Offsets[v + 1]; ++a)
+                    {
+                        const Uint32 t = Adjacency[a];
+                        Touched[Out[t * 3]] = Touched[Out[t * 3 + 1]] = Touched[Out[t * 3 + 2]] = true;
+                    }
+                }
+            }
+            if (Collapses == 0)
+                break;
+
+            size_t Write = 0;
+            for (size_t t = 0; t < Out.size(); t += 3)
+            {
+                const Uint32 a = Remap[Out[t]], b = Remap[Out[t + 1]], c = Remap[Out[t + 2]];
+                if (a == b || b == c || a == c)
+                    continue;
+                Out[Write++] = a;
+                Out[Write++] = b;
+                Out[Write++] = c;
+            }
+            Out.resize(Write);
+        }
+
+        if (pResultError != nullptr)
+            *pResultError = static_cast<float>(std::sqrt(ResultSq));
+        return static_cast<Uint32>(Out.size());
+    }
+
+private:
+    // Matriz simetrica 4x4 de la suma de planos ponderados + el peso total
+    struct Quadric
+    {
+        double a00 = 0, a01 = 0, a02 = 0, a03 = 0;
+        double a11 = 0, a12 = 0, a13 = 0;
+        double a22 = 0, a23 = 0;
+        double a33 = 0;
+        double w   = 0;
+
+        void AddPlane(const double n[3], double d, double Weight)
+        {
+            a00 += Weight * n[0] * n[0];
+            a01 += Weight * n[0] * n[1];
+            a02 += Weight * n[0] * n[2];
+            a03 += Weight * n[0] * d;
+            a11 += Weight * n[1] * n[1];
+            a12 += Weight * n[1] * n[2];
+            a13 += Weight * n[1] * d;
+            a22 += Weight * n[2] * n[2];
+            a23 += Weight * n[2] * d;
+            a33 += Weight * d * d;
+            w += Weight;
+        }
+
+        void Add(const Quadric& q)
+        {
+            a00 += q.a00, a01 += q.a01, a02 += q.a02, a03 += q.a03;
+            a11 += q.a11, a12 += q.a12, a13 += q.a13;
+            a22 += q.a22, a23 += q.a23;
+            a33 += q.a33;
+            w += q.w;
+        }
+
+        // Distancia cuadratica media (ponderada por area) de p a los planos
+        double Evaluate(const double p[3]) const
+        {
+            const double x = p[0], y = p[1], z = p[2];
+            const double e = a00 * x * x + 2 * a01 * x * y + 2 * a02 * x * z + 2 * a03 * x +
+                a11 * y * y + 2 * a12 * y * z + 2 * a13 * y +
+                a22 * z * z + 2 * a23 * z + a33;
+            return w > 0 ? (std::max)(e, 0.0) / w : 0.0;
+        }
+    };
+
+    struct Edge
+    {
+        Uint32 From, To;
+        double Cost;
+    };
+
+    static double CollapseCost(const std::vector<Quadric>& Quadrics, const std::vector<double>& Pos, Uint32 From, Uint32 To)
+    {
+        Quadric q = Quadrics[From];
+        q.Add(Quadrics[To]);
+        return q.Evaluate(&Pos[size_t{To} * 3]);
+    }
+
+    // Normal unitaria y d del plano; devuelve el area (0 si es degenerado)
+    static double TrianglePlane(const std::vector<double>& Pos, Uint32 i0, Uint32 i1, Uint32 i2, double n[3], double& d)
+    {
+        const double* p0 = &Pos[size_t{i0} * 3];
+        const double* p1 = &Pos[size_t{i1} * 3];
+        const double* p2 = &Pos[size_t{i2} * 3];
+        Cross(p0, p1, p2, n);
+        const double Len = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if (Len <= 0.0)
+            return 0.0;
+        n[0] /= Len, n[1] /= Len, n[2] /= Len;
+        d = -(n[0] * p0[0] + n[1] * p0[1] + n[2] * p0[2]);
+        return 0.5 * Len;
+    }
+
+    static void Cross(const double* p0, const double* p1, const double* p2, double n[3])
+    {
+        const double e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+        const double e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+        n[0]               = e1[1] * e2[2] - e1[2] * e2[1];
+        n[1]               = e1[2] * e2[0] - e1[0] * e2[2];
+        n[2]               = e1[0] * e2[1] - e1[1] * e2[0];
+    }
+
+    static void LockBorders(const std::vector<Uint32>& Indices, std::vector<bool>& Locked)
+    {
+        std::unordered_map<Uint64, Uint32> EdgeUses;
+        EdgeUses.reserve(Indices.size());
+        for (size_t t = 0; t < Indices.size(); t += 3)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                const Uint32 a = Indices[t + k], b = Indices[t + (k + 1) % 3];
+                ++EdgeUses[(Uint64{(std::min)(a, b)} << 32) | (std::max)(a, b)];
+            }
+        }
+        for (const auto& Use : EdgeUses)
+        {
+            if (Use.second != 2)
+                Locked[static_cast<Uint32>(Use.first >> 32)] = Locked[static_cast<Uint32>(Use.first)] = true;
+        }
+    }
+
+    static void BuildAdjacency(const std::vector<Uint32>& Indices, Uint32 NumVertices, std::vector<Uint32>& Offsets, std::vector<Uint32>& Adjacency)
+    {
+        Offsets.assign(NumVertices + 1, 0);
+        for (const Uint32 v : Indices)
+            ++Offsets[v + 1];
+        for (Uint32 v = 0; v < NumVertices; ++v)
+            Offsets[v + 1] += Offsets[v];
+        Adjacency.resize(Indices.size());
+        std::vector<Uint32> Cursor(Offsets.begin(), Offsets.end() - 1);
+        for (size_t i = 0; i < Indices.size(); ++i)
+            Adjacency[Cursor[Indices[i]]++] = static_cast<Uint32>(i / 3);
+    }
+
+    // From -> To no debe voltear ni casi degenerar los triangulos que se
+    // quedan, y los vecinos comunes han de ser solo los de los triangulos de
+    // la arista (condicion de enlace). Shared = triangulos que desaparecen.
+    static bool CanCollapse(const std::vector<Uint32>& Indices, const std::vector<double>& Pos, const std::vector<Uint32>& Offsets,
+                            const std::vector<Uint32>& Adjacency, Uint32 From, Uint32 To, std::vector<Uint32>& Mark,
+                            std::vector<Uint32>& NeighborMark, Uint32 Stamp, Uint32& Shared)
+    {
+        Shared = 0;
+        for (Uint32 a = Offsets[To]; a < Offsets[To + 1]; ++a)
+        {
+            const Uint32 t = Adjacency[a];
+            for (int k = 0; k < 3; ++k)
+                NeighborMark[Indices[t * 3 + k]] = Stamp;
+        }
+
+        Uint32 Common = 0;
+        for (Uint32 a = Offsets[From]; a < Offsets[From + 1]; ++a)
+        {
+            const Uint32  t  = Adjacency[a];
+            const Uint32* pT = &Indices[t * 3];
+            if (pT[0] == To || pT[1] == To || pT[2] == To)
+            {
+                ++Shared;
+                continue;
+            }
+
+            double p[3][3];
+            for (int k = 0; k < 3; ++k)
+            {
+                const Uint32 v = pT[k];
+                if (v != From && Mark[v] != Stamp)
+                {
+                    Mark[v] = Stamp;
+                    if (NeighborMark[v] == Stamp)
+                        ++Common;
+                }
+                const double* Src = &Pos[size_t{v == From ? To : v} * 3];
+                p[k][0] = Src[0], p[k][1] = Src[1], p[k][2] = Src[2];
+            }
+
+            double Old[3], New[3];
+            Cross(&Pos[size_t{pT[0]} * 3], &Pos[size_t{pT[1]} * 3], &Pos[size_t{pT[2]} * 3], Old);
+            Cross(p[0], p[1], p[2], New);
+            const double Dot   = Old[0] * New[0] + Old[1] * New[1] + Old[2] * New[2];
+            const double Len2s = (Old[0] * Old[0] + Old[1] * Old[1] + Old[2] * Old[2]) * (New[0] * New[0] + New[1] * New[1] + New[2] * New[2]);
+            if (Dot <= 0.0 || Dot * Dot < 0.0625 * Len2s) // mas de ~75 grados
+                return false;
+        }
+        // Los dos vertices opuestos de la arista son vecinos comunes por
+        // definicion; cualquier otro crearia un pliegue
+        return Shared > 0 && Common <= Shared;
+    }
+};
+
+} // namespace Diligent
@@ -0,0 +1,574 @@
+#pragma once
+#include "BasicMath.hpp"
+#include "MappedFile.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace Diligent
+{
+
+// -----------------------------------------------------------------------------
+// Formato binario de la cache de modelos cocinados (.dgcm).
+//   Cabecera + tabla de secciones; cada seccion es un array POD alineado a 16
+//   bytes que se usa tal cual desde el fichero proyectado en memoria:
+//   vertices ya intercalados con el layout de los PSO GLTF, indices de 32 bits,
+//   jerarquia de nodos de la escena por defecto y mips de textura ya
+//   decodificados. SourceHash (FNV-1a de los ficheros de origen) decide si la
+//   cache sigue valiendo.
+// -----------------------------------------------------------------------------
+
+// Mismo layout que ModelVertexAttrs / TileVertex: 48 bytes
+struct CookedVertex
+{
+    float3 Pos;
+    float3 Normal;
+    float2 UV;
+    float4 Tangent; // .w = signo de la bitangente
+};
+static_assert(sizeof(CookedVertex) == 48, "El layout de vertice de los PSO GLTF es de 48 bytes");
+
+static constexpr Uint32 CookedMaxLods = 4; // LOD0 incluido
+
+// Index buffer simplificado (MeshSimplifier) sobre los mismos vertices del LOD0
+struct CookedLod
+{
+    Uint32 FirstIndex;
+    Uint32 IndexCount;
+    float  Error; // distancia relativa al lado mayor del AABB de la primitiva
+    Uint32 _Pad;
+};
+
+struct CookedPrimitive
+{
+    Uint32    FirstIndex; // LOD0
+    Uint32    IndexCount;
+    Uint32    MaterialId; // siempre valido: el cooker anade un material por defecto si hace falta
+    Uint32    NumLods;    // 1 = solo el LOD0
+    CookedLod Lods[CookedMaxLods - 1]; // LOD1.. en [0, NumLods - 1)
+};
+
+struct CookedMesh
+{
+    Uint32 FirstPrimitive;
+    Uint32 NumPrimitives;
+    float3 BoundsMin; // AABB de sus vertices, en el espacio de la malla
+    float3 BoundsMax;
+};
+
+// Nodos de la escena por defecto en orden de recorrido: el padre va siempre
+// antes que sus hijos
+struct CookedNode
+{
+    float4x4 LocalMatrix;
+    float4x4 GlobalMatrix;
+    Int32    Parent; // -1 = raiz
+    Int32    MeshId; // -1 = sin malla
+    Uint32   _Pad[2];
+};
+
+enum COOKED_TEXTURE_SLOT : Uint32
+{
+    COOKED_TEXTURE_SLOT_BASE_COLOR = 0,
+    COOKED_TEXTURE_SLOT_NORMAL,
+    COOKED_TEXTURE_SLOT_COUNT
+};
+
+// Nombre del atributo GLTF de cada slot (las claves de AttrToShaderName)
+static constexpr const char* CookedTextureSlotNames[COOKED_TEXTURE_SLOT_COUNT] = {"baseColorTexture", "normalTexture"};
+
+struct CookedMaterial
+{
+    Int32 TextureIds[COOKED_TEXTURE_SLOT_COUNT]; // -1 = el material no lo trae
+};
+
+enum COOKED_TEXTURE_FORMAT : Uint32
+{
+    COOKED_TEXTURE_FORMAT_RGBA8 = 0,
+    COOKED_TEXTURE_FORMAT_BC1
+};
+
+struct CookedTexture
+{
+    Uint32 Width;
+    Uint32 Height;
+    Uint32 Format; // COOKED_TEXTURE_FORMAT
+    Uint32 FirstMip;
+    Uint32 MipLevels;
+    Uint32 _Pad[3];
+};
+
+struct CookedMip
+{
+    Uint32 Width;
+    Uint32 Height;
+    Uint32 RowPitch;   // bytes por fila (de bloques 4x4 en BC1)
+    Uint32 _Pad;
+    Uint64 DataOffset; // dentro de la seccion de texels
+    Uint64 DataSize;
+};
+
+// Informe del cooker sobre la geometria de todo el modelo (MeshOptimizer):
+// ACMR = vertices transformados por triangulo con la FIFO simulada, ATVR =
+// por vertice referenciado (1 = optimo), overfetch = bytes de VB leidos en
+// lineas de cache / bytes de vertices usados. Before es el orden del .gltf.
+struct CookedModelStats
+{
+    Uint32 NumTriangles;
+    Uint32 NumVertices;
+    Uint32 NumClusters; // clusters de overdraw, 0 sin optimizar
+    Uint32 Optimized;   // 1 = indices y vertices reordenados
+    float  AcmrBefore;
+    float  AcmrAfter;
+    float  AtvrBefore;
+    float  AtvrAfter;
+    float  OverfetchBefore;
+    float  OverfetchAfter;
+    Uint32 LodTriangles[CookedMaxLods]; // triangulos del modelo dibujado entero en cada LOD
+    Uint32 _Pad[2];
+};
+
+enum COOKED_SECTION : Uint32
+{
+    COOKED_SECTION_VERTICES = 0,
+    COOKED_SECTION_INDICES,
+    COOKED_SECTION_PRIMITIVES,
+    COOKED_SECTION_MESHES,
+    COOKED_SECTION_NODES,
+    COOKED_SECTION_MATERIALS,
+    COOKED_SECTION_TEXTURES,
+    COOKED_SECTION_MIPS,
+    COOKED_SECTION_TEXELS,
+    COOKED_SECTION_DEPENDENCIES, // rutas de origen relativas al .gltf, separadas por '\0'
+    COOKED_SECTION_STATS,        // un CookedModelStats
+    COOKED_SECTION_COUNT
+};
+
+struct CookedSection
+{
+    Uint64 Offset;
+    Uint64 Size;
+};
+
+struct CookedModelHeader
+{
+    static constexpr Uint32 MagicValue   = 0x4D434744; // "DGCM"
+    static constexpr Uint32 VersionValue = 3;
+
+    Uint32        Magic;
+    Uint32        Version;
+    Uint64        SourceHash;
+    Uint64        FileSize;
+    Uint64        _Pad;
+    CookedSection Sections[COOKED_SECTION_COUNT];
+};
+
+// -----------------------------------------------------------------------------
+// FNV-1a de 64 bits incremental
+// -----------------------------------------------------------------------------
+struct FNV1aHash
+{
+    Uint64 Value = 14695981039346656037ull;
+
+    void Add(const void* pData, size_t Size)
+    {
+        const Uint8* pBytes = static_cast<const Uint8*>(pData);
+        Uint64       h      = Value;
+        for (size_t i = 0; i < Size; ++i)
+        {
+            h ^= pBytes[i];
+            h *= 1099511628211ull;
+        }
+        Value = h;
+    }
+
+    template <typename T>
+    void AddPOD(const T& Data) { Add(&Data, sizeof(Data)); }
+};
+
+// Vista de un modelo cocinado: punteros a los arrays, sean del fichero
+// proyectado (cache caliente) o de un CookedModelData recien cocinado
+struct CookedModelView
+{
+    Uint64 SourceHash = 0;
+
+    const CookedVertex*     pVertices   = nullptr;
+    const Uint32*           pIndices    = nullptr;
+    const CookedPrimitive*  pPrimitives = nullptr;
+    const CookedMesh*       pMeshes     = nullptr;
+    const CookedNode*       pNodes      = nullptr;
+    const CookedMaterial*   pMaterials  = nullptr;
+    const CookedTexture*    pTextures   = nullptr;
+    const CookedMip*        pMips       = nullptr;
+    const Uint8*            pTexels     = nullptr;
+    const char*             pDeps       = nullptr;
+    const CookedModelStats* pStats      = nullptr;
+
+    Uint32 NumVertices   = 0;
+    Uint32 NumIndices    = 0;
+    Uint32 NumPrimitives = 0;
+    Uint32 NumMeshes     = 0;
+    Uint32 NumNodes      = 0;
+    Uint32 NumMaterials  = 0;
+    Uint32 NumTextures   = 0;
+    Uint32 NumMips       = 0;
+    Uint64 TexelsSize    = 0;
+    Uint64 DepsSize      = 0;
+
+    const Uint8* GetMipData(const CookedMip& Mip) const { return pTexels + Mip.DataOffset; }
+
+    // Dependencias (la primera es el propio .gltf)
+    template <typename F>
+    void ForEachDependency(F&& Fn) const
+    {
+        for (Uint64 Pos = 0; Pos < DepsSize;)
+        {
+            const char*  pDep = pDeps + Pos;
+            const size_t Len  = strnlen(pDep, static_cast<size_t>(DepsSize - Pos));
+            if (Len > 0)
+                Fn(std::string{pDep, Len});
+            Pos += Len + 1;
+        }
+    }
+};
+
+// Resultado del cooker en memoria; mismo contenido que las secciones del fichero
+struct CookedModelData
+{
+    Uint64                       SourceHash = 0;
+    std::vector<CookedVertex>    Vertices;
+    std::vector<Uint32>          Indices;
+    std::vector<CookedPrimitive> Primitives;
+    std::vector<CookedMesh>      Meshes;
+    std::vector<CookedNode>      Nodes;
+    std::vector<CookedMaterial>  Materials;
+    std::vector<CookedTexture>   Textures;
+    std::vector<CookedMip>       Mips;
+    std::vector<Uint8>           Texels;
+    std::vector<std::string>     Dependencies;
+    std::string                  DepsBlob; // Dependencies unidas con '\0', lo rellena GetView()
+    CookedModelStats             Stats = {};
+
+    CookedModelView GetView()
+    {
+        DepsBlob.clear();
+        for (const auto& Dep : Dependencies)
+        {
+            DepsBlob += Dep;
+            DepsBlob += '\0';
+        }
+
+        CookedModelView View;
+        View.SourceHash    = SourceHash;
+        View.pVertices     = Vertices.data();
+        View.pIndices      = Indices.data();
+        View.pPrimitives   = Primitives.data();
+        View.pMeshes       = Meshes.data();
+        View.pNodes        = Nodes.data();
+        View.pMaterials    = Materials.data();
+        View.pTextures     = Textures.data();
+        View.pMips         = Mips.data();
+        View.pTexels       = Texels.data();
+        View.pDeps         = DepsBlob.data();
+        View.pStats        = &Stats;
+        View.NumVertices   = static_cast<Uint32>(Vertices.size());
+        View.NumIndices    = static_cast<Uint32>(Indices.size());
+        View.NumPrimitives = static_cast<Uint32>(Primitives.size());
+        View.NumMeshes     = static_cast<Uint32>(Meshes.size());
+        View.NumNodes      = static_cast<Uint32>(Nodes.size());
+        View.NumMaterials  = static_cast<Uint32>(Materials.size());
+        View.NumTextures   = static_cast<Uint32>(Textures.size());
+        View.NumMips       = static_cast<Uint32>(Mips.size());
+        View.TexelsSize    = Texels.size();
+        View.DepsSize      = DepsBlob.size();
+        return View;
+    }
+};
+
+// -----------------------------------------------------------------------------
+// Lectura / escritura de la cache
+// -----------------------------------------------------------------------------
+class ModelCache
+{
+public:
+    // "Barrel/scene.gltf" -> "ModelCache/Barrel_scene.gltf.dgcm"
+    static std::string GetCachePath(const std::string& SourcePath)
+    {
+        std::string Name = SourcePath;
+        for (auto& c : Name)
+        {
+            if (c == '/' || c == '\\' || c == ':')
+                c = '_';
+        }
+        return std::string{CacheDir} + "/" + Name + ".dgcm";
+    }
+
+    // Directorio del .gltf con separador final ("" si no tiene)
+    static std::string GetBaseDir(const std::string& SourcePath)
+    {
+        const auto Pos = SourcePath.find_last_of("/\\");
+        return Pos == std::string::npos ? std::string{} : SourcePath.substr(0, Pos + 1);
+    }
+
+    // Hash de los ficheros de origen. Los lee proyectados: no se copia nada.
+    // SettingsHash distingue caches cocinadas con opciones distintas.
+    static bool HashSources(const std::string& BaseDir, const std::vector<std::string>& Dependencies, Uint64 SettingsHash, Uint64& OutHash)
+    {
+        FNV1aHash Hash;
+        Hash.AddPOD(CookedModelHeader::VersionValue);
+        Hash.AddPOD(SettingsHash);
+        for (const auto& Dep : Dependencies)
+        {
+            MappedFile File;
+            if (!File.Open(BaseDir + Dep))
+                return false;
+            Hash.Add(Dep.data(), Dep.size());
+            Hash.Add(File.GetData(), File.GetSize());
+        }
+        OutHash = Hash.Value;
+        return true;
+    }
+
+    // Escribe a un temporal y renombra: una cache a medias nunca parece valida
+    static bool Write(const std::string& CachePath, CookedModelData& Data)
+    {
+        const CookedModelView View = Data.GetView();
+
+        CookedModelHeader Header = {};
+        Header.Magic             = CookedModelHeader::MagicValue;
+        Header.Version           = CookedModelHeader::VersionValue;
+        Header.SourceHash        = Data.SourceHash;
+
+        const void* pSections[COOKED_SECTION_COUNT] = {View.pVertices, View.pIndices, View.pPrimitives, View.pMeshes, View.pNodes,
+                                                       View.pMaterials, View.pTextures, View.pMips, View.pTexels, View.pDeps, View.pStats};
+        const Uint64 Sizes[COOKED_SECTION_COUNT]    = {
+            Uint64{View.NumVertices} * sizeof(CookedVertex),
+            Uint64{View.NumIndices} * sizeof(Uint32),
+            Uint64{View.NumPrimitives} * sizeof(CookedPrimitive),
+            Uint64{View.NumMeshes} * sizeof(CookedMesh),
+            Uint64{View.NumNodes} * sizeof(CookedNode),
+            Uint64{View.NumMaterials} * sizeof(CookedMaterial),
+            Uint64{View.NumTextures} * sizeof(CookedTexture),
+            Uint64{View.NumMips} * sizeof(CookedMip),
+            View.TexelsSize,
+            View.DepsSize,
+            sizeof(CookedModelStats),
+        };
+
+        Uint64 Offset = AlignUp(sizeof(Header));
+        for (Uint32 s = 0; s < COOKED_SECTION_COUNT; ++s)
+        {
+            Header.Sections[s] = {Offset, Sizes[s]};
+            Offset             = AlignUp(Offset + Sizes[s]);
+        }
+        Header.FileSize = Offset;
+
+        CreateCacheDir();
+        const std::string TmpPath = CachePath + ".tmp";
+        {
+            std::ofstream File{TmpPath, std::ios::binary | std::ios::trunc};
+            if (!File)
+                return false;
+
+            static constexpr char Zeros[SectionAlignment] = {};
+
+            File.write(reinterpret_cast<const char*>(&Header), sizeof(Header));
+            Uint64 Written = sizeof(Header);
+            for (Uint32 s = 0; s < COOKED_SECTION_COUNT; ++s)
+            {
+                File.write(Zeros, static_cast<std::streamsize>(Header.Sections[s].Offset - Written));
+                if (Sizes[s] > 0)
+                    File.write(static_cast<const char*>(pSections[s]), static_cast<std::streamsize>(Sizes[s]));
+                Written = Header.Sections[s].Offset + Sizes[s];
+            }
+            File.write(Zeros, static_cast<std::streamsize>(Header.FileSize - Written));
+            if (!File)
+                return false;
+        }
+
+        std::remove(CachePath.c_str());
+        return std::rename(TmpPath.c_str(), CachePath.c_str()) == 0;
+    }
+
+    // Comprueba cabecera y limites y rellena View con punteros a pData
+    static bool Parse(const Uint8* pData, size_t Size, CookedModelView& View)
+    {
+        if (Size < sizeof(CookedModelHeader))
+            return false;
+
+        CookedModelHeader Header;
+        std::memcpy(&Header, pData, sizeof(Header));
+        if (Header.Magic != CookedModelHeader::MagicValue || Header.Version != CookedModelHeader::VersionValue || Header.FileSize != Size)
+            return false;
+
+        for (const auto& Section : Header.Sections)
+        {
+            if (Section.Offset % SectionAlignment != 0 || Section.Offset > Size || Section.Size > Size - Section.Offset)
+                return false;
+        }
+
+        auto Get = [&](COOKED_SECTION s, auto*& pOut, Uint32& Count, size_t ElemSize) {
+            using T = std::remove_reference_t<decltype(*pOut)>;
+            pOut    = reinterpret_cast<T*>(pData + Header.Sections[s].Offset);
+            Count   = static_cast<Uint32>(Header.Sections[s].Size / ElemSize);
+            return Header.Sections[s].Size % ElemSize == 0;
+        };
+
+        View            = {};
+        View.SourceHash = Header.SourceHash;
+        bool Ok         = true;
+        Ok              = Ok && Get(COOKED_SECTION_VERTICES, View.pVertices, View.NumVertices, sizeof(CookedVertex));
+        Ok              = Ok && Get(COOKED_SECTION_INDICES, View.pIndices, View.NumIndices, sizeof(Uint32));
+        Ok              = Ok && Get(COOKED_SECTION_PRIMITIVES, View.pPrimitives, View.NumPrimitives, sizeof(CookedPrimitive));
+        Ok              = Ok && Get(COOKED_SECTION_MESHES, View.pMeshes, View.NumMeshes, sizeof(CookedMesh));
+        Ok              = Ok && Get(COOKED_SECTION_NODES, View.pNodes, View.NumNodes, sizeof(CookedNode));
+        Ok              = Ok && Get(COOKED_SECTION_MATERIALS, View.pMaterials, View.NumMaterials, sizeof(CookedMaterial));
+        Ok              = Ok && Get(COOKED_SECTION_TEXTURES, View.pTextures, View.NumTextures, sizeof(CookedTexture));
+        Ok              = Ok && Get(COOKED_SECTION_MIPS, View.pMips, View.NumMips, sizeof(CookedMip));
+        if (!Ok)
+            return false;
+
+        View.pTexels    = pData + Header.Sections[COOKED_SECTION_TEXELS].Offset;
+        View.TexelsSize = Header.Sections[COOKED_SECTION_TEXELS].Size;
+        View.pDeps      = reinterpret_cast<const char*>(pData + Header.Sections[COOKED_SECTION_DEPENDENCIES].Offset);
+        View.DepsSize   = Header.Sections[COOKED_SECTION_DEPENDENCIES].Size;
+        if (Header.Sections[COOKED_SECTION_STATS].Size != sizeof(CookedModelStats))
+            return false;
+        View.pStats = reinterpret_cast<const CookedModelStats*>(pData + Header.Sections[COOKED_SECTION_STATS].Offset);
+
+        return IsConsistent(View);
+    }
+
+    // Referencias cruzadas dentro de rango: un fichero corrupto no debe
+    // acabar en lecturas fuera del mapeo al crear los recursos
+    static bool IsConsistent(const CookedModelView& View)
+    {
+        for (Uint32 i = 0; i < View.NumIndices; ++i)
+        {
+            if (View.pIndices[i] >= View.NumVertices)
+                return false;
+        }
+        for (Uint32 p = 0; p < View.NumPrimitives; ++p)
+        {
+            const auto& Prim = View.pPrimitives[p];
+            if (Prim.FirstIndex > View.NumIndices || Prim.IndexCount > View.NumIndices - Prim.FirstIndex || Prim.MaterialId >= View.NumMaterials)
+                return false;
+            if (Prim.NumLods == 0 || Prim.NumLods > CookedMaxLods)
+                return false;
+            for (Uint32 l = 0; l + 1 < Prim.NumLods; ++l)
+            {
+                if (Prim.Lods[l].FirstIndex > View.NumIndices || Prim.Lods[l].IndexCount > View.NumIndices - Prim.Lods[l].FirstIndex)
+                    return false;
+            }
+        }
+        for (Uint32 m = 0; m < View.NumMeshes; ++m)
+        {
+            const auto& Mesh = View.pMeshes[m];
+            if (Mesh.FirstPrimitive > View.NumPrimitives || Mesh.NumPrimitives > View.NumPrimitives - Mesh.FirstPrimitive)
+                return false;
+        }
+        for (Uint32 n = 0; n < View.NumNodes; ++n)
+        {
+            const auto& Node = View.pNodes[n];
+            if (Node.Parent < -1 || Node.Parent >= static_cast<Int32>(n) || Node.MeshId < -1 || Node.MeshId >= static_cast<Int32>(View.NumMeshes))
+                return false;
+        }
+        for (Uint32 m = 0; m < View.NumMaterials; ++m)
+        {
+            for (Int32 TexId : View.pMaterials[m].TextureIds)
+            {
+                if (TexId < -1 || TexId >= static_cast<Int32>(View.NumTextures))
+                    return false;
+            }
+        }
+        for (Uint32 t = 0; t < View.NumTextures; ++t)
+        {
+            const auto& Tex = View.pTextures[t];
+            if (Tex.MipLevels == 0 || Tex.MipLevels > 32 || Tex.FirstMip > View.NumMips || Tex.MipLevels > View.NumMips - Tex.FirstMip)
+                return false;
+            if (Tex.Width == 0 || Tex.Height == 0 || Tex.Format > COOKED_TEXTURE_FORMAT_BC1)
+                return false;
+            // CreateTexture pasa RowPitch como stride de cada mip: las
+            // dimensiones deben ser las de la cadena de la textura y las filas
+            // (de bloques 4x4 en BC1) deben caber en los datos del mip
+            for (Uint32 m = 0; m < Tex.MipLevels; ++m)
+            {
+                const auto&  Mip       = View.pMips[Tex.FirstMip + m];
+                const Uint32 MipWidth  = (std::max)(Tex.Width >> m, 1u);
+                const Uint32 MipHeight = (std::max)(Tex.Height >> m, 1u);
+                if (Mip.Width != MipWidth || Mip.Height != MipHeight)
+                    return false;
+
+                const bool   IsBC1    = Tex.Format == COOKED_TEXTURE_FORMAT_BC1;
+                const Uint64 MinPitch = IsBC1 ? Uint64{(MipWidth + 3) / 4} * 8 : Uint64{MipWidth} * 4;
+                const Uint64 Rows     = IsBC1 ? (MipHeight + 3) / 4 : MipHeight;
+                if (Mip.RowPitch < MinPitch || Uint64{Mip.RowPitch} * Rows > Mip.DataSize)
+                    return false;
+            }
+        }
+        for (Uint32 m = 0; m < View.NumMips; ++m)
+        {
+            const auto& Mip = View.pMips[m];
+            if (Mip.DataOffset > View.TexelsSize || Mip.DataSize > View.TexelsSize - Mip.DataOffset)
+                return false;
+        }
+        return true;
+    }
+
+    static constexpr const char* CacheDir = "ModelCache";
+
+private:
+    static constexpr Uint64 SectionAlignment = 16;
+
+    static Uint64 AlignUp(Uint64 Offset) { return (Offset + SectionAlignment - 1) & ~(SectionAlignment - 1); }
+
+    static void CreateCacheDir()
+    {
+#ifdef _WIN32
+        CreateDirectoryA(CacheDir, nullptr);
+#else
+        mkdir(CacheDir, 0755);
+#endif
+    }
+};
+
+// -----------------------------------------------------------------------------
+// Cache caliente: el .dgcm proyectado en memoria mas la vista sobre el.
+// Mantener vivo mientras se usen los punteros de View.
+// -----------------------------------------------------------------------------
+struct MappedCookedModel
+{
+    MappedFile      File;
+    CookedModelView View;
+
+    // Abre y valida contra el hash actual de las fuentes. false si no existe,
+    // esta corrupta o alguna fuente cambio: hay que volver a cocinar.
+    bool Open(const std::string& CachePath, const std::string& SourcePath, Uint64 SettingsHash)
+    {
+        if (!File.Open(CachePath) || !ModelCache::Parse(File.GetData(), File.GetSize(), View))
+        {
+            File.Close();
+            return false;
+        }
+
+        std::vector<std::string> Dependencies;
+        View.ForEachDependency([&](std::string Dep) { Dependencies.push_back(std::move(Dep)); });
+
+        Uint64 Hash = 0;
+        if (Dependencies.empty() || !ModelCache::HashSources(ModelCache::GetBaseDir(SourcePath), Dependencies, SettingsHash, Hash) ||
+            Hash != View.SourceHash)
+        {
+            File.Close();
+            View = {};
+            return false;
+        }
+        return true;
+    }
+};
+
+} // namespace Diligent
@@ -0,0 +1,1146 @@
+#pragma once
+#include "ModelCache.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "json.hpp"
+#include "stb_image.h" // la implementacion esta en Tutorial03_Texturing.cpp
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace Diligent
+{
+
+struct ModelCookSettings
+{
+    bool CompressBaseColor = true; // BC1 para albedo opaco con lados multiplo de 4
+    bool GenerateMips      = true;
+    bool OptimizeMeshes    = true; // MeshOptimizer por primitiva (cache de vertices, overdraw, fetch)
+    bool GenerateLods      = true; // LOD1..CookedMaxLods-1 con MeshSimplifier
+
+    Uint64 GetHash() const
+    {
+        FNV1aHash Hash;
+        Hash.AddPOD(CompressBaseColor);
+        Hash.AddPOD(GenerateMips);
+        Hash.AddPOD(OptimizeMeshes);
+        Hash.AddPOD(GenerateLods);
+        return Hash.Value;
+    }
+};
+
+// Lo que entrega ModelCooker::Acquire: la vista y quien es dueno de sus datos
+// (el fichero proyectado si la cache valia, o el resultado del cooker)
+struct CookedModelSource
+{
+    MappedCookedModel Mapped;
+    CookedModelData   Data;
+    CookedModelView   View;
+
+    bool        Ok        = false;
+    bool        FromCache = false;
+    double      TimeMs    = 0.0; // abrir + validar, o cocinar + escribir
+    std::string Error;
+};
+
+// -----------------------------------------------------------------------------
+// Cooker de modelos GLTF (.gltf + buffers externos o data URIs).
+//   Convierte lo que el loader GLTF rehace en cada arranque en datos listos
+//   para GPU: vertices intercalados en el layout de ModelVertexAttrs, indices
+//   de 32 bits ya rebasados (BaseVertex = 0), la escena por defecto aplanada
+//   con matrices globales y las texturas de color base y normales
+//   decodificadas a RGBA8 con su cadena de mips (el albedo opcionalmente en
+//   BC1). Con OptimizeMeshes cada primitiva pasa por MeshOptimizer (orden
+//   de triangulos y de vertices) y el informe va en CookedModelStats; con
+//   GenerateLods se anaden LODs simplificados que reutilizan sus vertices.
+//   Solo usa CPU: se puede llamar desde cualquier hilo.
+// -----------------------------------------------------------------------------
+class ModelCooker
+{
+public:
+    // Cache valida -> proyectada; si no, cocina y la reescribe
+    static std::unique_ptr<CookedModelSource> Acquire(const std::string& SourcePath, const ModelCookSettings& Settings)
+    {
+        auto       pSource   = std::make_unique<CookedModelSource>();
+        const auto tStart    = std::chrono::high_resolution_clock::now();
+        const auto CachePath = ModelCache::GetCachePath(SourcePath);
+
+        if (pSource->Mapped.Open(CachePath, SourcePath, Settings.GetHash()))
+        {
+            pSource->View      = pSource->Mapped.View;
+            pSource->FromCache = true;
+            pSource->Ok        = true;
+        }
+        else if (Cook(SourcePath, Settings, pSource->Data, pSource->Error))
+        {
+            // Sin cache escribible se sigue funcionando, solo que en frio
+            if (!ModelCache::Write(CachePath, pSource->Data))
+                OutputDebugStringA(("ModelCooker: no se pudo escribir " + CachePath + "\n").c_str());
+            pSource->View = pSource->Data.GetView();
+            pSource->Ok   = true;
+        }
+
+        const std::chrono::duration<double, std::milli> Elapsed = std::chrono::high_resolution_clock::now() - tStart;
+        pSource->TimeMs                                         = Elapsed.count();
+        return pSource;
+    }
+
+    static bool Cook(const std::string& SourcePath, const ModelCookSettings& Settings, CookedModelData& Out, std::string& Error)
+    {
+        Out = {};
+        try
+        {
+            Context Ctx{SourcePath, Settings, Out};
+            if (!Ctx.Run(Error))
+                return false;
+        }
+        catch (const std::exception& e)
+        {
+            Error = SourcePath + ": " + e.what();
+            return false;
+        }
+
+        if (!ModelCache::HashSources(ModelCache::GetBaseDir(SourcePath), Out.Dependencies, Settings.GetHash(), Out.SourceHash))
+        {
+            Error = SourcePath + ": no se pudieron releer las fuentes para el hash";
+            return false;
+        }
+        return true;
+    }
+
+    // Un bloque 4x4 RGBA8 -> 8 bytes BC1. Extremos: los texels con menor y
+    // mayor proyeccion sobre el eje de mayor rango (con el signo de la
+    // covarianza en los otros dos canales); indices al color mas cercano.
+    static void CompressBC1Block(const Uint8 (&Block)[16][4], Uint8* pOut)
+    {
+        float Mean[3] = {};
+        Uint8 Min[3]  = {255, 255, 255};
+        Uint8 Max[3]  = {0, 0, 0};
+        for (const auto& Px : Block)
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                Mean[c] += Px[c] / 16.f;
+                Min[c] = (std::min)(Min[c], Px[c]);
+                Max[c] = (std::max)(Max[c], Px[c]);
+            }
+        }
+
+        int Major = 0;
+        for (int c = 1; c < 3; ++c)
+        {
+            if (Max[c] - Min[c] > Max[Major] - Min[Major])
+                Major = c;
+        }
+
+        float Axis[3] = {};
+        for (int c = 0; c < 3; ++c)
+        {
+            float Cov = 0.f;
+            for (const auto& Px : Block)
+                Cov += (Px[c] - Mean[c]) * (Px[Major] - Mean[Major]);
+            Axis[c] = static_cast<float>(Max[c] - Min[c]) * (c == Major || Cov >= 0.f ? 1.f : -1.f);
+        }
+
+        int   MinIdx = 0, MaxIdx = 0;
+        float MinDot = FLT_MAX, MaxDot = -FLT_MAX;
+        for (int i = 0; i < 16; ++i)
+        {
+            const float Dot = Block[i][0] * Axis[0] + Block[i][1] * Axis[1] + Block[i][2] * Axis[2];
+            if (Dot < MinDot)
+            {
+                MinDot = Dot;
+                MinIdx = i;
+            }
+            if (Dot > MaxDot)
+            {
+                MaxDot = Dot;
+                MaxIdx = i;
+            }
+        }
+
+        Uint16 C0 = To565(Block[MaxIdx]);
+        Uint16 C1 = To565(Block[MinIdx]);
+        if (C0 < C1)
+            std::swap(C0, C1);
+
+        Uint32 Indices = 0;
+        if (C0 != C1) // C0 > C1: modo de 4 colores, sin alfa
+        {
+            int Palette[4][3];
+            From565(C0, Palette[0]);
+            From565(C1, Palette[1]);
+            for (int c = 0; c < 3; ++c)
+            {
+                Palette[2][c] = (2 * Palette[0][c] + Palette[1][c]) / 3;
+                Palette[3][c] = (Palette[0][c] + 2 * Palette[1][c]) / 3;
+            }
+
+            for (int i = 0; i < 16; ++i)
+            {
+                int BestDist = INT_MAX;
+                int Best     = 0;
+                for (int p = 0; p < 4; ++p)
+                {
+                    int Dist = 0;
+                    for (int c = 0; c < 3; ++c)
+                        Dist += (Block[i][c] - Palette[p][c]) * (Block[i][c] - Palette[p][c]);
+                    if (Dist < BestDist)
+                    {
+                        BestDist = Dist;
+                        Best     = p;
+                    }
+                }
+                Indices |= static_cast<Uint32>(Best) << (2 * i);
+            }
+        }
+
+        pOut[0] = static_cast<Uint8>(C0 & 0xFF);
+        pOut[1] = static_cast<Uint8>(C0 >> 8);
+        pOut[2] = static_cast<Uint8>(C1 & 0xFF);
+        pOut[3] = static_cast<Uint8>(C1 >> 8);
+        for (int b = 0; b < 4; ++b)
+            pOut[4 + b] = static_cast<Uint8>(Indices >> (8 * b));
+    }
+
+private:
+    static Uint16 To565(const Uint8* Px)
+    {
+        const Uint32 R = (Px[0] * 31u + 127u) / 255u;
+        const Uint32 G = (Px[1] * 63u + 127u) / 255u;
+        const Uint32 B = (Px[2] * 31u + 127u) / 255u;
+        return static_cast<Uint16>((R << 11) | (G << 5) | B);
+    }
+
+    static void From565(Uint16 C, int (&Out)[3])
+    {
+        const int R = (C >> 11) & 31;
+        const int G = (C >> 5) & 63;
+        const int B = C & 31;
+        Out[0]      = (R << 3) | (R >> 2);
+        Out[1]      = (G << 2) | (G >> 4);
+        Out[2]      = (B << 3) | (B >> 2);
+    }
+
+    using json = nlohmann::json;
+
+    enum GLTF_COMPONENT_TYPE : Uint32
+    {
+        GLTF_BYTE           = 5120,
+        GLTF_UNSIGNED_BYTE  = 5121,
+        GLTF_SHORT          = 5122,
+        GLTF_UNSIGNED_SHORT = 5123,
+        GLTF_UNSIGNED_INT   = 5125,
+        GLTF_FLOAT          = 5126
+    };
+
+    static constexpr int GLTF_MODE_TRIANGLES = 4;
+
+    // Buffer GLTF: proyectado si es un fichero, decodificado si es un data URI
+    struct GltfBuffer
+    {
+        std::unique_ptr<MappedFile> pFile;
+        std::vector<Uint8>          Decoded;
+
+        const Uint8* GetData() const { return pFile ? pFile->GetData() : Decoded.data(); }
+        size_t       GetSize() const { return pFile ? pFile->GetSize() : Decoded.size(); }
+    };
+
+    struct Accessor
+    {
+        const Uint8* pData         = nullptr; // nullptr: accessor sin bufferView, todo ceros
+        Uint32       Count         = 0;
+        Uint32       Stride        = 0;
+        Uint32       ComponentType = GLTF_FLOAT;
+        Uint32       NumComponents = 1;
+        bool         Normalized    = false;
+
+        float ReadFloat(Uint32 Elem, Uint32 Comp) const
+        {
+            if (pData == nullptr || Comp >= NumComponents)
+                return 0.f;
+
+            const Uint8* p = pData + size_t{Elem} * Stride;
+            switch (ComponentType)
+            {
+                case GLTF_FLOAT:
+                {
+                    float v;
+                    std::memcpy(&v, p + Comp * 4, 4);
+                    return v;
+                }
+                case GLTF_UNSIGNED_BYTE:
+                    return Normalized ? p[Comp] / 255.f : p[Comp];
+                case GLTF_BYTE:
+                {
+                    const float v = static_cast<Int8>(p[Comp]);
+                    return Normalized ? (std::max)(v / 127.f, -1.f) : v;
+                }
+                case GLTF_UNSIGNED_SHORT:
+                {
+                    Uint16 v;
+                    std::memcpy(&v, p + Comp * 2, 2);
+                    return Normalized ? v / 65535.f : v;
+                }
+                case GLTF_SHORT:
+                {
+                    Int16 v;
+                    std::memcpy(&v, p + Comp * 2, 2);
+                    return Normalized ? (std::max)(v / 32767.f, -1.f) : v;
+                }
+                default:
+                    return 0.f;
+            }
+        }
+
+        Uint32 ReadIndex(Uint32 Elem) const
+        {
+            if (pData == nullptr)
+                return 0;
+
+            const Uint8* p = pData + size_t{Elem} * Stride;
+            switch (ComponentType)
+            {
+                case GLTF_UNSIGNED_BYTE: return p[0];
+                case GLTF_UNSIGNED_SHORT:
+                {
+                    Uint16 v;
+                    std::memcpy(&v, p, 2);
+                    return v;
+                }
+                case GLTF_UNSIGNED_INT:
+                {
+                    Uint32 v;
+                    std::memcpy(&v, p, 4);
+                    return v;
+                }
+                default:
+                    return 0;
+            }
+        }
+    };
+
+    // Estado de un cocinado
+    struct Context
+    {
+        const std::string&       SourcePath;
+        const ModelCookSettings& Settings;
+        CookedModelData&         Out;
+
+        std::string                      BaseDir;
+        json                             Doc;
+        std::vector<GltfBuffer>          Buffers;
+        std::unordered_set<std::string>  DepSet;
+        std::map<std::pair<int, int>, Int32> ImageTextures; // (imagen, slot) -> textura cocinada
+        std::vector<Int32>               MeshRemap;         // malla GLTF -> CookedMesh
+        Int32                            DefaultMaterial = -1;
+
+        // Acumulado de todas las primitivas para CookedModelStats
+        struct
+        {
+            Uint64 Triangles = 0, Vertices = 0, Clusters = 0;
+            Uint64 MissesBefore = 0, MissesAfter = 0;
+            Uint64 FetchBefore = 0, FetchAfter = 0; // lineas de FetchLineSize bytes
+            Uint64 LodTriangles[CookedMaxLods] = {};
+        } Geometry;
+
+        // Cadena de LODs: fraccion de triangulos del LOD0 que se pide y error
+        // maximo (relativo al tamano de la primitiva) que se acepta para ello
+        static constexpr float  LodRatios[CookedMaxLods]    = {1.f, 0.5f, 0.25f, 0.125f};
+        static constexpr float  LodMaxErrors[CookedMaxLods] = {0.f, 0.01f, 0.03f, 0.08f};
+        static constexpr float  LodMinReduction             = 0.8f; // un LOD con mas del 80% del anterior no compensa
+        static constexpr Uint32 LodMinTriangles             = 64;   // por debajo no se generan LODs
+
+        Context(const std::string& Path, const ModelCookSettings& S, CookedModelData& O) :
+            SourcePath{Path}, Settings{S}, Out{O}, BaseDir{ModelCache::GetBaseDir(Path)}
+        {}
+
+        bool Run(std::string& Error)
+        {
+            MappedFile GltfFile;
+            if (!GltfFile.Open(SourcePath))
+            {
+                Error = SourcePath + ": no se pudo abrir";
+                return false;
+            }
+            Doc = json::parse(GltfFile.GetData(), GltfFile.GetData() + GltfFile.GetSize());
+            AddDependency(SourcePath.substr(BaseDir.size()));
+
+            if (!LoadBuffers(Error) || !CookMaterials(Error) || !CookMeshes(Error) || !CookNodes(Error))
+            {
+                Error = SourcePath + ": " + Error;
+                return false;
+            }
+            FillStats();
+            return true;
+        }
+
+        void FillStats()
+        {
+            auto Ratio = [](Uint64 Num, Uint64 Den) { return Den > 0 ? static_cast<float>(static_cast<double>(Num) / Den) : 0.f; };
+
+            const Uint64      VertexBytes = Geometry.Vertices * sizeof(CookedVertex);
+            CookedModelStats& Stats       = Out.Stats;
+            Stats                         = {};
+            Stats.NumTriangles            = static_cast<Uint32>(Geometry.Triangles);
+            Stats.NumVertices             = static_cast<Uint32>(Geometry.Vertices);
+            Stats.NumClusters             = static_cast<Uint32>(Geometry.Clusters);
+            Stats.Optimized               = Settings.OptimizeMeshes ? 1 : 0;
+            Stats.AcmrBefore              = Ratio(Geometry.MissesBefore, Geometry.Triangles);
+            Stats.AcmrAfter               = Ratio(Geometry.MissesAfter, Geometry.Triangles);
+            Stats.AtvrBefore              = Ratio(Geometry.MissesBefore, Geometry.Vertices);
+            Stats.AtvrAfter               = Ratio(Geometry.MissesAfter, Geometry.Vertices);
+            Stats.OverfetchBefore         = Ratio(Geometry.FetchBefore * MeshOptimizer::FetchLineSize, VertexBytes);
+            Stats.OverfetchAfter          = Ratio(Geometry.FetchAfter * MeshOptimizer::FetchLineSize, VertexBytes);
+            for (Uint32 l = 0; l < CookedMaxLods; ++l)
+                Stats.LodTriangles[l] = static_cast<Uint32>(Geometry.LodTriangles[l]);
+        }
+
+        void AddDependency(const std::string& Dep)
+        {
+            if (DepSet.insert(Dep).second)
+                Out.Dependencies.push_back(Dep);
+        }
+
+        bool LoadBuffers(std::string& Error)
+        {
+            if (!Doc.contains("buffers"))
+                return true;
+
+            for (const auto& Buf : Doc["buffers"])
+            {
+                GltfBuffer Data;
+                if (!LoadUri(Buf.value("uri", std::string{}), Data, Error))
+                    return false;
+                if (Data.GetSize() < Buf.value("byteLength", size_t{0}))
+                {
+                    Error = "buffer mas corto que su byteLength";
+                    return false;
+                }
+                Buffers.push_back(std::move(Data));
+            }
+            return true;
+        }
+
+        // Fichero relativo al .gltf (queda como dependencia) o data URI base64
+        bool LoadUri(const std::string& Uri, GltfBuffer& Data, std::string& Error)
+        {
+            if (Uri.empty())
+            {
+                Error = "buffer sin uri (GLB no soportado)";
+                return false;
+            }
+            if (Uri.compare(0, 5, "data:") == 0)
+            {
+                const auto Comma = Uri.find(";base64,");
+                if (Comma == std::string::npos || !DecodeBase64(Uri.substr(Comma + 8), Data.Decoded))
+                {
+                    Error = "data URI no valida";
+                    return false;
+                }
+                return true;
+            }
+
+            const std::string Path = DecodeUri(Uri);
+            Data.pFile             = std::make_unique<MappedFile>();
+            if (!Data.pFile->Open(BaseDir + Path))
+            {
+                Error = "no se pudo abrir " + Path;
+                return false;
+            }
+            AddDependency(Path);
+            return true;
+        }
+
+        bool GetAccessor(int Index, Accessor& Acc, std::string& Error) const
+        {
+            const auto& Accessors = Doc.at("accessors");
+            if (Index < 0 || Index >= static_cast<int>(Accessors.size()))
+            {
+                Error = "accessor fuera de rango";
+                return false;
+            }
+
+            const auto& A = Accessors[Index];
+            if (A.contains("sparse"))
+            {
+                Error = "accessors sparse no soportados";
+                return false;
+            }
+
+            static const std::map<std::string, Uint32> TypeComponents = {{"SCALAR", 1}, {"VEC2", 2}, {"VEC3", 3}, {"VEC4", 4}, {"MAT4", 16}};
+
+            const auto TypeIt = TypeComponents.find(A.at("type").get<std::string>());
+            if (TypeIt == TypeComponents.end())
+            {
+                Error = "tipo de accessor no soportado";
+                return false;
+            }
+
+            Acc               = {};
+            Acc.Count         = A.at("count").get<Uint32>();
+            Acc.ComponentType = A.at("componentType").get<Uint32>();
+            Acc.NumComponents = TypeIt->second;
+            Acc.Normalized    = A.value("normalized", false);
+
+            const Uint32 CompSize = Acc.ComponentType == GLTF_FLOAT || Acc.ComponentType == GLTF_UNSIGNED_INT ? 4 :
+                (Acc.ComponentType == GLTF_SHORT || Acc.ComponentType == GLTF_UNSIGNED_SHORT)                 ? 2 :
+                                                                                                                1;
+            const Uint32 ElemSize = CompSize * Acc.NumComponents;
+            Acc.Stride            = ElemSize;
+
+            if (!A.contains("bufferView"))
+                return true;
+
+            const auto&  View      = Doc.at("bufferViews").at(A["bufferView"].get<size_t>());
+            const size_t BufferId  = View.at("buffer").get<size_t>();
+            const size_t ViewStart = View.value("byteOffset", size_t{0});
+            const size_t ViewSize  = View.at("byteLength").get<size_t>();
+            Acc.Stride             = View.value("byteStride", ElemSize);
+
+            const size_t Start = ViewStart + A.value("byteOffset", size_t{0});
+            const size_t Span  = Acc.Count == 0 ? 0 : size_t{Acc.Stride} * (Acc.Count - 1) + ElemSize;
+            if (BufferId >= Buffers.size() || ViewStart + ViewSize > Buffers[BufferId].GetSize() || Start + Span > ViewStart + ViewSize)
+            {
+                Error = "accessor fuera de su buffer";
+                return false;
+            }
+            Acc.pData = Buffers[BufferId].GetData() + Start;
+            return true;
+        }
+
+        bool CookMaterials(std::string& Error)
+        {
+            if (!Doc.contains("materials"))
+                return true;
+
+            for (const auto& Mat : Doc["materials"])
+            {
+                CookedMaterial Cooked;
+                for (auto& TexId : Cooked.TextureIds)
+                    TexId = -1;
+
+                const json* pTexInfo[COOKED_TEXTURE_SLOT_COUNT] = {};
+                if (Mat.contains("pbrMetallicRoughness") && Mat["pbrMetallicRoughness"].contains("baseColorTexture"))
+                    pTexInfo[COOKED_TEXTURE_SLOT_BASE_COLOR] = &Mat["pbrMetallicRoughness"]["baseColorTexture"];
+                if (Mat.contains("normalTexture"))
+                    pTexInfo[COOKED_TEXTURE_SLOT_NORMAL] = &Mat["normalTexture"];
+
+                for (Uint32 Slot = 0; Slot < COOKED_TEXTURE_SLOT_COUNT; ++Slot)
+                {
+                    if (pTexInfo[Slot] == nullptr)
+                        continue;
+                    const auto& Tex = Doc.at("textures").at(pTexInfo[Slot]->at("index").get<size_t>());
+                    if (!Tex.contains("source"))
+                        continue;
+                    if (!CookImage(Tex["source"].get<int>(), Slot, Cooked.TextureIds[Slot], Error))
+                        return false;
+                }
+                Out.Materials.push_back(Cooked);
+            }
+            return true;
+        }
+
+        bool CookImage(int ImageId, Uint32 Slot, Int32& TexId, std::string& Error)
+        {
+            auto It = ImageTextures.find({ImageId, static_cast<int>(Slot)});
+            if (It != ImageTextures.end())
+            {
+                TexId = It->second;
+                return true;
+            }
+
+            const auto&  Img   = Doc.at("images").at(static_cast<size_t>(ImageId));
+            const Uint8* pData = nullptr;
+            size_t       Size  = 0;
+
+            GltfBuffer UriData;
+            if (Img.contains("uri"))
+            {
+                if (!LoadUri(Img["uri"].get<std::string>(), UriData, Error))
+                    return false;
+                pData = UriData.GetData();
+                Size  = UriData.GetSize();
+            }
+            else
+            {
+                const auto&  View     = Doc.at("bufferViews").at(Img.at("bufferView").get<size_t>());
+                const size_t BufferId = View.at("buffer").get<size_t>();
+                const size_t Offset   = View.value("byteOffset", size_t{0});
+                Size                  = View.at("byteLength").get<size_t>();
+                if (BufferId >= Buffers.size() || Offset + Size > Buffers[BufferId].GetSize())
+                {
+                    Error = "imagen fuera de su buffer";
+                    return false;
+                }
+                pData = Buffers[BufferId].GetData() + Offset;
+            }
+
+            int       W = 0, H = 0, NumChannels = 0;
+            stbi_uc* pPixels = stbi_load_from_memory(pData, static_cast<int>(Size), &W, &H, &NumChannels, 4);
+            if (pPixels == nullptr)
+            {
+                Error = "no se pudo decodificar la imagen " + std::to_string(ImageId);
+                return false;
+            }
+            std::vector<Uint8> Level0{pPixels, pPixels + size_t{Uint32(W)} * Uint32(H) * 4};
+            stbi_image_free(pPixels);
+
+            TexId = static_cast<Int32>(Out.Textures.size());
+            ImageTextures[{ImageId, static_cast<int>(Slot)}] = TexId;
+            AddTexture(std::move(Level0), static_cast<Uint32>(W), static_cast<Uint32>(H), Slot == COOKED_TEXTURE_SLOT_BASE_COLOR);
+            return true;
+        }
+
+        void AddTexture(std::vector<Uint8> Level, Uint32 W, Uint32 H, bool IsBaseColor)
+        {
+            bool Opaque = true;
+            for (size_t i = 3; i < Level.size() && Opaque; i += 4)
+                Opaque = Level[i] == 255;
+
+            CookedTexture Tex = {};
+            Tex.Width         = W;
+            Tex.Height        = H;
+            Tex.FirstMip      = static_cast<Uint32>(Out.Mips.size());
+            Tex.Format        = IsBaseColor && Settings.CompressBaseColor && Opaque && W % 4 == 0 && H % 4 == 0 ?
+                COOKED_TEXTURE_FORMAT_BC1 :
+                COOKED_TEXTURE_FORMAT_RGBA8;
+
+            for (;;)
+            {
+                CookedMip Mip  = {};
+                Mip.Width      = W;
+                Mip.Height     = H;
+                Mip.DataOffset = Out.Texels.size();
+                if (Tex.Format == COOKED_TEXTURE_FORMAT_BC1)
+                {
+                    Mip.RowPitch = (std::max)(1u, (W + 3) / 4) * 8;
+                    CompressBC1(Level, W, H);
+                }
+                else
+                {
+                    Mip.RowPitch = W * 4;
+                    Out.Texels.insert(Out.Texels.end(), Level.begin(), Level.end());
+                }
+                Mip.DataSize = Out.Texels.size() - Mip.DataOffset;
+                // Siguiente mip alineado a 16 para que ningun blob cruce mal una pagina
+                Out.Texels.resize((Out.Texels.size() + 15) & ~size_t{15});
+                Out.Mips.push_back(Mip);
+                ++Tex.MipLevels;
+
+                if (!Settings.GenerateMips || (W == 1 && H == 1))
+                    break;
+                Level = Downsample(Level, W, H);
+                W     = (std::max)(1u, W / 2);
+                H     = (std::max)(1u, H / 2);
+            }
+            Out.Textures.push_back(Tex);
+        }
+
+        // Box filter 2x2; en lados impares la ultima fila/columna se repite
+        static std::vector<Uint8> Downsample(const std::vector<Uint8>& Src, Uint32 W, Uint32 H)
+        {
+            const Uint32       W2 = (std::max)(1u, W / 2);
+            const Uint32       H2 = (std::max)(1u, H / 2);
+            std::vector<Uint8> Dst(size_t{W2} * H2 * 4);
+            for (Uint32 y = 0; y < H2; ++y)
+            {
+                const Uint32 y0 = (std::min)(2 * y, H - 1);
+                const Uint32 y1 = (std::min)(2 * y + 1, H - 1);
+                for (Uint32 x = 0; x < W2; ++x)
+                {
+                    const Uint32 x0 = (std::min)(2 * x, W - 1);
+                    const Uint32 x1 = (std::min)(2 * x + 1, W - 1);
+                    for (Uint32 c = 0; c < 4; ++c)
+                    {
+                        const Uint32 Sum = Src[(size_t{y0} * W + x0) * 4 + c] + Src[(size_t{y0} * W + x1) * 4 + c] +
+                            Src[(size_t{y1} * W + x0) * 4 + c] + Src[(size_t{y1} * W + x1) * 4 + c];
+                        Dst[(size_t{y} * W2 + x) * 4 + c] = static_cast<Uint8>((Sum + 2) / 4);
+                    }
+                }
+            }
+            return Dst;
+        }
+
+        // Bloques 4x4; en mips de menos de 4 texels se repite el borde
+        void CompressBC1(const std::vector<Uint8>& Src, Uint32 W, Uint32 H)
+        {
+            const Uint32 BlocksX = (std::max)(1u, (W + 3) / 4);
+            const Uint32 BlocksY = (std::max)(1u, (H + 3) / 4);
+            for (Uint32 by = 0; by < BlocksY; ++by)
+            {
+                for (Uint32 bx = 0; bx < BlocksX; ++bx)
+                {
+                    Uint8 Block[16][4];
+                    for (Uint32 i = 0; i < 16; ++i)
+                    {
+                        const Uint32 x = (std::min)(bx * 4 + i % 4, W - 1);
+                        const Uint32 y = (std::min)(by * 4 + i / 4, H - 1);
+                        std::memcpy(Block[i], &Src[(size_t{y} * W + x) * 4], 4);
+                    }
+                    const size_t Offset = Out.Texels.size();
+                    Out.Texels.resize(Offset + 8);
+                    CompressBC1Block(Block, &Out.Texels[Offset]);
+                }
+            }
+        }
+
+        Uint32 GetDefaultMaterial()
+        {
+            if (DefaultMaterial < 0)
+            {
+                DefaultMaterial = static_cast<Int32>(Out.Materials.size());
+                Out.Materials.push_back({{-1, -1}});
+            }
+            return static_cast<Uint32>(DefaultMaterial);
+        }
+
+        bool CookMeshes(std::string& Error)
+        {
+            if (!Doc.contains("meshes"))
+                return true;
+
+            const auto& Meshes = Doc["meshes"];
+            MeshRemap.assign(Meshes.size(), -1);
+            for (size_t m = 0; m < Meshes.size(); ++m)
+            {
+                CookedMesh   Mesh        = {};
+                const size_t FirstVertex = Out.Vertices.size();
+                Mesh.FirstPrimitive      = static_cast<Uint32>(Out.Primitives.size());
+                for (const auto& Prim : Meshes[m].at("primitives"))
+                {
+                    // Lineas y puntos no se dibujan con los PSO de triangulos
+                    if (Prim.value("mode", GLTF_MODE_TRIANGLES) != GLTF_MODE_TRIANGLES)
+                        continue;
+                    if (!CookPrimitive(Prim, Error))
+                        return false;
+                }
+                Mesh.NumPrimitives = static_cast<Uint32>(Out.Primitives.size()) - Mesh.FirstPrimitive;
+                MeshRemap[m]       = static_cast<Int32>(Out.Meshes.size());
+                if (Out.Vertices.size() > FirstVertex)
+                {
+                    Mesh.BoundsMin = Mesh.BoundsMax = Out.Vertices[FirstVertex].Pos;
+                    for (size_t v = FirstVertex + 1; v < Out.Vertices.size(); ++v)
+                    {
+                        const float3& p = Out.Vertices[v].Pos;
+                        Mesh.BoundsMin  = float3{(std::min)(Mesh.BoundsMin.x, p.x), (std::min)(Mesh.BoundsMin.y, p.y), (std::min)(Mesh.BoundsMin.z, p.z)};
+                        Mesh.BoundsMax  = float3{(std::max)(Mesh.BoundsMax.x, p.x), (std::max)(Mesh.BoundsMax.y, p.y), (std::max)(Mesh.BoundsMax.z, p.z)};
+                    }
+                }
+                Out.Meshes.push_back(Mesh);
+            }
+            return true;
+        }
+
+        bool CookPrimitive(const json& Prim, std::string& Error)
+        {
+            const auto& Attribs = Prim.at("attributes");
+            if (!Attribs.contains("POSITION"))
+            {
+                Error = "primitiva sin POSITION";
+                return false;
+            }
+
+            Accessor Pos, Normal, UV, Tangent;
+            if (!GetAccessor(Attribs["POSITION"].get<int>(), Pos, Error))
+                return false;
+            const bool HasNormal  = Attribs.contains("NORMAL");
+            const bool HasUV      = Attribs.contains("TEXCOORD_0");
+            const bool HasTangent = Attribs.contains("TANGENT");
+            if ((HasNormal && !GetAccessor(Attribs["NORMAL"].get<int>(), Normal, Error)) ||
+                (HasUV && !GetAccessor(Attribs["TEXCOORD_0"].get<int>(), UV, Error)) ||
+                (HasTangent && !GetAccessor(Attribs["TANGENT"].get<int>(), Tangent, Error)))
+                return false;
+
+            const Uint32 NumVerts = Pos.Count;
+            if ((HasNormal && Normal.Count < NumVerts) || (HasUV && UV.Count < NumVerts) || (HasTangent && Tangent.Count < NumVerts))
+            {
+                Error = "atributos con menos elementos que POSITION";
+                return false;
+            }
+
+            const Uint32 BaseVertex = static_cast<Uint32>(Out.Vertices.size());
+            Out.Vertices.resize(size_t{BaseVertex} + NumVerts);
+            CookedVertex* pVerts = &Out.Vertices[BaseVertex];
+            for (Uint32 v = 0; v < NumVerts; ++v)
+            {
+                CookedVertex& Vert = pVerts[v];
+                Vert.Pos           = float3{Pos.ReadFloat(v, 0), Pos.ReadFloat(v, 1), Pos.ReadFloat(v, 2)};
+                Vert.Normal        = HasNormal ? float3{Normal.ReadFloat(v, 0), Normal.ReadFloat(v, 1), Normal.ReadFloat(v, 2)} : float3{};
+                Vert.UV            = HasUV ? float2{UV.ReadFloat(v, 0), UV.ReadFloat(v, 1)} : float2{};
+                Vert.Tangent       = HasTangent ? float4{Tangent.ReadFloat(v, 0), Tangent.ReadFloat(v, 1), Tangent.ReadFloat(v, 2), Tangent.ReadFloat(v, 3)} : float4{};
+            }
+
+            CookedPrimitive Cooked = {};
+            Cooked.FirstIndex      = static_cast<Uint32>(Out.Indices.size());
+            if (Prim.contains("indices"))
+            {
+                Accessor Idx;
+                if (!GetAccessor(Prim["indices"].get<int>(), Idx, Error))
+                    return false;
+                for (Uint32 i = 0; i < Idx.Count; ++i)
+                {
+                    const Uint32 Index = Idx.ReadIndex(i);
+                    if (Index >= NumVerts)
+                    {
+                        Error = "indice fuera de rango";
+                        return false;
+                    }
+                    Out.Indices.push_back(BaseVertex + Index);
+                }
+            }
+            else
+            {
+                for (Uint32 i = 0; i < NumVerts; ++i)
+                    Out.Indices.push_back(BaseVertex + i);
+            }
+            Cooked.IndexCount = static_cast<Uint32>(Out.Indices.size()) - Cooked.FirstIndex;
+            Cooked.IndexCount -= Cooked.IndexCount % 3;
+            Out.Indices.resize(size_t{Cooked.FirstIndex} + Cooked.IndexCount);
+
+            const Int32 MatId = Prim.value("material", -1);
+            Cooked.MaterialId = MatId >= 0 && MatId < static_cast<Int32>(Out.Materials.size()) ? static_cast<Uint32>(MatId) : GetDefaultMaterial();
+
+            if (!HasNormal)
+                ComputeNormals(pVerts, NumVerts, &Out.Indices[Cooked.FirstIndex], Cooked.IndexCount, BaseVertex);
+            if (!HasTangent)
+                ComputeTangents(pVerts, NumVerts, &Out.Indices[Cooked.FirstIndex], Cooked.IndexCount, BaseVertex);
+
+            const Uint32 NumUsedVerts = OptimizePrimitive(BaseVertex, NumVerts, Cooked);
+            GeneratePrimitiveLods(BaseVertex, NumUsedVerts, Cooked);
+
+            Out.Primitives.push_back(Cooked);
+            return true;
+        }
+
+        // Mide la primitiva (es la ultima anadida: sus vertices cierran
+        // Out.Vertices) y, si Settings.OptimizeMeshes, la reordena con
+        // MeshOptimizer y recorta los vertices que no usa ningun indice.
+        // Devuelve los vertices que le quedan.
+        Uint32 OptimizePrimitive(Uint32 BaseVertex, Uint32 NumVerts, const CookedPrimitive& Cooked)
+        {
+            const Uint32 NumIndices = Cooked.IndexCount;
+            Uint32*      pIndices   = Out.Indices.data() + Cooked.FirstIndex;
+            for (Uint32 i = 0; i < NumIndices; ++i)
+                pIndices[i] -= BaseVertex;
+
+            const Uint32 MissesBefore = MeshOptimizer::CountCacheMisses(pIndices, NumIndices, NumVerts);
+            const Uint32 FetchBefore  = MeshOptimizer::CountFetchMisses(pIndices, NumIndices, NumVerts, sizeof(CookedVertex));
+            Geometry.Triangles += NumIndices / 3;
+            Geometry.Vertices += MeshOptimizer::CountReferencedVertices(pIndices, NumIndices, NumVerts);
+            Geometry.MissesBefore += MissesBefore;
+            Geometry.FetchBefore += FetchBefore;
+
+            Uint32 NumUsed = NumVerts;
+            if (Settings.OptimizeMeshes && NumIndices > 0)
+            {
+                CookedVertex*       pVerts = &Out.Vertices[BaseVertex];
+                std::vector<Uint32> HardClusters;
+                MeshOptimizer::OptimizeVertexCache(pIndices, NumIndices, NumVerts, pIndices, HardClusters);
+                Geometry.Clusters += MeshOptimizer::OptimizeOverdraw(pIndices, NumIndices, NumVerts, HardClusters, &pVerts->Pos, sizeof(CookedVertex));
+                NumUsed = MeshOptimizer::OptimizeVertexFetch(pIndices, NumIndices, pVerts, NumVerts, sizeof(CookedVertex));
+                Out.Vertices.resize(size_t{BaseVertex} + NumUsed);
+
+                Geometry.MissesAfter += MeshOptimizer::CountCacheMisses(pIndices, NumIndices, NumUsed);
+                Geometry.FetchAfter += MeshOptimizer::CountFetchMisses(pIndices, NumIndices, NumUsed, sizeof(CookedVertex));
+            }
+            else
+            {
+                Geometry.MissesAfter += MissesBefore;
+                Geometry.FetchAfter += FetchBefore;
+            }
+
+            for (Uint32 i = 0; i < NumIndices; ++i)
+                pIndices[i] += BaseVertex;
+            return NumUsed;
+        }
+
+        // LOD1.. con MeshSimplifier, siempre desde el LOD0 para que el error
+        // se mida contra la malla completa. Sus indices van detras de los del
+        // LOD0 en Out.Indices, sobre los mismos vertices.
+        void GeneratePrimitiveLods(Uint32 BaseVertex, Uint32 NumVerts, CookedPrimitive& Cooked)
+        {
+            Cooked.NumLods = 1;
+            if (Settings.GenerateLods && Cooked.IndexCount / 3 >= LodMinTriangles)
+            {
+                std::vector<Uint32> Lod0(Out.Indices.begin() + Cooked.FirstIndex, Out.Indices.begin() + Cooked.FirstIndex + Cooked.IndexCount);
+                for (Uint32& Index : Lod0)
+                    Index -= BaseVertex;
+
+                std::vector<Uint32> Simplified, HardClusters;
+                Uint32              PrevCount = Cooked.IndexCount;
+                for (Uint32 l = 1; l < CookedMaxLods; ++l)
+                {
+                    const Uint32 Target = static_cast<Uint32>(Cooked.IndexCount * LodRatios[l]) / 3 * 3;
+                    float        Error  = 0.f;
+                    MeshSimplifier::Simplify(Lod0.data(), Cooked.IndexCount, NumVerts, &Out.Vertices[BaseVertex].Pos, sizeof(CookedVertex), Target,
+                                             LodMaxErrors[l], Simplified, &Error);
+                    if (Simplified.empty() || Simplified.size() > PrevCount * LodMinReduction)
+                        break;
+                    if (Settings.OptimizeMeshes)
+                        MeshOptimizer::OptimizeVertexCache(Simplified.data(), static_cast<Uint32>(Simplified.size()), NumVerts, Simplified.data(), HardClusters);
+
+                    CookedLod& Lod = Cooked.Lods[l - 1];
+                    Lod.FirstIndex = static_cast<Uint32>(Out.Indices.size());
+                    Lod.IndexCount = static_cast<Uint32>(Simplified.size());
+                    Lod.Error      = Error;
+                    for (const Uint32 Index : Simplified)
+                        Out.Indices.push_back(BaseVertex + Index);
+                    PrevCount = Lod.IndexCount;
+                    ++Cooked.NumLods;
+                }
+            }
+
+            // Sin ese LOD la primitiva se dibuja con el ultimo que tenga
+            for (Uint32 l = 0; l < CookedMaxLods; ++l)
+            {
+                const Uint32 Lod = (std::min)(l, Cooked.NumLods - 1);
+                Geometry.LodTriangles[l] += (Lod == 0 ? Cooked.IndexCount : Cooked.Lods[Lod - 1].IndexCount) / 3;
+            }
+        }
+
+        // Normales por vertice ponderadas por area
+        static void ComputeNormals(CookedVertex* pVerts, Uint32 NumVerts, const Uint32* pIndices, Uint32 NumIndices, Uint32 BaseVertex)
+        {
+            for (Uint32 t = 0; t + 2 < NumIndices; t += 3)
+            {
+                CookedVertex& V0 = pVerts[pIndices[t] - BaseVertex];
+                CookedVertex& V1 = pVerts[pIndices[t + 1] - BaseVertex];
+                CookedVertex& V2 = pVerts[pIndices[t + 2] - BaseVertex];
+                const float3  N  = cross(V1.Pos - V0.Pos, V2.Pos - V0.Pos);
+                V0.Normal += N;
+                V1.Normal += N;
+                V2.Normal += N;
+            }
+            for (Uint32 v = 0; v < NumVerts; ++v)
+            {
+                const float Len  = length(pVerts[v].Normal);
+                pVerts[v].Normal = Len > 0.f ? pVerts[v].Normal / Len : float3{0, 1, 0};
+            }
+        }
+
+        // Tangentes a partir de las UV (acumuladas por triangulo, Gram-Schmidt
+        // contra la normal; w = orientacion de la bitangente)
+        static void ComputeTangents(CookedVertex* pVerts, Uint32 NumVerts, const Uint32* pIndices, Uint32 NumIndices, Uint32 BaseVertex)
+        {
+            std::vector<float3> Tan(NumVerts), Bitan(NumVerts);
+            for (Uint32 t = 0; t + 2 < NumIndices; t += 3)
+            {
+                const Uint32 i0 = pIndices[t] - BaseVertex;
+                const Uint32 i1 = pIndices[t + 1] - BaseVertex;
+                const Uint32 i2 = pIndices[t + 2] - BaseVertex;
+
+                const float3 E1  = pVerts[i1].Pos - pVerts[i0].Pos;
+                const float3 E2  = pVerts[i2].Pos - pVerts[i0].Pos;
+                const float2 D1  = pVerts[i1].UV - pVerts[i0].UV;
+                const float2 D2  = pVerts[i2].UV - pVerts[i0].UV;
+                const float  Det = D1.x * D2.y - D2.x * D1.y;
+                if (std::abs(Det) < 1e-12f)
+                    continue;
+
+                const float  r = 1.f / Det;
+                const float3 T = (E1 * D2.y - E2 * D1.y) * r;
+                const float3 B = (E2 * D1.x - E1 * D2.x) * r;
+                for (Uint32 i : {i0, i1, i2})
+                {
+                    Tan[i] += T;
+                    Bitan[i] += B;
+                }
+            }
+
+            for (Uint32 v = 0; v < NumVerts; ++v)
+            {
+                const float3& N = pVerts[v].Normal;
+                float3        T = Tan[v] - N * dot(N, Tan[v]);
+                float         L = length(T);
+                if (L < 1e-6f)
+                {
+                    // Sin UV utiles: cualquier perpendicular a la normal
+                    T = std::abs(N.x) < 0.9f ? cross(N, float3{1, 0, 0}) : cross(N, float3{0, 1, 0});
+                    L = length(T);
+                }
+                T /= L;
+                const float W     = dot(cross(N, T), Bitan[v]) < 0.f ? -1.f : 1.f;
+                pVerts[v].Tangent = float4{T.x, T.y, T.z, W};
+            }
+        }
+
+        // Escena por defecto en preorden: los padres quedan antes que sus hijos
+        bool CookNodes(std::string& Error)
+        {
+            if (!Doc.contains("nodes"))
+                return true;
+
+            const auto&       Nodes = Doc["nodes"];
+            std::vector<int>  Roots;
+            std::vector<bool> HasParent(Nodes.size(), false);
+            for (const auto& Node : Nodes)
+            {
+                if (Node.contains("children"))
+                {
+                    for (const auto& Child : Node["children"])
+                        HasParent.at(Child.get<size_t>()) = true;
+                }
+            }
+
+            if (Doc.contains("scenes") && !Doc["scenes"].empty())
+            {
+                const auto& Scene = Doc["scenes"].at(Doc.value("scene", size_t{0}));
+                if (Scene.contains("nodes"))
+                    Roots = Scene["nodes"].get<std::vector<int>>();
+            }
+            else
+            {
+                for (size_t n = 0; n < Nodes.size(); ++n)
+                {
+                    if (!HasParent[n])
+                        Roots.push_back(static_cast<int>(n));
+                }
+            }
+
+            std::vector<bool>                 Visited(Nodes.size(), false);
+            std::vector<std::pair<int, int>> Stack; // (nodo GLTF, padre cocinado)
+            for (auto r = Roots.rbegin(); r != Roots.rend(); ++r)
+                Stack.push_back({*r, -1});
+
+            while (!Stack.empty())
+            {
+                const auto [NodeId, Parent] = Stack.back();
+                Stack.pop_back();
+                if (NodeId < 0 || NodeId >= static_cast<int>(Nodes.size()) || Visited[NodeId])
+                {
+                    Error = "jerarquia de nodos no valida";
+                    return false;
+                }
+                Visited[NodeId] = true;
+
+                const auto& Node  = Nodes[NodeId];
+                CookedNode  Cooked = {};
+                Cooked.Parent      = Parent;
+                Cooked.MeshId      = -1;
+                if (Node.contains("mesh"))
+                {
+                    const size_t MeshId = Node["mesh"].get<size_t>();
+                    if (MeshId >= MeshRemap.size())
+                    {
+                        Error = "nodo con malla fuera de rango";
+                        return false;
+                    }
+                    Cooked.MeshId = MeshRemap[MeshId];
+                }
+                Cooked.LocalMatrix  = GetLocalMatrix(Node);
+                Cooked.GlobalMatrix = Parent >= 0 ? Cooked.LocalMatrix * Out.Nodes[Parent].GlobalMatrix : Cooked.LocalMatrix;
+
+                const int CookedId = static_cast<int>(Out.Nodes.size());
+                Out.Nodes.push_back(Cooked);
+
+                if (Node.contains("children"))
+                {
+                    const auto& Children = Node["children"];
+                    for (auto c = Children.rbegin(); c != Children.rend(); ++c)
+                        Stack.push_back({c->get<int>(), CookedId});
+                }
+            }
+            return true;
+        }
+
+        // Matrix * S * R * T, como Node::ComputeLocalTransform del loader GLTF.
+        // El "matrix" de GLTF es column-major: leido fila a fila ya es la
+        // matriz para vectores fila que usa Diligent.
+        static float4x4 GetLocalMatrix(const json& Node)
+        {
+            float4x4 Local = float4x4::Identity();
+            if (Node.contains("matrix"))
+            {
+                const auto m = Node["matrix"].get<std::vector<float>>();
+                if (m.size() == 16)
+                {
+                    Local = float4x4{m[0], m[1], m[2], m[3], m[4], m[5], m[6], m[7],
+                                     m[8], m[9], m[10], m[11], m[12], m[13], m[14], m[15]};
+                }
+            }
+            if (Node.contains("scale"))
+            {
+                const auto s = Node["scale"].get<std::vector<float>>();
+                Local        = Local * float4x4::Scale(s.at(0), s.at(1), s.at(2));
+            }
+            if (Node.contains("rotation"))
+            {
+                const auto  q = Node["rotation"].get<std::vector<float>>();
+                const float x = q.at(0), y = q.at(1), z = q.at(2), w = q.at(3);
+                // Rotacion del cuaternion en convencion de vectores fila
+                const float4x4 R{
+                    1 - 2 * (y * y + z * z), 2 * (x * y + z * w), 2 * (x * z - y * w), 0,
+                    2 * (x * y - z * w), 1 - 2 * (x * x + z * z), 2 * (y * z + x * w), 0,
+                    2 * (x * z + y * w), 2 * (y * z - x * w), 1 - 2 * (x * x + y * y), 0,
+                    0, 0, 0, 1};
+                Local = Local * R;
+            }
+            if (Node.contains("translation"))
+            {
+                const auto t = Node["translation"].get<std::vector<float>>();
+                Local        = Local * float4x4::Translation(t.at(0), t.at(1), t.at(2));
+            }
+            return Local;
+        }
+    };
+
+    // "textures/my%20file.png" -> "textures/my file.png"
+    static std::string DecodeUri(const std::string& Uri)
+    {
+        std::string Out;
+        for (size_t i = 0; i < Uri.size(); ++i)
+        {
+            if (Uri[i] == '%' && i + 2 < Uri.size())
+            {
+                Out += static_cast<char>(std::stoi(Uri.substr(i + 1, 2), nullptr, 16));
+                i += 2;
+            }
+            else
+                Out += Uri[i];
+        }
+        return Out;
+    }
+
+    static bool DecodeBase64(const std::string& In, std::vector<Uint8>& Out)
+    {
+        auto Value = [](char c) -> int {
+            if (c >= 'A' && c <= 'Z') return c - 'A';
+            if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+            if (c >= '0' && c <= '9') return c - '0' + 52;
+            if (c == '+') return 62;
+            if (c == '/') return 63;
+            return -1;
+        };
+
+        Out.clear();
+        Uint32 Acc  = 0;
+        int    Bits = 0;
+        for (char c : In)
+        {
+            if (c == '=')
+                break;
+            const int v = Value(c);
+            if (v < 0)
+                return false;
+            Acc = (Acc << 6) | static_cast<Uint32>(v);
+            Bits += 6;
+            if (Bits >= 8)
+            {
+                Bits -= 8;
+                Out.push_back(static_cast<Uint8>((Acc >> Bits) & 0xFF));
+            }
+        }
+        return true;
+    }
+};
+
+} // namespace Diligent
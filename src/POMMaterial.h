@@ -7,6 +7,7 @@
 #include "MapHelper.hpp"
 #include "BasicMath.hpp" // float2
 #include <cstring>       // std::memcpy
+#include <vector>
 
 
 namespace Diligent
@@ -21,7 +22,10 @@ struct POMConstants
 };
 
 // -----------------------------------------------------------------------------
-// Material POM: solo datos, NO crea su propio SRB
+// Material POM: texturas + cbPOM, con un SRB propio por PSO donde se dibuja.
+//   Los SRB se crean una vez (CreateSRB) con texturas y cbPOM ya enlazados;
+//   cambiar de material es un solo CommitShaderResources. cbPOM es
+//   USAGE_DEFAULT y solo se sube cuando un setter cambia los datos.
 // -----------------------------------------------------------------------------
 class POMMaterial
 {
@@ -60,28 +64,54 @@ public:
         cbDesc.Name           = "POM constants";
         cbDesc.Size           = sizeof(POMConstants);
         cbDesc.BindFlags      = BIND_UNIFORM_BUFFER;
-        cbDesc.Usage          = USAGE_DYNAMIC;
-        cbDesc.CPUAccessFlags = CPU_ACCESS_WRITE;
-        pDevice->CreateBuffer(cbDesc, nullptr, &m_CB);
+        cbDesc.Usage          = USAGE_DEFAULT;
 
         m_Data.HeightScale = HeightScale;
         m_Data.NumSteps    = NumSteps;
+
+        // Los datos iniciales van en la creacion: no hace falta un Upload
+        BufferData cbData;
+        cbData.pData    = &m_Data;
+        cbData.DataSize = sizeof(m_Data);
+        pDevice->CreateBuffer(cbDesc, &cbData, &m_CB);
     }
 
-    // Cargar datos CPU -> GPU
-    void Upload(IDeviceContext* ctx)
+    // Cargar datos CPU -> GPU, solo si algun setter los cambio.
+    // Devuelve true si hubo subida.
+    bool Upload(IDeviceContext* ctx)
     {
-        MapHelper<POMConstants> cb(ctx, m_CB, MAP_WRITE, MAP_FLAG_DISCARD);
-        *cb = m_Data;
+        if (!m_Dirty)
+            return false;
+
+        ctx->UpdateBuffer(m_CB, 0, sizeof(m_Data), &m_Data, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        m_Dirty = false;
+        return true;
     }
 
-    // Cambiar HeightScale
-    void SetHeightScale(IDeviceContext* ctx, float hs)
+    // Cambiar HeightScale (se sube en el proximo Upload)
+    void SetHeightScale(float hs)
     {
+        if (hs == m_Data.HeightScale)
+            return;
         m_Data.HeightScale = hs;
-        Upload(ctx);
+        MarkDirty();
+    }
+
+    void SetNumSteps(uint32_t steps)
+    {
+        if (steps == m_Data.NumSteps)
+            return;
+        m_Data.NumSteps = steps;
+        MarkDirty();
     }
 
+    float    GetHeightScale() const { return m_Data.HeightScale; }
+    uint32_t GetNumSteps() const { return m_Data.NumSteps; }
+
+    // Cambia cada vez que las constantes del material cambian; los renderers
+    // pueden compararla para saber si algo cacheado quedo obsoleto
+    uint32_t GetVersion() const { return m_Version; }
+
     // Rellenar variables en el SRB existente
     void Bind(IShaderResourceBinding* srb) const
     {   
@@ -92,10 +122,42 @@ public:
     }
 
     public:
-    void CreateSRB(IPipelineState* pPSO)
+    // Crea (una sola vez por PSO) el SRB del material con texturas y cbPOM.
+    // El llamador enlaza lo que depende de la escena (shadow map, anillo).
+    IShaderResourceBinding* CreateSRB(IPipelineState* pPSO)
+    {
+        if (auto* pSRB = GetSRB(pPSO))
+            return pSRB;
+
+        PSOBinding binding;
+        binding.pPSO = pPSO;
+        pPSO->CreateShaderResourceBinding(&binding.SRB, true);
+        Bind(binding.SRB); //   hace los Set() una sola vez
+        binding.pConstantsVar = binding.SRB->GetVariableByName(SHADER_TYPE_VERTEX, "Constants");
+        m_SRBs.push_back(binding);
+        return m_SRBs.back().SRB;
+    }
+
+    // SRB del material para pPSO (nullptr si no se creo con CreateSRB)
+    IShaderResourceBinding* GetSRB(IPipelineState* pPSO) const
     {
-        pPSO->CreateShaderResourceBinding(&m_SRB, true);
-        Bind(m_SRB); //   hace los Set() una sola vez
+        for (const auto& binding : m_SRBs)
+        {
+            if (binding.pPSO == pPSO)
+                return binding.SRB;
+        }
+        return nullptr;
+    }
+
+    // Variable "Constants" (world por draw) del SRB de pPSO, si el shader la usa
+    IShaderResourceVariable* GetConstantsVar(IPipelineState* pPSO) const
+    {
+        for (const auto& binding : m_SRBs)
+        {
+            if (binding.pPSO == pPSO)
+                return binding.pConstantsVar;
+        }
+        return nullptr;
     }
 
     void gettAlbedoSRV(ITextureView** srv) const
@@ -117,16 +179,29 @@ public:
 
 
 
-    IShaderResourceBinding* GetSRB() const { return m_SRB; }
-
 private:
+    void MarkDirty()
+    {
+        m_Dirty = true;
+        ++m_Version;
+    }
+
+    struct PSOBinding
+    {
+        IPipelineState*                       pPSO = nullptr;
+        RefCntAutoPtr<IShaderResourceBinding> SRB;
+        IShaderResourceVariable*              pConstantsVar = nullptr;
+    };
+
     RefCntAutoPtr<ITextureView> m_AlbedoSRV;
     RefCntAutoPtr<ITextureView> m_HeightSRV;
     RefCntAutoPtr<ITextureView> m_NormalSRV;
     RefCntAutoPtr<IBuffer>      m_CB;
-    RefCntAutoPtr<IShaderResourceBinding> m_SRB;
+    std::vector<PSOBinding>     m_SRBs;
 
-    POMConstants m_Data = {};
+    POMConstants m_Data    = {};
+    bool         m_Dirty   = false;
+    uint32_t     m_Version = 0;
 };
 
 } // namespace Diligent
@@ -0,0 +1,200 @@
+#pragma once
+#include "POMMaterial.h"
+#include "RefCntAutoPtr.hpp"
+#include "RenderDevice.h"
+#include "DeviceContext.h"
+#include <string>
+#include <vector>
+
+namespace Diligent
+{
+
+// -----------------------------------------------------------------------------
+// Catalogo de POMMaterial empaquetado en tres Texture2DArray (albedo, altura,
+// normal) + un StructuredBuffer<POMConstants> con una entrada por slice.
+//   Con esto los tiles de cualquier material se dibujan con un solo PSO/SRB:
+//   el shader elige el slice por instancia (ver MATERIAL_ARRAY en cube.psh).
+//   Un material solo entra si sus tres texturas coinciden en tamano, formato
+//   y mips con las del primero; los que no, se quedan fuera y se avisa.
+// -----------------------------------------------------------------------------
+class POMMaterialArray
+{
+public:
+    // Copia las texturas de cada material a su slice. Devuelve false si
+    // quedan menos de dos materiales (no compensa el modo array).
+    bool Build(IRenderDevice* pDevice, IDeviceContext* pCtx, const std::vector<POMMaterial*>& Materials)
+    {
+        m_Materials.clear();
+        m_Versions.clear();
+        m_Constants.clear();
+        for (auto& Array : m_Arrays)
+            Array.Release();
+        m_POMBuffer.Release();
+
+        ITexture* pRef[NumChannels] = {};
+        for (POMMaterial* pMat : Materials)
+        {
+            ITexture* pTex[NumChannels] = {};
+            GetTextures(pMat, pTex);
+
+            if (m_Materials.empty())
+            {
+                for (Uint32 c = 0; c < NumChannels; ++c)
+                    pRef[c] = pTex[c];
+            }
+            else if (!Compatible(pRef, pTex))
+            {
+                OutputDebugStringA("POMMaterialArray: material excluido (tamano/formato/mips distintos)\n");
+                continue;
+            }
+            m_Materials.push_back(pMat);
+        }
+
+        if (m_Materials.size() < 2)
+        {
+            m_Materials.clear();
+            return false;
+        }
+
+        static const char* ArrayNames[NumChannels] = {"POM albedo array", "POM height array", "POM normal array"};
+
+        const Uint32 NumSlices = static_cast<Uint32>(m_Materials.size());
+        for (Uint32 c = 0; c < NumChannels; ++c)
+        {
+            const auto& RefDesc = pRef[c]->GetDesc();
+
+            TextureDesc Desc;
+            Desc.Name      = ArrayNames[c];
+            Desc.Type      = RESOURCE_DIM_TEX_2D_ARRAY;
+            Desc.Width     = RefDesc.Width;
+            Desc.Height    = RefDesc.Height;
+            Desc.ArraySize = NumSlices;
+            Desc.MipLevels = RefDesc.MipLevels;
+            Desc.Format    = RefDesc.Format;
+            Desc.Usage     = USAGE_DEFAULT;
+            Desc.BindFlags = BIND_SHADER_RESOURCE;
+            pDevice->CreateTexture(Desc, nullptr, &m_Arrays[c]);
+
+            for (Uint32 Slice = 0; Slice < NumSlices; ++Slice)
+            {
+                ITexture* pTex[NumChannels] = {};
+                GetTextures(m_Materials[Slice], pTex);
+
+                for (Uint32 Mip = 0; Mip < Desc.MipLevels; ++Mip)
+                {
+                    CopyTextureAttribs CopyAttribs(pTex[c], RESOURCE_STATE_TRANSITION_MODE_TRANSITION,
+                                                   m_Arrays[c], RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+                    CopyAttribs.SrcMipLevel = Mip;
+                    CopyAttribs.DstMipLevel = Mip;
+                    CopyAttribs.DstSlice    = Slice;
+                    pCtx->CopyTexture(CopyAttribs);
+                }
+            }
+        }
+
+        // Constantes por slice ------------------------------------------------
+        m_Constants.resize(NumSlices);
+        m_Versions.assign(NumSlices, 0);
+        for (Uint32 Slice = 0; Slice < NumSlices; ++Slice)
+            ReadConstants(Slice);
+
+        BufferDesc BuffDesc;
+        BuffDesc.Name              = "POM constants array";
+        BuffDesc.Size              = sizeof(POMConstants) * NumSlices;
+        BuffDesc.Usage             = USAGE_DEFAULT;
+        BuffDesc.BindFlags         = BIND_SHADER_RESOURCE;
+        BuffDesc.Mode              = BUFFER_MODE_STRUCTURED;
+        BuffDesc.ElementByteStride = sizeof(POMConstants);
+
+        BufferData BuffData;
+        BuffData.pData    = m_Constants.data();
+        BuffData.DataSize = BuffDesc.Size;
+        pDevice->CreateBuffer(BuffDesc, &BuffData, &m_POMBuffer);
+
+        std::string Msg = "POMMaterialArray: " + std::to_string(NumSlices) + " de " +
+            std::to_string(Materials.size()) + " materiales empaquetados\n";
+        OutputDebugStringA(Msg.c_str());
+        return true;
+    }
+
+    // Sube las constantes si algun material cambio de version desde la ultima
+    // vez (un UpdateBuffer para todo el array). Devuelve true si hubo subida.
+    bool Upload(IDeviceContext* pCtx)
+    {
+        bool Dirty = false;
+        for (Uint32 Slice = 0; Slice < static_cast<Uint32>(m_Materials.size()); ++Slice)
+        {
+            if (m_Versions[Slice] != m_Materials[Slice]->GetVersion())
+            {
+                ReadConstants(Slice);
+                Dirty = true;
+            }
+        }
+        if (!Dirty)
+            return false;
+
+        pCtx->UpdateBuffer(m_POMBuffer, 0, sizeof(POMConstants) * static_cast<Uint64>(m_Constants.size()),
+                           m_Constants.data(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        return true;
+    }
+
+    // Slice del material, -1 si no esta en el array
+    int GetSlice(const POMMaterial* pMat) const
+    {
+        for (size_t i = 0; i < m_Materials.size(); ++i)
+        {
+            if (m_Materials[i] == pMat)
+                return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    bool   IsValid() const { return !m_Materials.empty(); }
+    Uint32 GetNumSlices() const { return static_cast<Uint32>(m_Materials.size()); }
+
+    ITextureView* GetAlbedoSRV() const { return m_Arrays[0]->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE); }
+    ITextureView* GetHeightSRV() const { return m_Arrays[1]->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE); }
+    ITextureView* GetNormalSRV() const { return m_Arrays[2]->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE); }
+    IBufferView*  GetConstantsSRV() const { return m_POMBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE); }
+
+private:
+    static constexpr Uint32 NumChannels = 3; // albedo, altura, normal
+
+    static void GetTextures(const POMMaterial* pMat, ITexture* pTex[NumChannels])
+    {
+        ITextureView* pSRV[NumChannels] = {};
+        pMat->gettAlbedoSRV(&pSRV[0]);
+        pMat->gettHeightSRV(&pSRV[1]);
+        pMat->gettNormalSRV(&pSRV[2]);
+        for (Uint32 c = 0; c < NumChannels; ++c)
+            pTex[c] = pSRV[c]->GetTexture();
+    }
+
+    static bool Compatible(ITexture* const pRef[NumChannels], ITexture* const pTex[NumChannels])
+    {
+        for (Uint32 c = 0; c < NumChannels; ++c)
+        {
+            const auto& A = pRef[c]->GetDesc();
+            const auto& B = pTex[c]->GetDesc();
+            if (A.Width != B.Width || A.Height != B.Height || A.Format != B.Format || A.MipLevels != B.MipLevels)
+                return false;
+        }
+        return true;
+    }
+
+    void ReadConstants(Uint32 Slice)
+    {
+        const POMMaterial* pMat = m_Materials[Slice];
+        m_Constants[Slice].HeightScale = pMat->GetHeightScale();
+        m_Constants[Slice].NumSteps    = pMat->GetNumSteps();
+        m_Versions[Slice]              = pMat->GetVersion();
+    }
+
+    std::vector<POMMaterial*>  m_Materials; // indice = slice
+    std::vector<uint32_t>      m_Versions;  // version de cada material ya subida
+    std::vector<POMConstants>  m_Constants;
+    RefCntAutoPtr<ITexture>    m_Arrays[NumChannels];
+    RefCntAutoPtr<IBuffer>     m_POMBuffer;
+};
+
+} // namespace Diligent
@@ -0,0 +1,235 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#    include <emmintrin.h>
+#    define PACKED_TILE_GRID_SSE 1
+#else
+#    define PACKED_TILE_GRID_SSE 0
+#endif
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#    include <intrin.h>
+#endif
+
+// Un bit por celda para un valor concreto: bit (x % 64) de Words[y * WordsPerRow + x / 64].
+// Los bits de relleno al final de cada fila siempre son 0, asi que una palabra
+// a 0 son 64 celdas que el consumidor se puede saltar de golpe.
+struct TileBitplane
+{
+    int                   Width       = 0;
+    int                   Height      = 0;
+    size_t                WordsPerRow = 0;
+    std::vector<uint64_t> Words;
+
+    const uint64_t* Row(int y) const noexcept { return Words.data() + static_cast<size_t>(y) * WordsPerRow; }
+    bool            Test(int x, int y) const noexcept { return (Row(y)[x / 64] >> (x % 64)) & 1; }
+};
+
+// Indice del bit mas bajo a 1 (Bits != 0)
+inline int LowestSetBit(uint64_t Bits) noexcept
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long Index;
+    _BitScanForward64(&Index, Bits);
+    return static_cast<int>(Index);
+#elif defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(Bits);
+#else
+    int Index = 0;
+    while ((Bits & 1) == 0)
+    {
+        Bits >>= 1;
+        ++Index;
+    }
+    return Index;
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Rejilla de 2 bits por celda (valores 0..3), 32 celdas por palabra de 64 bits.
+//   Cada fila empieza en una palabra nueva, asi que rellenar un tramo de fila
+//   es una escritura con mascara en cada extremo y palabras completas en medio
+//   (de 2 en 2 con SSE2). Una columna es una escritura con mascara por fila.
+//   16k x 16k celdas ocupan 64 MB en lugar de 256 MB con un byte por celda.
+// -----------------------------------------------------------------------------
+class PackedTileGrid
+{
+public:
+    static constexpr int CellsPerWord = 32;
+
+    void Assign(int Width, int Height, uint8_t Value)
+    {
+        m_Width       = Width;
+        m_Height      = Height;
+        m_WordsPerRow = (static_cast<size_t>(Width) + CellsPerWord - 1) / CellsPerWord;
+        m_Words.assign(m_WordsPerRow * Height, 0);
+        for (int y = 0; y < Height; ++y)
+            FillRow(y, 0, Width, Value); // el relleno de fila queda a 0
+    }
+
+    int    GetWidth() const noexcept { return m_Width; }
+    int    GetHeight() const noexcept { return m_Height; }
+    size_t GetSizeInBytes() const noexcept { return m_Words.size() * sizeof(uint64_t); }
+
+    uint8_t Get(int x, int y) const noexcept
+    {
+        return static_cast<uint8_t>((Row(y)[x / CellsPerWord] >> (2 * (x % CellsPerWord))) & 3);
+    }
+
+    // Celdas [x0, x0 + Count) de la fila y
+    void FillRow(int y, int x0, int Count, uint8_t Value) noexcept
+    {
+        if (Count <= 0)
+            return;
+
+        uint64_t*      pRow    = Row(y);
+        const uint64_t Pattern = MakePattern(Value);
+        const int      x1      = x0 + Count; // exclusivo
+        const int      w0      = x0 / CellsPerWord;
+        const int      w1      = (x1 - 1) / CellsPerWord;
+
+        if (w0 == w1)
+        {
+            WriteMasked(pRow[w0], CellMask(x0 % CellsPerWord, x1 - w0 * CellsPerWord), Pattern);
+            return;
+        }
+
+        WriteMasked(pRow[w0], CellMask(x0 % CellsPerWord, CellsPerWord), Pattern);
+        FillWords(pRow + w0 + 1, static_cast<size_t>(w1 - w0 - 1), Pattern);
+        WriteMasked(pRow[w1], CellMask(0, x1 - w1 * CellsPerWord), Pattern);
+    }
+
+    // Celdas [y0, y0 + Count) de la columna x
+    void FillColumn(int x, int y0, int Count, uint8_t Value) noexcept
+    {
+        const uint64_t Mask    = CellMask(x % CellsPerWord, x % CellsPerWord + 1);
+        const uint64_t Pattern = MakePattern(Value);
+        uint64_t*      pWord   = Row(y0) + x / CellsPerWord;
+        for (int i = 0; i < Count; ++i, pWord += m_WordsPerRow)
+            WriteMasked(*pWord, Mask, Pattern);
+    }
+
+    void FillRect(int x, int y, int Width, int Height, uint8_t Value) noexcept
+    {
+        for (int row = y; row < y + Height; ++row)
+            FillRow(row, x, Width, Value);
+    }
+
+    // Desempaqueta la fila y en Width bytes
+    void ExpandRow(int y, uint8_t* pDst) const noexcept
+    {
+        const uint64_t* pRow = Row(y);
+        for (int x = 0; x < m_Width; x += CellsPerWord)
+        {
+            uint64_t  Word = pRow[x / CellsPerWord];
+            const int End  = (std::min)(x + CellsPerWord, m_Width);
+            for (int i = x; i < End; ++i, Word >>= 2)
+                pDst[i] = static_cast<uint8_t>(Word & 3);
+        }
+    }
+
+    size_t Count(uint8_t Value) const noexcept
+    {
+        size_t Total = 0;
+        for (int y = 0; y < m_Height; ++y)
+        {
+            const uint64_t* pRow = Row(y);
+            for (size_t w = 0; w < m_WordsPerRow; ++w)
+                Total += PopCount(MatchWord(pRow[w], Value) & ValidMask(w));
+        }
+        return Total;
+    }
+
+    // Bitplane de las celdas con Value: cada palabra del plano sale de 2 palabras empaquetadas
+    void ExtractBitplane(uint8_t Value, TileBitplane& Plane) const
+    {
+        Plane.Width       = m_Width;
+        Plane.Height      = m_Height;
+        Plane.WordsPerRow = (static_cast<size_t>(m_Width) + 63) / 64;
+        Plane.Words.assign(Plane.WordsPerRow * m_Height, 0);
+
+        for (int y = 0; y < m_Height; ++y)
+        {
+            const uint64_t* pSrc = Row(y);
+            uint64_t*       pDst = Plane.Words.data() + static_cast<size_t>(y) * Plane.WordsPerRow;
+            for (size_t w = 0; w < m_WordsPerRow; ++w)
+            {
+                const uint64_t Bits = CompactEvenBits(MatchWord(pSrc[w], Value) & ValidMask(w));
+                pDst[w / 2] |= Bits << (32 * (w % 2));
+            }
+        }
+    }
+
+private:
+    const uint64_t* Row(int y) const noexcept { return m_Words.data() + static_cast<size_t>(y) * m_WordsPerRow; }
+    uint64_t*       Row(int y) noexcept { return m_Words.data() + static_cast<size_t>(y) * m_WordsPerRow; }
+
+    // Value repetido en las 32 celdas
+    static uint64_t MakePattern(uint8_t Value) noexcept { return 0x5555555555555555ull * (Value & 3); }
+
+    // Bits de las celdas [c0, c1) de una palabra, 0 <= c0 < c1 <= 32
+    static uint64_t CellMask(int c0, int c1) noexcept
+    {
+        const uint64_t Hi = c1 >= CellsPerWord ? ~0ull : (1ull << (2 * c1)) - 1;
+        const uint64_t Lo = (1ull << (2 * c0)) - 1;
+        return Hi & ~Lo;
+    }
+
+    static void WriteMasked(uint64_t& Word, uint64_t Mask, uint64_t Pattern) noexcept { Word = (Word & ~Mask) | (Pattern & Mask); }
+
+    static void FillWords(uint64_t* pDst, size_t NumWords, uint64_t Pattern) noexcept
+    {
+        size_t i = 0;
+#if PACKED_TILE_GRID_SSE
+        const __m128i Pattern4 = _mm_set_epi32(static_cast<int>(Pattern >> 32), static_cast<int>(Pattern), static_cast<int>(Pattern >> 32),
+                                               static_cast<int>(Pattern));
+        for (; i + 2 <= NumWords; i += 2)
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i), Pattern4);
+#endif
+        for (; i < NumWords; ++i)
+            pDst[i] = Pattern;
+    }
+
+    // Bit par de cada celda a 1 si la celda vale Value
+    static uint64_t MatchWord(uint64_t Word, uint8_t Value) noexcept
+    {
+        const uint64_t Diff = Word ^ MakePattern(Value);
+        return ~(Diff | (Diff >> 1)) & 0x5555555555555555ull;
+    }
+
+    // Celdas reales de la palabra w de una fila (la ultima puede tener relleno)
+    uint64_t ValidMask(size_t w) const noexcept
+    {
+        const int Cells = m_Width - static_cast<int>(w) * CellsPerWord;
+        return Cells >= CellsPerWord ? ~0ull : CellMask(0, Cells);
+    }
+
+    // Junta los bits pares en los 32 bits bajos
+    static uint64_t CompactEvenBits(uint64_t x) noexcept
+    {
+        x &= 0x5555555555555555ull;
+        x = (x | (x >> 1)) & 0x3333333333333333ull;
+        x = (x | (x >> 2)) & 0x0F0F0F0F0F0F0F0Full;
+        x = (x | (x >> 4)) & 0x00FF00FF00FF00FFull;
+        x = (x | (x >> 8)) & 0x0000FFFF0000FFFFull;
+        x = (x | (x >> 16)) & 0x00000000FFFFFFFFull;
+        return x;
+    }
+
+    static size_t PopCount(uint64_t x) noexcept
+    {
+        x = x - ((x >> 1) & 0x5555555555555555ull);
+        x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+        x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+        return static_cast<size_t>((x * 0x0101010101010101ull) >> 56);
+    }
+
+    int                   m_Width       = 0;
+    int                   m_Height      = 0;
+    size_t                m_WordsPerRow = 0;
+    std::vector<uint64_t> m_Words;
+};
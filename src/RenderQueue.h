@@ -0,0 +1,284 @@
+#pragma once
+#include "DeviceContext.h"
+#include "PipelineState.h"
+#include "ShaderResourceBinding.h"
+#include "Buffer.h"
+#include "DebugUtilities.hpp"
+#include "DynamicUploadRing.h"
+#include <vector>
+#include <array>
+#include <cstring> // std::memcpy
+
+namespace Diligent
+{
+
+// Un draw grabado. Todo lo que el Submit necesita sin volver a tocar el modelo.
+struct DrawPacket
+{
+    Uint64                  Key  = 0;
+    IPipelineState*         pPSO = nullptr;
+    IShaderResourceBinding* pSRB = nullptr; // por material: cambiar de SRB = cambiar de material
+    IBuffer*                pVB  = nullptr;
+    IBuffer*                pIB  = nullptr;
+
+    // Constantes por draw: variable DYNAMIC + bloque guardado con
+    // RenderQueue::AddConstants. Se suben al anillo en Submit, no al grabar.
+    IShaderResourceVariable* pDynamicVars[2]   = {};
+    Uint32                   ConstantBlocks[2] = {};
+
+    // Draw instanciado: buffer por instancia en el slot 1 (nullptr = sin instancias)
+    IBuffer* pInstanceVB   = nullptr;
+    Uint32   FirstInstance = 0;
+    Uint32   NumInstances  = 1;
+
+    Uint32 NumIndices = 0;
+    Uint32 FirstIndex = 0;
+    Uint32 BaseVertex = 0;
+};
+
+// -----------------------------------------------------------------------------
+// Cola de draws ordenada por clave de 64 bits:
+//   [63..60] pase | [59..52] PSO | [51..36] material | [35..20] malla | [19..0] profundidad
+// Sort() es un radix sort LSD por bytes (se salta los bytes iguales en todas
+// las claves) y Submit() solo emite el estado que cambia respecto al draw
+// anterior. Las estadisticas se acumulan por pase durante el frame.
+// Las constantes por draw se copian en CPU al grabar y se suben al anillo
+// dentro de Submit(), justo antes de su draw: si el anillo da la vuelta
+// (DISCARD, vuelta al offset 0) ningun paquete pendiente guarda un offset
+// del buffer descartado.
+// -----------------------------------------------------------------------------
+class RenderQueue
+{
+public:
+    static constexpr Uint32 MaxPasses   = 16;
+    static constexpr Uint32 DepthBits   = 20;
+    static constexpr Uint32 DepthLevels = 1u << DepthBits;
+
+    struct PassStats
+    {
+        Uint32 Draws      = 0;
+        Uint32 Instances  = 0; // suma de NumInstances de los draws
+        Uint32 PSOChanges = 0;
+        Uint32 VBChanges  = 0;
+        Uint32 IBChanges  = 0;
+        Uint32 SRBCommits = 0;
+    };
+
+    static Uint64 MakeKey(Uint32 Pass, Uint32 PSO, Uint32 Material, Uint32 Mesh, Uint32 Depth)
+    {
+        return (static_cast<Uint64>(Pass & 0xF) << 60) |
+            (static_cast<Uint64>(PSO & 0xFF) << 52) |
+            (static_cast<Uint64>(Material & 0xFFFF) << 36) |
+            (static_cast<Uint64>(Mesh & 0xFFFF) << 20) |
+            static_cast<Uint64>(Depth & (DepthLevels - 1));
+    }
+
+    // Distancia [0, MaxDist] a entero de 20 bits (orden de cerca a lejos)
+    static Uint32 QuantizeDepth(float Dist, float MaxDist)
+    {
+        if (Dist <= 0.f)
+            return 0;
+        if (Dist >= MaxDist)
+            return DepthLevels - 1;
+        return static_cast<Uint32>(Dist / MaxDist * static_cast<float>(DepthLevels - 1));
+    }
+
+    // Llamar una vez al inicio de cada frame
+    void BeginFrame()
+    {
+        m_LastStats = m_Stats;
+        m_Stats     = {};
+    }
+
+    void Reset()
+    {
+        m_Packets.clear();
+        m_ConstantData.clear();
+        m_ConstantBlocks.clear();
+    }
+
+    // Copia un bloque de constantes para un DrawPacket::ConstantBlocks. Varios
+    // paquetes pueden compartir bloque: se sube una vez mientras el anillo no
+    // de la vuelta.
+    Uint32 AddConstants(const void* pData, Uint32 Size)
+    {
+        const size_t Offset = m_ConstantData.size();
+        m_ConstantData.resize(Offset + Size);
+        std::memcpy(m_ConstantData.data() + Offset, pData, Size);
+        m_ConstantBlocks.push_back({Offset, Size});
+        return static_cast<Uint32>(m_ConstantBlocks.size() - 1);
+    }
+
+    template <typename T>
+    Uint32 AddConstants(const T& Data)
+    {
+        return AddConstants(&Data, static_cast<Uint32>(sizeof(T)));
+    }
+
+    void Push(const DrawPacket& Packet) { m_Packets.push_back(Packet); }
+
+    size_t Size() const { return m_Packets.size(); }
+
+    void Sort()
+    {
+        const Uint32 Count = static_cast<Uint32>(m_Packets.size());
+        m_Order.resize(Count);
+        m_Scratch.resize(Count);
+        for (Uint32 i = 0; i < Count; ++i)
+            m_Order[i] = i;
+        if (Count < 2)
+            return;
+
+        for (Uint32 Shift = 0; Shift < 64; Shift += 8)
+        {
+            std::array<Uint32, 256> Histogram{};
+            for (Uint32 i = 0; i < Count; ++i)
+                ++Histogram[(m_Packets[i].Key >> Shift) & 0xFF];
+
+            // Todas las claves comparten este byte: la pasada no cambia nada
+            if (Histogram[(m_Packets[0].Key >> Shift) & 0xFF] == Count)
+                continue;
+
+            Uint32 Sum = 0;
+            for (auto& Bucket : Histogram)
+            {
+                const Uint32 c = Bucket;
+                Bucket         = Sum;
+                Sum += c;
+            }
+            for (Uint32 i = 0; i < Count; ++i)
+            {
+                const Uint32 Idx = m_Order[i];
+                m_Scratch[Histogram[(m_Packets[Idx].Key >> Shift) & 0xFF]++] = Idx;
+            }
+            m_Order.swap(m_Scratch);
+        }
+    }
+
+    // Emite los draws en el orden de Sort(). El estado se considera
+    // desconocido al empezar, asi que el primer draw siempre lo fija todo.
+    // Las constantes de cada draw se suben a Ring justo antes de emitirlo.
+    void Submit(IDeviceContext* pCtx, DynamicUploadRing& Ring)
+    {
+        m_RingOffsets.assign(m_ConstantBlocks.size(), InvalidRingOffset);
+
+        IPipelineState*         pCurPSO    = nullptr;
+        IShaderResourceBinding* pCurSRB    = nullptr;
+        IBuffer*                pCurVB     = nullptr;
+        IBuffer*                pCurInstVB = nullptr;
+        IBuffer*                pCurIB     = nullptr;
+
+        for (const Uint32 Idx : m_Order)
+        {
+            const DrawPacket& Packet = m_Packets[Idx];
+            PassStats&        Stats  = m_Stats[Packet.Key >> 60];
+
+            bool NeedCommit = false;
+            if (Packet.pPSO != pCurPSO)
+            {
+                pCtx->SetPipelineState(Packet.pPSO);
+                pCurPSO    = Packet.pPSO;
+                NeedCommit = true;
+                ++Stats.PSOChanges;
+            }
+            if (Packet.pVB != pCurVB || Packet.pInstanceVB != pCurInstVB)
+            {
+                IBuffer*     pVBs[]    = {Packet.pVB, Packet.pInstanceVB};
+                Uint64       Offsets[] = {0, 0};
+                const Uint32 NumVBs    = Packet.pInstanceVB != nullptr ? 2 : 1;
+                pCtx->SetVertexBuffers(0, NumVBs, pVBs, Offsets, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, SET_VERTEX_BUFFERS_FLAG_RESET);
+                pCurVB     = Packet.pVB;
+                pCurInstVB = Packet.pInstanceVB;
+                ++Stats.VBChanges;
+            }
+            if (Packet.pIB != pCurIB)
+            {
+                pCtx->SetIndexBuffer(Packet.pIB, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+                pCurIB = Packet.pIB;
+                ++Stats.IBChanges;
+            }
+            // Si una subida da la vuelta, todo lo subido antes en este Submit
+            // (incluido el otro bloque de este draw) apunta al buffer
+            // descartado: se olvida y se vuelve a subir. Tras la vuelta el
+            // anillo esta vacio, asi que el segundo intento no puede darla.
+            Uint32 RingOffsets[2] = {};
+            auto   Upload         = [&]() {
+                for (Uint32 v = 0; v < 2; ++v)
+                {
+                    if (Packet.pDynamicVars[v] != nullptr)
+                        RingOffsets[v] = UploadBlock(pCtx, Ring, Packet.ConstantBlocks[v]);
+                }
+            };
+            const Uint32 WrapsBefore = Ring.GetStats().Wraps;
+            Upload();
+            if (Ring.GetStats().Wraps != WrapsBefore)
+            {
+                m_RingOffsets.assign(m_RingOffsets.size(), InvalidRingOffset);
+                const Uint32 WrapsRetry = Ring.GetStats().Wraps;
+                Upload();
+                VERIFY(Ring.GetStats().Wraps == WrapsRetry, "El anillo dio la vuelta con offsets de este draw aun sin usar");
+            }
+
+            // Los offsets dinamicos se leen en cada draw; no obligan a re-commit
+            for (Uint32 v = 0; v < 2; ++v)
+            {
+                if (Packet.pDynamicVars[v] != nullptr)
+                    Packet.pDynamicVars[v]->SetBufferOffset(RingOffsets[v]);
+            }
+
+            if (NeedCommit || Packet.pSRB != pCurSRB)
+            {
+                pCtx->CommitShaderResources(Packet.pSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+                pCurSRB = Packet.pSRB;
+                ++Stats.SRBCommits;
+            }
+
+            DrawIndexedAttribs DrawAttrs;
+            DrawAttrs.IndexType             = VT_UINT32;
+            DrawAttrs.NumIndices            = Packet.NumIndices;
+            DrawAttrs.FirstIndexLocation    = Packet.FirstIndex;
+            DrawAttrs.BaseVertex            = Packet.BaseVertex;
+            DrawAttrs.NumInstances          = Packet.NumInstances;
+            DrawAttrs.FirstInstanceLocation = Packet.FirstInstance;
+            DrawAttrs.Flags                 = DRAW_FLAG_VERIFY_ALL;
+            pCtx->DrawIndexed(DrawAttrs);
+            ++Stats.Draws;
+            Stats.Instances += Packet.NumInstances;
+        }
+    }
+
+    const PassStats& GetLastFrameStats(Uint32 Pass) const { return m_LastStats[Pass]; }
+
+private:
+    static constexpr Uint32 InvalidRingOffset = ~0u;
+
+    Uint32 UploadBlock(IDeviceContext* pCtx, DynamicUploadRing& Ring, Uint32 Block)
+    {
+        Uint32& RingOffset = m_RingOffsets[Block];
+        if (RingOffset == InvalidRingOffset)
+        {
+            const auto& Src = m_ConstantBlocks[Block];
+            RingOffset      = Ring.Upload(pCtx, m_ConstantData.data() + Src.Offset, Src.Size);
+        }
+        return RingOffset;
+    }
+
+    struct ConstantBlock
+    {
+        size_t Offset;
+        Uint32 Size;
+    };
+
+    std::vector<DrawPacket> m_Packets;
+    std::vector<Uint32>     m_Order;
+    std::vector<Uint32>     m_Scratch;
+
+    std::vector<Uint8>         m_ConstantData;   // copias de CPU de los bloques
+    std::vector<ConstantBlock> m_ConstantBlocks; // indice = DrawPacket::ConstantBlocks
+    std::vector<Uint32>        m_RingOffsets;    // offset en el anillo de cada bloque ya subido en este Submit
+
+    std::array<PassStats, MaxPasses> m_Stats{};
+    std::array<PassStats, MaxPasses> m_LastStats{};
+};
+
+} // namespace Diligent
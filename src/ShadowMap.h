@@ -6,6 +6,7 @@
 #include "RefCntAutoPtr.hpp"
 #include "Texture.h"
 #include "BasicMath.hpp"
+#include "VertexQuantization.h"
 #include "ShaderSourceFactoryUtils.hpp"
 #include "Utilities/interface/DiligentFXShaderSourceStreamFactory.hpp"
 
@@ -25,8 +26,9 @@ class ShadowMap
 public:
     ShadowMap() = default;
 
-    // Inicializa el shadow map con las dimensiones especificadas.
-    void Initialize(IRenderDevice* pDevice, Uint32 Width, Uint32 Height)
+    // Inicializa el shadow map con las dimensiones especificadas. VertexFormat
+    // es el del GeometryPool: los PSO leen sus vertices.
+    void Initialize(IRenderDevice* pDevice, Uint32 Width, Uint32 Height, MESH_VERTEX_FORMAT VertexFormat = MESH_VERTEX_FORMAT_FLOAT)
     {
         TextureDesc Desc;
         Desc.Name   = "Shadow Map";
@@ -48,11 +50,11 @@ public:
         m_pShadowSRV = m_pShadowMap->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE);
 
         // Crear el PSO para el shadow pass.
-        InitializePSO(pDevice);
+        InitializePSO(pDevice, VertexFormat);
     }
 
     // Crea el PSO especfico para el shadow pass.
-    void InitializePSO(IRenderDevice* pDevice)
+    void InitializePSO(IRenderDevice* pDevice, MESH_VERTEX_FORMAT VertexFormat)
     {
         GraphicsPipelineStateCreateInfo PSOCreateInfo;
         PSOCreateInfo.PSODesc.Name         = "ShadowMap PSO";
@@ -90,6 +92,7 @@ public:
 
 
             };
+        VertexQuantizer::WriteVertexLayout(VertexFormat, LayoutElems);
 
         PSOCreateInfo.GraphicsPipeline.InputLayout.LayoutElements = LayoutElems;
         PSOCreateInfo.GraphicsPipeline.InputLayout.NumElements    = _countof(LayoutElems);
@@ -108,6 +111,9 @@ public:
 
         ShaderCI.pShaderSourceStreamFactory = pCompound;
 
+        ShaderMacro VertexMacros[] = {{"COMPACT_VERTEX", VertexFormat == MESH_VERTEX_FORMAT_COMPACT ? "1" : "0"}};
+        ShaderCI.Macros            = {VertexMacros, _countof(VertexMacros)};
+
         // Vertex Shader para shadow mapping (transforma posiciones a la vista de la luz)
         ShaderCI.Desc.ShaderType = SHADER_TYPE_VERTEX;
         ShaderCI.Desc.Name       = "ShadowMap VS";
@@ -127,27 +133,61 @@ public:
       
 
 
+        // ShadowConstants cambia en cada draw: se lee de un rango del anillo de
+        // constantes y solo se mueve su offset (ver BindConstantsRing)
         ShaderResourceVariableDesc Vars[] =
             {
-                {SHADER_TYPE_VERTEX, "ShadowConstants", SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE}};
+                {SHADER_TYPE_VERTEX, "ShadowConstants", SHADER_RESOURCE_VARIABLE_TYPE_DYNAMIC}};
         PSOCreateInfo.PSODesc.ResourceLayout.Variables    = Vars;
         PSOCreateInfo.PSODesc.ResourceLayout.NumVariables = _countof(Vars);
         // Crea el PSO para el shadow pass.
         pDevice->CreateGraphicsPipelineState(PSOCreateInfo, &m_pShadowPSO);
 
-        {
-            BufferDesc CBDesc;
-            CBDesc.Name           = "Shadow constants CB";
-            CBDesc.Size           = sizeof(ShadowConstantsData);
-            CBDesc.Usage          = USAGE_DYNAMIC;
-            CBDesc.BindFlags      = BIND_UNIFORM_BUFFER;
-            CBDesc.CPUAccessFlags = CPU_ACCESS_WRITE;
-            pDevice->CreateBuffer(CBDesc, nullptr, &m_ShadowCB);
-        }
-
         m_pShadowPSO->CreateShaderResourceBinding(&m_pShadowSRB, true);
 
-        m_pShadowSRB->GetVariableByName(SHADER_TYPE_VERTEX, "ShadowConstants")->Set(m_ShadowCB);
+        m_pConstantsVar = m_pShadowSRB->GetVariableByName(SHADER_TYPE_VERTEX, "ShadowConstants");
+
+        // Variante instanciada para los props de TileScene: la matriz de mundo
+        // llega por instancia (float4x4 en el slot 1) y g_World no se usa
+        ShaderMacro Macros[] = {{"COMPACT_VERTEX", VertexMacros[0].Definition}, {"INSTANCED", "1"}};
+        ShaderCI.Macros      = {Macros, _countof(Macros)};
+        ShaderCI.Desc.Name   = "ShadowMap instanced VS";
+        RefCntAutoPtr<IShader> pInstancedVS;
+        pDevice->CreateShader(ShaderCI, &pInstancedVS);
+
+        constexpr Uint32 InstanceStride = sizeof(float4x4);
+
+        LayoutElement InstancedLayoutElems[] =
+            {
+                LayoutElement{0, 0, 3, VT_FLOAT32, False},
+                LayoutElement{1, 0, 3, VT_FLOAT32, False},
+                LayoutElement{2, 0, 2, VT_FLOAT32, False},
+                LayoutElement{3, 0, 4, VT_FLOAT32, False},
+                // Filas de la matriz de mundo
+                LayoutElement{4, 1, 4, VT_FLOAT32, False, LAYOUT_ELEMENT_AUTO_OFFSET, InstanceStride, INPUT_ELEMENT_FREQUENCY_PER_INSTANCE},
+                LayoutElement{5, 1, 4, VT_FLOAT32, False, LAYOUT_ELEMENT_AUTO_OFFSET, InstanceStride, INPUT_ELEMENT_FREQUENCY_PER_INSTANCE},
+                LayoutElement{6, 1, 4, VT_FLOAT32, False, LAYOUT_ELEMENT_AUTO_OFFSET, InstanceStride, INPUT_ELEMENT_FREQUENCY_PER_INSTANCE},
+                LayoutElement{7, 1, 4, VT_FLOAT32, False, LAYOUT_ELEMENT_AUTO_OFFSET, InstanceStride, INPUT_ELEMENT_FREQUENCY_PER_INSTANCE},
+            };
+        VertexQuantizer::WriteVertexLayout(VertexFormat, InstancedLayoutElems);
+
+        PSOCreateInfo.PSODesc.Name                                = "ShadowMap instanced PSO";
+        PSOCreateInfo.pVS                                         = pInstancedVS;
+        PSOCreateInfo.GraphicsPipeline.InputLayout.LayoutElements = InstancedLayoutElems;
+        PSOCreateInfo.GraphicsPipeline.InputLayout.NumElements    = _countof(InstancedLayoutElems);
+        pDevice->CreateGraphicsPipelineState(PSOCreateInfo, &m_pShadowPSOInstanced);
+
+        m_pShadowPSOInstanced->CreateShaderResourceBinding(&m_pShadowSRBInstanced, true);
+
+        m_pConstantsVarInstanced = m_pShadowSRBInstanced->GetVariableByName(SHADER_TYPE_VERTEX, "ShadowConstants");
+    }
+
+    // Enlaza ShadowConstants al anillo de constantes por draw. RangeSize es
+    // sizeof(ShadowConstantsData) alineado; el offset se fija con GetConstantsVar().
+    void BindConstantsRing(IBuffer* pRing, Uint64 RangeSize)
+    {
+        m_pConstantsVar->SetBufferRange(pRing, 0, RangeSize);
+        m_pConstantsVarInstanced->SetBufferRange(pRing, 0, RangeSize);
     }
 
 
@@ -156,7 +196,12 @@ public:
     ITextureView*                 GetSRV() const { return m_pShadowSRV; }
     RefCntAutoPtr<IPipelineState> GetShadowPSO() const { return m_pShadowPSO; }
     IShaderResourceBinding*       GetSRB() const { return m_pShadowSRB; }
-    IBuffer*                      GetCB() const { return m_ShadowCB; }
+    IShaderResourceVariable*      GetConstantsVar() const { return m_pConstantsVar; }
+
+    // Variante instanciada (world por instancia, ShadowConstants.g_World se ignora)
+    IPipelineState*               GetInstancedPSO() const { return m_pShadowPSOInstanced; }
+    IShaderResourceBinding*       GetInstancedSRB() const { return m_pShadowSRBInstanced; }
+    IShaderResourceVariable*      GetInstancedConstantsVar() const { return m_pConstantsVarInstanced; }
 
 private:
     RefCntAutoPtr<ITexture>               m_pShadowMap;
@@ -164,7 +209,10 @@ private:
     RefCntAutoPtr<ITextureView>           m_pShadowSRV;
     RefCntAutoPtr<IPipelineState>         m_pShadowPSO;
     RefCntAutoPtr<IShaderResourceBinding> m_pShadowSRB;
-    RefCntAutoPtr<IBuffer>                m_ShadowCB;
+    IShaderResourceVariable*              m_pConstantsVar = nullptr;
+    RefCntAutoPtr<IPipelineState>         m_pShadowPSOInstanced;
+    RefCntAutoPtr<IShaderResourceBinding> m_pShadowSRBInstanced;
+    IShaderResourceVariable*              m_pConstantsVarInstanced = nullptr;
 };
 
 } // namespace Diligent
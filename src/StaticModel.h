@@ -0,0 +1,258 @@
+#pragma once
+#include "ModelCache.h"
+#include "GeometryPool.h"
+#include "RefCntAutoPtr.hpp"
+#include "RenderDevice.h"
+#include "Buffer.h"
+#include "Texture.h"
+#include <algorithm>
+#include <cfloat>
+#include <string>
+#include <vector>
+
+namespace Diligent
+{
+
+// -----------------------------------------------------------------------------
+// Modelo estatico listo para dibujar, creado desde una vista cocinada
+// (ModelCooker / cache .dgcm). La geometria va a un rango del GeometryPool
+// (o, sin pool, a un VB intercalado y un IB de 32 bits propios), texturas ya
+// con mips y los nodos con malla con su matriz global: sustituye a GLTF::Model
+// en el camino de los props (sin animacion ni skin).
+// -----------------------------------------------------------------------------
+class StaticModel
+{
+public:
+    StaticModel() = default;
+    ~StaticModel()
+    {
+        if (m_pGeometryPool != nullptr)
+            m_pGeometryPool->Release(m_Geometry);
+    }
+
+    StaticModel(const StaticModel&) = delete;
+    StaticModel& operator=(const StaticModel&) = delete;
+
+    struct IndexRange
+    {
+        Uint32 FirstIndex; // absoluto en el IB que devuelve GetIndexBuffer()
+        Uint32 IndexCount;
+    };
+
+    struct Primitive
+    {
+        IndexRange Lods[CookedMaxLods]; // [0] = malla completa; todos sobre los mismos vertices
+        Uint32     NumLods;
+        Uint32     MaterialId;
+
+        // Un LOD que la primitiva no tiene se dibuja con el mas simple que si
+        const IndexRange& GetLod(Uint32 Lod) const { return Lods[(std::min)(Lod, NumLods - 1)]; }
+    };
+
+    struct Mesh
+    {
+        std::vector<Primitive> Primitives;
+    };
+
+    // Nodo con geometria y su matriz global en la escena por defecto (incluye
+    // la descuantizacion de las posiciones si el pool es compacto)
+    struct MeshNode
+    {
+        const Mesh* pMesh = nullptr;
+        float4x4    GlobalMatrix;
+    };
+
+    struct Material
+    {
+        ITexture* pTextures[COOKED_TEXTURE_SLOT_COUNT] = {}; // nullptr = usar la textura por defecto
+    };
+
+    // Crea los recursos de GPU tomando los datos iniciales directamente de
+    // View (en cache caliente, del fichero proyectado). View puede liberarse
+    // al volver. Con pGeometryPool la geometria se sube en su Flush().
+    bool Create(IRenderDevice* pDevice, const std::string& Name, const CookedModelView& View, GeometryPool* pGeometryPool = nullptr)
+    {
+        if (View.NumVertices == 0 || View.NumIndices == 0)
+            return false;
+
+        m_Name = Name;
+
+        if (pGeometryPool != nullptr)
+        {
+            m_pGeometryPool = pGeometryPool;
+            m_Geometry      = pGeometryPool->Allocate("", View.pVertices, View.NumVertices, View.pIndices, View.NumIndices);
+        }
+        else if (!CreateBuffers(pDevice, View))
+        {
+            return false;
+        }
+
+        m_Textures.clear();
+        for (Uint32 t = 0; t < View.NumTextures; ++t)
+            m_Textures.push_back(CreateTexture(pDevice, View, View.pTextures[t]));
+
+        m_Materials.resize(View.NumMaterials);
+        for (Uint32 m = 0; m < View.NumMaterials; ++m)
+        {
+            for (Uint32 Slot = 0; Slot < COOKED_TEXTURE_SLOT_COUNT; ++Slot)
+            {
+                const Int32 TexId               = View.pMaterials[m].TextureIds[Slot];
+                m_Materials[m].pTextures[Slot] = TexId >= 0 ? m_Textures[TexId].RawPtr() : nullptr;
+            }
+        }
+
+        m_Meshes.resize(View.NumMeshes);
+        for (Uint32 m = 0; m < View.NumMeshes; ++m)
+        {
+            const auto& Cooked = View.pMeshes[m];
+            for (Uint32 p = 0; p < Cooked.NumPrimitives; ++p)
+            {
+                const auto& Prim = View.pPrimitives[Cooked.FirstPrimitive + p];
+                if (Prim.IndexCount == 0)
+                    continue;
+
+                Primitive Dst  = {};
+                Dst.NumLods    = Prim.NumLods;
+                Dst.MaterialId = Prim.MaterialId;
+                Dst.Lods[0]    = {m_Geometry.FirstIndex + Prim.FirstIndex, Prim.IndexCount};
+                for (Uint32 l = 1; l < Prim.NumLods; ++l)
+                    Dst.Lods[l] = {m_Geometry.FirstIndex + Prim.Lods[l - 1].FirstIndex, Prim.Lods[l - 1].IndexCount};
+                m_Meshes[m].Primitives.push_back(Dst);
+                m_NumLods = (std::max)(m_NumLods, Prim.NumLods);
+            }
+        }
+
+        // Con el pool en formato compacto las posiciones llegan en la caja del
+        // rango: su descuantizacion va delante de la matriz de cada nodo
+        const float4x4 Dequant = m_Geometry.GetDequantTransform();
+        m_MeshNodes.clear();
+        for (Uint32 n = 0; n < View.NumNodes; ++n)
+        {
+            const auto& Node = View.pNodes[n];
+            if (Node.MeshId >= 0 && !m_Meshes[Node.MeshId].Primitives.empty())
+                m_MeshNodes.push_back({&m_Meshes[Node.MeshId], Dequant * Node.GlobalMatrix});
+        }
+        ComputeBoundingSphere(View);
+
+        m_NumVertices = View.NumVertices;
+        m_NumIndices  = View.NumIndices;
+        m_TexelBytes  = View.TexelsSize;
+        m_CookStats   = View.pStats != nullptr ? *View.pStats : CookedModelStats{};
+        return true;
+    }
+
+    IBuffer* GetVertexBuffer() const { return m_pGeometryPool != nullptr ? m_pGeometryPool->GetVertexBuffer() : m_pVertexBuffer.RawPtr(); }
+    IBuffer* GetIndexBuffer() const { return m_pGeometryPool != nullptr ? m_pGeometryPool->GetIndexBuffer() : m_pIndexBuffer.RawPtr(); }
+    Uint32   GetBaseVertex() const { return m_Geometry.BaseVertex; } // el cooker ya rebasa los indices al modelo
+
+    const std::string&           GetName() const { return m_Name; }
+    Uint32                       GetNumMaterials() const { return static_cast<Uint32>(m_Materials.size()); }
+    const Material&              GetMaterial(Uint32 MaterialId) const { return m_Materials[MaterialId]; }
+    const std::vector<MeshNode>& GetMeshNodes() const { return m_MeshNodes; }
+
+    Uint32 GetNumVertices() const { return m_NumVertices; }
+    Uint32 GetNumIndices() const { return m_NumIndices; }
+    Uint64 GetTexelBytes() const { return m_TexelBytes; }
+
+    const CookedModelStats& GetCookStats() const { return m_CookStats; }
+
+    // Esfera que envuelve todos los nodos con malla (centro xyz + radio w),
+    // en el espacio del modelo
+    const float4& GetBoundingSphere() const { return m_BoundingSphere; }
+    Uint32        GetNumLods() const { return m_NumLods; } // el maximo de sus primitivas
+
+private:
+    // AABB de cada malla llevado a espacio del modelo con la matriz del nodo
+    void ComputeBoundingSphere(const CookedModelView& View)
+    {
+        float3 Min{FLT_MAX, FLT_MAX, FLT_MAX};
+        float3 Max{-FLT_MAX, -FLT_MAX, -FLT_MAX};
+        for (Uint32 n = 0; n < View.NumNodes; ++n)
+        {
+            const auto& Node = View.pNodes[n];
+            if (Node.MeshId < 0 || m_Meshes[Node.MeshId].Primitives.empty())
+                continue;
+            const auto& Mesh = View.pMeshes[Node.MeshId];
+            for (Uint32 c = 0; c < 8; ++c)
+            {
+                const float3 Corner{(c & 1) ? Mesh.BoundsMax.x : Mesh.BoundsMin.x, (c & 2) ? Mesh.BoundsMax.y : Mesh.BoundsMin.y,
+                                    (c & 4) ? Mesh.BoundsMax.z : Mesh.BoundsMin.z};
+                const float4 p = float4{Corner.x, Corner.y, Corner.z, 1.f} * Node.GlobalMatrix;
+                Min            = float3{(std::min)(Min.x, p.x), (std::min)(Min.y, p.y), (std::min)(Min.z, p.z)};
+                Max            = float3{(std::max)(Max.x, p.x), (std::max)(Max.y, p.y), (std::max)(Max.z, p.z)};
+            }
+        }
+        m_BoundingSphere = Min.x <= Max.x ? float4{(Min + Max) * 0.5f, length(Max - Min) * 0.5f} : float4{};
+    }
+
+    // Sin pool: VB e IB inmutables propios
+    bool CreateBuffers(IRenderDevice* pDevice, const CookedModelView& View)
+    {
+        BufferDesc VBDesc;
+        VBDesc.Name      = m_Name.c_str();
+        VBDesc.Usage     = USAGE_IMMUTABLE;
+        VBDesc.BindFlags = BIND_VERTEX_BUFFER;
+        VBDesc.Size      = Uint64{View.NumVertices} * sizeof(CookedVertex);
+        BufferData VBData{View.pVertices, VBDesc.Size};
+        pDevice->CreateBuffer(VBDesc, &VBData, &m_pVertexBuffer);
+
+        BufferDesc IBDesc;
+        IBDesc.Name      = m_Name.c_str();
+        IBDesc.Usage     = USAGE_IMMUTABLE;
+        IBDesc.BindFlags = BIND_INDEX_BUFFER;
+        IBDesc.Size      = Uint64{View.NumIndices} * sizeof(Uint32);
+        BufferData IBData{View.pIndices, IBDesc.Size};
+        pDevice->CreateBuffer(IBDesc, &IBData, &m_pIndexBuffer);
+
+        return m_pVertexBuffer && m_pIndexBuffer;
+    }
+
+    // Texture2DArray de un slice, como las del loader GLTF (gltf.psh lo espera)
+    RefCntAutoPtr<ITexture> CreateTexture(IRenderDevice* pDevice, const CookedModelView& View, const CookedTexture& Tex) const
+    {
+        TextureDesc Desc;
+        Desc.Name      = m_Name.c_str();
+        Desc.Type      = RESOURCE_DIM_TEX_2D_ARRAY;
+        Desc.Width     = Tex.Width;
+        Desc.Height    = Tex.Height;
+        Desc.ArraySize = 1;
+        Desc.MipLevels = Tex.MipLevels;
+        Desc.Format    = Tex.Format == COOKED_TEXTURE_FORMAT_BC1 ? TEX_FORMAT_BC1_UNORM : TEX_FORMAT_RGBA8_UNORM;
+        Desc.Usage     = USAGE_IMMUTABLE;
+        Desc.BindFlags = BIND_SHADER_RESOURCE;
+
+        std::vector<TextureSubResData> SubResources(Tex.MipLevels);
+        for (Uint32 m = 0; m < Tex.MipLevels; ++m)
+        {
+            const auto& Mip        = View.pMips[Tex.FirstMip + m];
+            SubResources[m].pData  = View.GetMipData(Mip);
+            SubResources[m].Stride = Mip.RowPitch;
+        }
+
+        TextureData InitData;
+        InitData.pSubResources   = SubResources.data();
+        InitData.NumSubresources = Tex.MipLevels;
+
+        RefCntAutoPtr<ITexture> pTex;
+        pDevice->CreateTexture(Desc, &InitData, &pTex);
+        return pTex;
+    }
+
+    std::string                          m_Name;
+    RefCntAutoPtr<IBuffer>               m_pVertexBuffer;
+    RefCntAutoPtr<IBuffer>               m_pIndexBuffer;
+    GeometryPool*                        m_pGeometryPool = nullptr;
+    GeometryRange                        m_Geometry; // todo a 0 con buffers propios
+    std::vector<RefCntAutoPtr<ITexture>> m_Textures;
+    std::vector<Material>                m_Materials;
+    std::vector<Mesh>                    m_Meshes;
+    std::vector<MeshNode>                m_MeshNodes; // apunta a m_Meshes: no redimensionar despues de Create
+    Uint32                               m_NumVertices = 0;
+    Uint32                               m_NumIndices  = 0;
+    Uint64                               m_TexelBytes  = 0;
+    CookedModelStats                     m_CookStats   = {};
+    float4                               m_BoundingSphere;
+    Uint32                               m_NumLods = 1;
+};
+
+} // namespace Diligent
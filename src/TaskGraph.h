@@ -0,0 +1,277 @@
+#pragma once
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Diligent
+{
+
+// -----------------------------------------------------------------------------
+// Grafo de tareas de un solo uso (el arranque de la app).
+//   Cada nodo declara al crearse los nodos de los que depende, que tienen que
+//   ser anteriores: el orden de Add ya es un orden topologico. Run() manda al
+//   ThreadPool los nodos listos y ejecuta en el hilo que llama los creados con
+//   AddMain (device context, o estado que no es thread-safe como el
+//   GeometryPool). Un nodo que lanza una excepcion cancela sus dependientes;
+//   Run() la relanza al terminar. GetReport() da la duracion de cada nodo y
+//   el camino critico (la cadena de dependencias mas larga).
+// -----------------------------------------------------------------------------
+class TaskGraph
+{
+public:
+    using NodeId = size_t;
+
+    struct NodeReport
+    {
+        std::string Name;
+        bool        MainThread = false;
+        bool        Ran        = false; // false = cancelado por un nodo anterior
+        bool        Critical   = false;
+        double      StartMs    = 0.0; // desde el inicio de Run()
+        double      DurationMs = 0.0;
+    };
+
+    struct Report
+    {
+        std::vector<NodeReport> Nodes; // en orden de Add
+        std::vector<NodeId>     CriticalPath;
+        double                  WallMs         = 0.0; // Run() completo
+        double                  SerialMs       = 0.0; // suma de duraciones: lo que costaria en orden
+        double                  CriticalPathMs = 0.0; // cota inferior con hilos de sobra
+    };
+
+    NodeId Add(std::string Name, std::function<void()> Task, std::vector<NodeId> Deps = {})
+    {
+        return AddNode(std::move(Name), std::move(Task), std::move(Deps), false);
+    }
+
+    // Solo en el hilo que llama a Run()
+    NodeId AddMain(std::string Name, std::function<void()> Task, std::vector<NodeId> Deps = {})
+    {
+        return AddNode(std::move(Name), std::move(Task), std::move(Deps), true);
+    }
+
+    // pPool = nullptr -> todo en el hilo que llama, en orden de Add (p.e. en
+    // GL, donde el device no admite crear recursos desde otros hilos)
+    void Run(ThreadPool* pPool)
+    {
+        m_Start   = Clock::now();
+        m_NumDone = 0;
+        m_Error   = nullptr;
+        for (auto& Node : m_Nodes)
+            Node.NumPending = Node.Deps.size();
+
+        if (pPool == nullptr)
+        {
+            for (NodeId Id = 0; Id < m_Nodes.size(); ++Id)
+                Execute(Id);
+        }
+        else
+        {
+            std::unique_lock<std::mutex> Lock{m_Mutex};
+            for (NodeId Id = 0; Id < m_Nodes.size(); ++Id)
+            {
+                if (m_Nodes[Id].Deps.empty())
+                    Schedule(Id, pPool);
+            }
+
+            while (m_NumDone < m_Nodes.size())
+            {
+                m_CV.wait(Lock, [this] { return !m_MainQueue.empty() || m_NumDone == m_Nodes.size(); });
+                if (m_MainQueue.empty())
+                    continue;
+
+                const NodeId Id = m_MainQueue.front();
+                m_MainQueue.pop_front();
+                Lock.unlock();
+                Execute(Id);
+                Lock.lock();
+                Release(Id, pPool);
+            }
+        }
+
+        BuildReport(std::chrono::duration<double, std::milli>(Clock::now() - m_Start).count());
+
+        if (m_Error)
+            std::rethrow_exception(m_Error);
+    }
+
+    const Report& GetReport() const { return m_Report; }
+
+    // Una linea por nodo ("*" = camino critico) y el resumen
+    std::string FormatReport() const
+    {
+        std::string Text;
+        char        Line[256];
+        for (const auto& Node : m_Report.Nodes)
+        {
+            std::snprintf(Line, sizeof(Line), "%s %-28s %8.2f ms  (inicio %8.2f ms)%s%s\n", Node.Critical ? "*" : " ", Node.Name.c_str(),
+                          Node.DurationMs, Node.StartMs, Node.MainThread ? " [main]" : "", Node.Ran ? "" : " CANCELADO");
+            Text += Line;
+        }
+        std::snprintf(Line, sizeof(Line), "Total %.2f ms, en serie %.2f ms, camino critico %.2f ms:", m_Report.WallMs, m_Report.SerialMs,
+                      m_Report.CriticalPathMs);
+        Text += Line;
+        for (size_t i = 0; i < m_Report.CriticalPath.size(); ++i)
+            Text += (i == 0 ? " " : " -> ") + m_Report.Nodes[m_Report.CriticalPath[i]].Name;
+        Text += "\n";
+        return Text;
+    }
+
+private:
+    using Clock = std::chrono::high_resolution_clock;
+
+    struct Node
+    {
+        std::string           Name;
+        std::function<void()> Task;
+        std::vector<NodeId>   Deps;
+        std::vector<NodeId>   Dependents;
+        bool                  MainThread = false;
+        bool                  Ran        = false;
+        bool                  Failed     = false; // lanzo o se cancelo
+        size_t                NumPending = 0;
+        double                StartMs    = 0.0;
+        double                DurationMs = 0.0;
+    };
+
+    NodeId AddNode(std::string Name, std::function<void()> Task, std::vector<NodeId> Deps, bool MainThread)
+    {
+        const NodeId Id = m_Nodes.size();
+        for (const NodeId Dep : Deps)
+            m_Nodes[Dep].Dependents.push_back(Id);
+
+        Node NewNode;
+        NewNode.Name       = std::move(Name);
+        NewNode.Task       = std::move(Task);
+        NewNode.Deps       = std::move(Deps);
+        NewNode.MainThread = MainThread;
+        m_Nodes.push_back(std::move(NewNode));
+        return Id;
+    }
+
+    // Con m_Mutex tomado
+    void Schedule(NodeId Id, ThreadPool* pPool)
+    {
+        if (m_Nodes[Id].MainThread)
+        {
+            m_MainQueue.push_back(Id);
+            m_CV.notify_all();
+            return;
+        }
+        pPool->Submit([this, Id, pPool] {
+            Execute(Id);
+            std::lock_guard<std::mutex> Lock{m_Mutex};
+            Release(Id, pPool);
+        });
+    }
+
+    // Con m_Mutex tomado: el nodo termino, sus dependientes pueden estar listos
+    void Release(NodeId Id, ThreadPool* pPool)
+    {
+        ++m_NumDone;
+        for (const NodeId Dependent : m_Nodes[Id].Dependents)
+        {
+            if (--m_Nodes[Dependent].NumPending == 0)
+                Schedule(Dependent, pPool);
+        }
+        m_CV.notify_all();
+    }
+
+    void Execute(NodeId Id)
+    {
+        Node& N = m_Nodes[Id];
+        for (const NodeId Dep : N.Deps)
+        {
+            if (m_Nodes[Dep].Failed)
+            {
+                N.Failed = true;
+                return;
+            }
+        }
+
+        const auto tStart = Clock::now();
+        try
+        {
+            N.Task();
+        }
+        catch (...)
+        {
+            N.Failed = true;
+            std::lock_guard<std::mutex> Lock{m_ErrorMutex};
+            if (!m_Error)
+                m_Error = std::current_exception();
+        }
+        const auto tEnd = Clock::now();
+
+        N.Ran        = true;
+        N.StartMs    = std::chrono::duration<double, std::milli>(tStart - m_Start).count();
+        N.DurationMs = std::chrono::duration<double, std::milli>(tEnd - tStart).count();
+    }
+
+    void BuildReport(double WallMs)
+    {
+        m_Report        = {};
+        m_Report.WallMs = WallMs;
+
+        // Camino mas largo por duracion: las dependencias siempre son anteriores
+        std::vector<double> Finish(m_Nodes.size(), 0.0);
+        std::vector<size_t> Prev(m_Nodes.size(), SIZE_MAX);
+        size_t              Last = SIZE_MAX;
+        for (NodeId Id = 0; Id < m_Nodes.size(); ++Id)
+        {
+            const Node& N = m_Nodes[Id];
+            for (const NodeId Dep : N.Deps)
+            {
+                if (Finish[Dep] > Finish[Id])
+                {
+                    Finish[Id] = Finish[Dep];
+                    Prev[Id]   = Dep;
+                }
+            }
+            Finish[Id] += N.DurationMs;
+            m_Report.SerialMs += N.DurationMs;
+            if (Last == SIZE_MAX || Finish[Id] > Finish[Last])
+                Last = Id;
+
+            NodeReport NodeRep;
+            NodeRep.Name       = N.Name;
+            NodeRep.MainThread = N.MainThread;
+            NodeRep.Ran        = N.Ran;
+            NodeRep.StartMs    = N.StartMs;
+            NodeRep.DurationMs = N.DurationMs;
+            m_Report.Nodes.push_back(NodeRep);
+        }
+
+        if (Last == SIZE_MAX)
+            return;
+        m_Report.CriticalPathMs = Finish[Last];
+        for (size_t Id = Last; Id != SIZE_MAX; Id = Prev[Id])
+        {
+            m_Report.Nodes[Id].Critical = true;
+            m_Report.CriticalPath.push_back(Id);
+        }
+        std::reverse(m_Report.CriticalPath.begin(), m_Report.CriticalPath.end());
+    }
+
+    std::vector<Node>       m_Nodes;
+    std::deque<NodeId>      m_MainQueue;
+    size_t                  m_NumDone = 0;
+    std::mutex              m_Mutex;
+    std::condition_variable m_CV;
+    std::mutex              m_ErrorMutex;
+    std::exception_ptr      m_Error;
+    Clock::time_point       m_Start;
+    Report                  m_Report;
+};
+
+} // namespace Diligent
@@ -0,0 +1,93 @@
+#pragma once
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Diligent
+{
+
+// -----------------------------------------------------------------------------
+// Pool de hilos minimo: una cola FIFO compartida y N workers.
+//   Submit() devuelve un std::future con el resultado (o la excepcion) de la
+//   tarea. El destructor termina las tareas ya encoladas antes de unir los
+//   hilos. Nada de esto toca el device context: eso sigue en el render thread.
+// -----------------------------------------------------------------------------
+class ThreadPool
+{
+public:
+    // NumThreads = 0 -> nucleos - 1 (al menos uno), el render thread queda libre
+    explicit ThreadPool(unsigned NumThreads = 0)
+    {
+        if (NumThreads == 0)
+            NumThreads = (std::max)(1u, std::thread::hardware_concurrency() - 1u);
+
+        m_Workers.reserve(NumThreads);
+        for (unsigned i = 0; i < NumThreads; ++i)
+            m_Workers.emplace_back([this] { WorkerLoop(); });
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> Lock{m_Mutex};
+            m_Stop = true;
+        }
+        m_CV.notify_all();
+        for (auto& Worker : m_Workers)
+            Worker.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    template <typename F>
+    auto Submit(F&& Task) -> std::future<typename std::invoke_result<F>::type>
+    {
+        using ResultType = typename std::invoke_result<F>::type;
+
+        // packaged_task no es copiable y std::function lo exige: va en un shared_ptr
+        auto pTask  = std::make_shared<std::packaged_task<ResultType()>>(std::forward<F>(Task));
+        auto Future = pTask->get_future();
+        {
+            std::lock_guard<std::mutex> Lock{m_Mutex};
+            m_Queue.emplace_back([pTask] { (*pTask)(); });
+        }
+        m_CV.notify_one();
+        return Future;
+    }
+
+    unsigned GetNumThreads() const { return static_cast<unsigned>(m_Workers.size()); }
+
+private:
+    void WorkerLoop()
+    {
+        for (;;)
+        {
+            std::function<void()> Task;
+            {
+                std::unique_lock<std::mutex> Lock{m_Mutex};
+                m_CV.wait(Lock, [this] { return m_Stop || !m_Queue.empty(); });
+                if (m_Queue.empty())
+                    return; // m_Stop y nada pendiente
+                Task = std::move(m_Queue.front());
+                m_Queue.pop_front();
+            }
+            Task();
+        }
+    }
+
+    std::vector<std::thread>          m_Workers;
+    std::deque<std::function<void()>> m_Queue;
+    std::mutex                        m_Mutex;
+    std::condition_variable           m_CV;
+    bool                              m_Stop = false;
+};
+
+} // namespace Diligent
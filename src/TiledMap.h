@@ -3,6 +3,7 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <set>
 #include "json.hpp"
 #include <fstream>    
 
@@ -53,6 +54,20 @@ public:
 
 
     const std::vector<ObjectInfo>& Objects() const noexcept { return m_Objects; }
+
+    /* Names (propiedad del tileset) que usan los objetos del mapa, sin
+       repetir y ordenados: son los unicos modelos que hay que cargar */
+    std::vector<std::string> ReferencedObjectNames() const
+    {
+        std::set<std::string> names;
+        for (const auto& oi : m_Objects)
+        {
+            const auto* info = GetTileInfo(oi.gid);
+            if (info != nullptr && !info->Name.empty())
+                names.insert(info->Name);
+        }
+        return {names.begin(), names.end()};
+    }
     bool Load(const std::string& mapFile)
     {
         
@@ -1,8 +1,12 @@
 #pragma once
 #include "TiledMap.h"
 #include "Cubo.h"         // cubo Diligent que ya tienes
-#include "GLTFLoader.hpp" // para modelos
+#include "StaticModel.h"   // para modelos
+#include "ChunkCulling.h"
 #include <unordered_map>
+#include <algorithm>
+#include <functional>
+#include <cfloat>
 
 
 namespace Diligent
@@ -13,12 +17,52 @@ struct TileDraw
 {
     float4x4 World;
     uint32_t MaterialId; // 0=suelo  1=muro  
+    uint32_t ChunkId;    // chunk de ChunkCells x ChunkCells celdas
+};
+
+/* dato por instancia que lee cube.vsh cuando TILE_INSTANCED = 1 */
+struct TileInstanceData
+{
+    float4x4 World;
+    uint32_t MaterialId; // solo lo lee la variante MATERIAL_ARRAY
+    uint32_t _Pad[3];
+};
+
+/* rango contiguo del instance buffer que comparte material y chunk */
+struct TileBatch
+{
+    uint32_t MaterialId;
+    uint32_t ChunkId;
+    uint32_t FirstInstance;
+    uint32_t NumInstances;
 };
 
 struct ObjectDraw
 {
     float4x4     World;
-    GLTF::Model* pModel; // modelo que debes renderizar
+    StaticModel* pModel; // modelo que debes renderizar
+    uint32_t     ChunkId;
+    float4       Bounds; // esfera del modelo en mundo (conservadora si no la trae): centro (xyz) + radio (w)
+
+    // Rango en TileScene::NodeWorlds(): World ya premultiplicado por la
+    // matriz global de cada nodo con malla (ver BakeObjectNodeWorlds)
+    uint32_t FirstNodeWorld = 0;
+    uint32_t NumNodeWorlds  = 0;
+
+    uint32_t BatchId = 0; // ObjectBatch de su modelo
+};
+
+/* placements de un mismo modelo: objetos [FirstObject, FirstObject + NumObjects)
+   de TileScene::Objects(). En el instance buffer de props van por nodo:
+   nodo n del objeto o -> FirstInstance + n * NumObjects + (o - FirstObject),
+   asi cualquier rango contiguo de objetos es un rango contiguo de instancias */
+struct ObjectBatch
+{
+    StaticModel* pModel;
+    uint32_t     FirstObject;
+    uint32_t     NumObjects;
+    uint32_t     FirstInstance;
+    uint32_t     NumNodes; // nodos con malla del modelo
 };
 
 struct TileVertex
@@ -42,6 +86,9 @@ struct TileVertex
 class TileScene
 {
 public:
+    // Lado de un chunk en celdas del mapa
+    static constexpr int ChunkCells = 16;
+
     /// @param tileSize     ancho/largo de cada celda en mundo
     /// @param wallHeight   altura del muro
     TileScene(float tileSize   = 2.f,
@@ -53,16 +100,17 @@ public:
     {}
 
     /* Construye la escena.
-       - modelLookup    relaciona Name-of-tile    GLTF::Model*
+       - modelLookup    relaciona Name-of-tile    StaticModel*
        - floorMatId / wallMatId  coinciden con tus materiales (0/1)       */
     void Build(const TiledMap&                         map,
                           const std::unordered_map<std::string,
-                                                   GLTF::Model*>& modelLookup,
+                                                   StaticModel*>& modelLookup,
                           uint32_t                                floorMatId,
                           uint32_t                                wallMatId)
     {
         m_Tiles.clear();
         m_Objects.clear();
+        m_NumPlaceholders = 0;
 
         const int   W    = map.Width();
         const int   H    = map.Height();
@@ -70,6 +118,8 @@ public:
         const float xOff = -W * TS * 0.5f + TS * 0.5f;
         const float zOff = -H * TS * 0.5f + TS * 0.5f;
 
+        BeginChunks(W, H);
+
         //------------------  capa pisos / paredes  -------------------------
         for (int y = 0; y < H; ++y)
             for (int x = 0; x < W; ++x)
@@ -88,28 +138,28 @@ public:
                 float    wz = y * TS + zOff;
                 float4x4 S, T;
 
+                // El cubo base va de -1 a 1: la escala es la semiextension
+                const uint32_t chunk = ChunkOfCell(x, y);
                 if (isFloor)
                 {
-                    S = float4x4::Scale(
-                        float3{TS * 0.5f, m_FloorThickness * 0.5f, TS * 0.5f});
-                    T = float4x4::Translation(
-                        float3{wx, -m_WallHeight * 0.5f + m_FloorThickness * 0.5f, wz});
-                    m_Tiles.push_back({S * T, floorMatId});
+                    const float3 half{TS * 0.5f, m_FloorThickness * 0.5f, TS * 0.5f};
+                    const float3 center{wx, -m_WallHeight * 0.5f + m_FloorThickness * 0.5f, wz};
+                    S = float4x4::Scale(half);
+                    T = float4x4::Translation(center);
+                    m_Tiles.push_back({S * T, floorMatId, chunk});
+                    GrowChunk(chunk, center - half, center + half);
                 }
                 else // wall
                 {
-                    S = float4x4::Scale(
-                        float3{TS * 0.5f, m_WallHeight * 0.5f, TS * 0.5f});
-                    T = float4x4::Translation(float3{wx, 0.f, wz});
-                    m_Tiles.push_back({S * T, wallMatId});
+                    const float3 half{TS * 0.5f, m_WallHeight * 0.5f, TS * 0.5f};
+                    const float3 center{wx, 0.f, wz};
+                    S = float4x4::Scale(half);
+                    T = float4x4::Translation(center);
+                    m_Tiles.push_back({S * T, wallMatId, chunk});
+                    GrowChunk(chunk, center - half, center + half);
                 }
             }
 
-        for (auto& parNombreObjeto: modelLookup){
-            OutputDebugStringA(("Modelo: " + parNombreObjeto.first + "\n").c_str());
-        
-        }
-
      //   //------------------  capa objetos  ---------------------------------
      //   for (int y = 0; y < H; ++y)
      //       for (int x = 0; x < W; ++x)
@@ -171,10 +221,68 @@ public:
             float4x4 R   = float4x4::RotationY(rad);
             float4x4 T   = float4x4::Translation(float3{wx, wy, wz});
 
-            m_Objects.push_back({S * R * T, it->second});
+            // Sin bounds del modelo a mano: esfera conservadora de un tile
+            // por unidad de escala alrededor del punto de colocacion
+            const uint32_t chunk  = ChunkOfCell(static_cast<int>(std::floor((wx - xOff) / TS + 0.5f)),
+                                                static_cast<int>(std::floor((wz - zOff) / TS + 0.5f)));
+            const float    radius = std::abs(oi.scale) * TS;
+
+            if (it->second == nullptr)
+            {
+                // Modelo aun cargando: cubo pequeno con el material de muro.
+                // Va en la capa de tiles, asi que se dibuja instanciado con ella
+                const float3 half{TS * 0.25f, TS * 0.25f, TS * 0.25f};
+                const float3 center{wx, wy, wz};
+                m_Tiles.push_back({float4x4::Scale(half) * float4x4::Translation(center), wallMatId, chunk});
+                GrowChunk(chunk, center - half, center + half);
+                ++m_NumPlaceholders;
+                continue;
+            }
+
+            // Con la esfera del modelo (cooker) la de la instancia es exacta:
+            // la usan el culling y la seleccion de LOD por tamano en pantalla
+            const float4x4 world  = S * R * T;
+            float4         bounds = float4{wx, wy, wz, radius};
+            const float4&  sphere = it->second->GetBoundingSphere();
+            if (sphere.w > 0.f)
+            {
+                const float4 c = float4{sphere.x, sphere.y, sphere.z, 1.f} * world;
+                bounds         = float4{c.x, c.y, c.z, sphere.w * std::abs(oi.scale)};
+            }
+
+            m_Objects.push_back({world, it->second, chunk, bounds, 0, 0});
+            GrowChunk(chunk, float3{bounds.x - bounds.w, bounds.y - bounds.w, bounds.z - bounds.w},
+                      float3{bounds.x + bounds.w, bounds.y + bounds.w, bounds.z + bounds.w});
         }
+
+        // Props agrupados por modelo y, dentro, por chunk: las placements de
+        // un modelo quedan contiguas y se dibujan instanciadas (ObjectBatch)
+        std::stable_sort(m_Objects.begin(), m_Objects.end(),
+                         [](const ObjectDraw& a, const ObjectDraw& b) {
+                             return a.pModel != b.pModel ? std::less<StaticModel*>{}(a.pModel, b.pModel) : a.ChunkId < b.ChunkId;
+                         });
+
+        EndChunks();
+    }
+
+    /* Frustum culling por chunk. Llamar una vez por frame con la ViewProj de
+       la camara; despues IsChunkVisible() responde para tiles y objetos.
+       Devuelve el numero de chunks visibles. */
+    Uint32 CullChunks(const float4x4& viewProj, bool isGL, bool useSIMD = true)
+    {
+        const FrustumPlanesSoA planes{viewProj, isGL};
+        return Diligent::CullChunks(m_ChunkBounds, planes, m_ChunkVisible, useSIMD);
     }
 
+    bool   IsChunkVisible(uint32_t chunk) const { return chunk < m_ChunkVisible.size() && m_ChunkVisible[chunk] != 0; }
+    Uint32 NumChunks() const { return m_ChunkBounds.Size(); }
+
+    // Placements cuyo modelo aun no estaba listo en el ultimo Build()
+    uint32_t NumPlaceholders() const { return m_NumPlaceholders; }
+
+    float GetTileSize() const { return m_TileSize; }
+    float GetWallHeight() const { return m_WallHeight; }
+
     enum class Want
     {
         Floor,
@@ -279,17 +387,175 @@ public:
     }
 
 
+    /* Ordena los tiles por (MaterialId, ChunkId) y sube un instance buffer con
+       sus matrices de mundo. Cada TileBatch es un rango contiguo de ese buffer;
+       los batches de chunks visibles y consecutivos se funden en un solo
+       DrawIndexed instanciado. MeshTransform (la descuantizacion del cubo
+       en el pool) va delante de cada matriz. Llamar despues de Build(). */
+    void CreateInstanceBuffer(IRenderDevice* pDevice, const float4x4& MeshTransform = float4x4::Identity())
+    {
+        m_Batches.clear();
+        m_pInstanceBuffer.Release();
+
+        if (m_Tiles.empty())
+            return;
+
+        std::stable_sort(m_Tiles.begin(), m_Tiles.end(),
+                         [](const TileDraw& a, const TileDraw& b) {
+                             return a.MaterialId != b.MaterialId ? a.MaterialId < b.MaterialId : a.ChunkId < b.ChunkId;
+                         });
+
+        std::vector<TileInstanceData> instances;
+        instances.reserve(m_Tiles.size());
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_Tiles.size()); ++i)
+        {
+            const auto& tile = m_Tiles[i];
+            if (m_Batches.empty() || m_Batches.back().MaterialId != tile.MaterialId || m_Batches.back().ChunkId != tile.ChunkId)
+                m_Batches.push_back({tile.MaterialId, tile.ChunkId, i, 0});
+            ++m_Batches.back().NumInstances;
+            instances.push_back({MeshTransform * tile.World, tile.MaterialId, {}});
+        }
+
+        BufferDesc desc;
+        desc.Name      = "TileScene instance buffer";
+        desc.Usage     = USAGE_IMMUTABLE;
+        desc.BindFlags = BIND_VERTEX_BUFFER;
+        desc.Size      = static_cast<Uint64>(instances.size() * sizeof(TileInstanceData));
+
+        BufferData data;
+        data.pData    = instances.data();
+        data.DataSize = desc.Size;
+
+        pDevice->CreateBuffer(desc, &data, &m_pInstanceBuffer);
+    }
+
+    /* Los props son estaticos: guarda por objeto sus matrices de mundo por
+       nodo (NodeGlobalMatrix * World) para que el render no recalcule nada.
+       GetMeshNodes(pModel) devuelve los nodos con malla del modelo en el
+       mismo orden en que se van a dibujar. Llamar despues de Build(). */
+    template <typename MeshNodesFn>
+    void BakeObjectNodeWorlds(MeshNodesFn&& GetMeshNodes)
+    {
+        m_NodeWorlds.clear();
+        m_ObjectBatches.clear();
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_Objects.size()); ++i)
+        {
+            auto&       obj    = m_Objects[i];
+            const auto& nodes  = GetMeshNodes(obj.pModel);
+            obj.FirstNodeWorld = static_cast<uint32_t>(m_NodeWorlds.size());
+            obj.NumNodeWorlds  = static_cast<uint32_t>(nodes.size());
+            for (const auto& node : nodes)
+                m_NodeWorlds.push_back(node.GlobalMatrix * obj.World);
+
+            // Build() deja los objetos ordenados por modelo
+            if (m_ObjectBatches.empty() || m_ObjectBatches.back().pModel != obj.pModel)
+                m_ObjectBatches.push_back({obj.pModel, i, 0, 0, obj.NumNodeWorlds});
+            ++m_ObjectBatches.back().NumObjects;
+            obj.BatchId = static_cast<uint32_t>(m_ObjectBatches.size() - 1);
+        }
+    }
+
+    /* Sube las matrices por nodo de todos los props a un instance buffer
+       (float4x4 por instancia) con el orden de ObjectBatch. Llamar despues
+       de BakeObjectNodeWorlds(). */
+    void CreateObjectInstanceBuffer(IRenderDevice* pDevice)
+    {
+        m_pObjectInstanceBuffer.Release();
+
+        std::vector<float4x4> instances;
+        instances.reserve(m_NodeWorlds.size());
+        for (auto& batch : m_ObjectBatches)
+        {
+            batch.FirstInstance = static_cast<uint32_t>(instances.size());
+            for (uint32_t n = 0; n < batch.NumNodes; ++n)
+                for (uint32_t o = 0; o < batch.NumObjects; ++o)
+                    instances.push_back(NodeWorlds(m_Objects[batch.FirstObject + o])[n]);
+        }
+        if (instances.empty())
+            return;
+
+        BufferDesc desc;
+        desc.Name      = "TileScene prop instance buffer";
+        desc.Usage     = USAGE_IMMUTABLE;
+        desc.BindFlags = BIND_VERTEX_BUFFER;
+        desc.Size      = static_cast<Uint64>(instances.size() * sizeof(float4x4));
+
+        BufferData data;
+        data.pData    = instances.data();
+        data.DataSize = desc.Size;
+
+        pDevice->CreateBuffer(desc, &data, &m_pObjectInstanceBuffer);
+    }
+
     /* acceso a los datos ya listos para tu render loop */
+    const float4x4* NodeWorlds(const ObjectDraw& obj) const { return m_NodeWorlds.data() + obj.FirstNodeWorld; }
     const std::vector<TileDraw>&   Tiles() const noexcept { return m_Tiles; }
     const std::vector<ObjectDraw>& Objects() const noexcept { return m_Objects; }
+    const std::vector<TileBatch>&  Batches() const noexcept { return m_Batches; }
+    IBuffer*                       GetInstanceBuffer() const { return m_pInstanceBuffer; }
+    const std::vector<ObjectBatch>& ObjectBatches() const noexcept { return m_ObjectBatches; }
+    IBuffer*                        GetObjectInstanceBuffer() const { return m_pObjectInstanceBuffer; }
 
 private:
+    void BeginChunks(int w, int h)
+    {
+        m_ChunksX = (std::max)(1, (w + ChunkCells - 1) / ChunkCells);
+        m_ChunksZ = (std::max)(1, (h + ChunkCells - 1) / ChunkCells);
+        m_ChunkMin.assign(static_cast<size_t>(m_ChunksX * m_ChunksZ), float3{FLT_MAX, FLT_MAX, FLT_MAX});
+        m_ChunkMax.assign(static_cast<size_t>(m_ChunksX * m_ChunksZ), float3{-FLT_MAX, -FLT_MAX, -FLT_MAX});
+    }
+
+    uint32_t ChunkOfCell(int x, int y) const
+    {
+        const int cx = (std::min)((std::max)(x / ChunkCells, 0), m_ChunksX - 1);
+        const int cz = (std::min)((std::max)(y / ChunkCells, 0), m_ChunksZ - 1);
+        return static_cast<uint32_t>(cz * m_ChunksX + cx);
+    }
+
+    void GrowChunk(uint32_t chunk, const float3& mn, const float3& mx)
+    {
+        float3& cMin = m_ChunkMin[chunk];
+        float3& cMax = m_ChunkMax[chunk];
+        cMin         = float3{(std::min)(cMin.x, mn.x), (std::min)(cMin.y, mn.y), (std::min)(cMin.z, mn.z)};
+        cMax         = float3{(std::max)(cMax.x, mx.x), (std::max)(cMax.y, mx.y), (std::max)(cMax.z, mx.z)};
+    }
+
+    // Pasa los AABB a SoA. Un chunk vacio queda como caja degenerada en el
+    // origen: no tiene nada que dibujar, da igual si sale visible.
+    void EndChunks()
+    {
+        m_ChunkBounds.Clear();
+        for (size_t c = 0; c < m_ChunkMin.size(); ++c)
+        {
+            if (m_ChunkMin[c].x > m_ChunkMax[c].x)
+                m_ChunkBounds.Add(float3{}, float3{});
+            else
+                m_ChunkBounds.Add(m_ChunkMin[c], m_ChunkMax[c]);
+        }
+        m_ChunkVisible.assign(m_ChunkMin.size(), 1);
+    }
+
     float m_TileSize;
     float m_WallHeight;
     float m_FloorThickness;
 
+    int                 m_ChunksX = 1;
+    int                 m_ChunksZ = 1;
+    std::vector<float3> m_ChunkMin;
+    std::vector<float3> m_ChunkMax;
+    ChunkBoundsSoA      m_ChunkBounds;
+    std::vector<Uint8>  m_ChunkVisible;
+
     std::vector<TileDraw>   m_Tiles;
     std::vector<ObjectDraw> m_Objects;
+    std::vector<float4x4>   m_NodeWorlds;
+    uint32_t                m_NumPlaceholders = 0;
+
+    std::vector<TileBatch> m_Batches;
+    RefCntAutoPtr<IBuffer> m_pInstanceBuffer;
+
+    std::vector<ObjectBatch> m_ObjectBatches;
+    RefCntAutoPtr<IBuffer>   m_pObjectInstanceBuffer;
 };
 
 } // namespace Diligent
@@ -38,6 +38,8 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 #include <string>
+#include <chrono>
+#include <future>
 
 
 //
@@ -81,6 +83,46 @@ static bool LoadHeightMap(const std::string&                filePath,
     return true;
 }
 
+// Las variables estaticas que un shader no usa no existen en el PSO (p.e.
+// parallaxConstants en gltf.psh), por eso se comprueba el puntero
+static void SetStaticVariable(Diligent::IPipelineState* pPSO,
+                              Diligent::SHADER_TYPE     ShaderType,
+                              const char*               Name,
+                              Diligent::IDeviceObject*  pObject)
+{
+    if (auto* pVar = pPSO->GetStaticVariableByName(ShaderType, Name))
+        pVar->Set(pObject);
+}
+
+// Layout de vertices que esperan los PSO GLTF y texturas que se leen. Los
+// props salen del cooker (CookedVertex, mismo layout); el loader GLTF solo se
+// usa para compararlo en RunModelCacheBenchmark
+static constexpr Diligent::GLTF::VertexAttributeDesc ModelVertexAttrs[] =
+    {
+        // Nombre        , BufferId, Tipo, Componentes
+        {Diligent::GLTF::PositionAttributeName, 0, Diligent::VT_FLOAT32, 3},
+        {Diligent::GLTF::NormalAttributeName, 0, Diligent::VT_FLOAT32, 3},
+        {Diligent::GLTF::Texcoord0AttributeName, 0, Diligent::VT_FLOAT32, 2},
+        {Diligent::GLTF::TangentAttributeName, 0, Diligent::VT_FLOAT32, 4} // ojo: tangente es float4 (xyz + w)
+};
+
+static constexpr Diligent::GLTF::TextureAttributeDesc ModelTexAttrs[] =
+    {
+        {Diligent::GLTF::BaseColorTextureName, Diligent::GLTF::DefaultBaseColorTextureAttribId},
+        {Diligent::GLTF::NormalTextureName, Diligent::GLTF::DefaultNormalTextureAttribId},
+};
+
+static Diligent::GLTF::ModelCreateInfo MakeModelCreateInfo(const char* FileName)
+{
+    Diligent::GLTF::ModelCreateInfo CI;
+    CI.FileName             = FileName;
+    CI.VertexAttributes     = ModelVertexAttrs;
+    CI.NumVertexAttributes  = _countof(ModelVertexAttrs);
+    CI.TextureAttributes    = ModelTexAttrs;
+    CI.NumTextureAttributes = _countof(ModelTexAttrs);
+    return CI;
+}
+
 
 namespace Diligent
 {
@@ -135,7 +177,12 @@ void Tutorial03_Texturing::CreatePipelineState()
     // converted from linear to gamma space by the GPU. However, some platforms (e.g. Android in GLES mode,
     // or Emscripten in WebGL mode) do not support gamma-correction. In this case the application
     // has to do the conversion manually.
-    ShaderMacro Macros[] = {{"CONVERT_PS_OUTPUT_TO_GAMMA", m_ConvertPSOutputToGamma ? "1" : "0"}};
+    // COMPACT_VERTEX: el VS lee el vertice cuantizado del pool (VertexDecode.fxh)
+    const MESH_VERTEX_FORMAT VertexFormat  = m_GeometryPool.GetVertexFormat();
+    const char*              CompactVertex = VertexFormat == MESH_VERTEX_FORMAT_COMPACT ? "1" : "0";
+
+    ShaderMacro Macros[] = {{"CONVERT_PS_OUTPUT_TO_GAMMA", m_ConvertPSOutputToGamma ? "1" : "0"},
+                            {"COMPACT_VERTEX", CompactVertex}};
     ShaderCI.Macros      = {Macros, _countof(Macros)};
 
     // Create a shader source stream factory to load shaders from files.
@@ -191,6 +238,7 @@ void Tutorial03_Texturing::CreatePipelineState()
         //Attribute 2- normal
     };
     // clang-format on
+    VertexQuantizer::WriteVertexLayout(VertexFormat, LayoutElems);
 
     PSOCreateInfo.pVS = pVS;
     PSOCreateInfo.pPS = pPS;
@@ -210,12 +258,13 @@ void Tutorial03_Texturing::CreatePipelineState()
         {SHADER_TYPE_PIXEL, "g_HeightMap", SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
         {SHADER_TYPE_PIXEL, "g_NormalMap", SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
         {SHADER_TYPE_PIXEL, "g_ShadowMap", SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
-        {SHADER_TYPE_VERTEX, "Constants", SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
-        {SHADER_TYPE_VERTEX, "LightConstants", SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {SHADER_TYPE_VERTEX, "Constants", SHADER_RESOURCE_VARIABLE_TYPE_DYNAMIC},
+        {SHADER_TYPE_VERTEX, "FrameConstants", SHADER_RESOURCE_VARIABLE_TYPE_STATIC},
+        {SHADER_TYPE_VERTEX, "LightConstants", SHADER_RESOURCE_VARIABLE_TYPE_STATIC},
         {SHADER_TYPE_PIXEL, "cbPOM", SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
-        {SHADER_TYPE_PIXEL, "cbLightAttribs", SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
-        {SHADER_TYPE_VERTEX, "cbLightAttribs", SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
-        {SHADER_TYPE_PIXEL, "parallaxConstants", SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {SHADER_TYPE_PIXEL, "cbLightAttribs", SHADER_RESOURCE_VARIABLE_TYPE_STATIC},
+        {SHADER_TYPE_VERTEX, "cbLightAttribs", SHADER_RESOURCE_VARIABLE_TYPE_STATIC},
+        {SHADER_TYPE_PIXEL, "parallaxConstants", SHADER_RESOURCE_VARIABLE_TYPE_STATIC},
 
         //{SHADER_TYPE_PIXEL, (m_ShadowSettings.iShadowMode==SHADOW_MODE_PCF ? "g_tex2DShadowMap" : "g_tex2DFilterableShadowMap"), SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE}
 
@@ -269,16 +318,16 @@ void Tutorial03_Texturing::CreatePipelineState()
 
     // Since we are using mutable variable, we must create a shader resource binding object
     // http://diligentgraphics.com/2016/03/23/resource-binding-model-in-diligent-engine-2-0/
-    m_pPSO->CreateShaderResourceBinding(&m_SRB, true);
-
+    // Buffers de constantes por frame. Se escriben una sola vez en Render()
+    // (UploadFrameConstants) y van como variables estaticas del PSO, asi que
+    // todos los SRB creados despues los comparten sin volver a enlazarlos.
     BufferDesc CBDesc;
-    CBDesc.Name           = "Constants objects";
-    CBDesc.Size           = sizeof(ConstantsData);
+    CBDesc.Name           = "Frame constants";
+    CBDesc.Size           = sizeof(FrameConstantsData);
     CBDesc.Usage          = USAGE_DYNAMIC;
     CBDesc.BindFlags      = BIND_UNIFORM_BUFFER;
     CBDesc.CPUAccessFlags = CPU_ACCESS_WRITE;
-    m_pDevice->CreateBuffer(CBDesc, nullptr, &m_BufferConstantsObjects);
-    m_SRB->GetVariableByName(SHADER_TYPE_VERTEX, "Constants")->Set(m_BufferConstantsObjects);
+    m_pDevice->CreateBuffer(CBDesc, nullptr, &m_FrameConstantsCB);
 
    BufferDesc CBDesc2;
     CBDesc2.Name           = "Light Constants objects";
@@ -287,7 +336,6 @@ void Tutorial03_Texturing::CreatePipelineState()
     CBDesc2.BindFlags      = BIND_UNIFORM_BUFFER;
     CBDesc2.CPUAccessFlags = CPU_ACCESS_WRITE;
     m_pDevice->CreateBuffer(CBDesc2, nullptr, &m_BufferLightConstants);
-    m_SRB->GetVariableByName(SHADER_TYPE_VERTEX, "LightConstants")->Set(m_BufferLightConstants);
 
     BufferDesc CBDesc3;
     CBDesc3.Name           = "Directional light constants";
@@ -296,8 +344,6 @@ void Tutorial03_Texturing::CreatePipelineState()
     CBDesc3.BindFlags      = BIND_UNIFORM_BUFFER;
     CBDesc3.CPUAccessFlags = CPU_ACCESS_WRITE;
     m_pDevice->CreateBuffer(CBDesc3, nullptr, &m_LightAttribsCB);
-    m_SRB->GetVariableByName(SHADER_TYPE_PIXEL, "cbLightAttribs")->Set(m_LightAttribsCB);
-    m_SRB->GetVariableByName(SHADER_TYPE_VERTEX, "cbLightAttribs")->Set(m_LightAttribsCB);
 
     BufferDesc CBDesc4;
     CBDesc4.Name           = "Parallax Constants";
@@ -306,7 +352,94 @@ void Tutorial03_Texturing::CreatePipelineState()
     CBDesc4.BindFlags      = BIND_UNIFORM_BUFFER;
     CBDesc4.CPUAccessFlags = CPU_ACCESS_WRITE;
     m_pDevice->CreateBuffer(CBDesc4, nullptr, &m_ParallaxAttribsCB);
-    m_SRB->GetVariableByName(SHADER_TYPE_PIXEL, "parallaxConstants")->Set(m_ParallaxAttribsCB);
+
+    BindFrameConstants(m_pPSO);
+    m_pPSO->CreateShaderResourceBinding(&m_SRB, true);
+
+    // PSO instanciado para la capa de pisos/muros de TileScene. Mismo estado que
+    // m_pPSO, pero la matriz de mundo llega por instancia en el buffer slot 1.
+    {
+        ShaderMacro TileMacros[] = {{"CONVERT_PS_OUTPUT_TO_GAMMA", m_ConvertPSOutputToGamma ? "1" : "0"},
+                                    {"COMPACT_VERTEX", CompactVertex},
+                                    {"TILE_INSTANCED", "1"}};
+        ShaderCI.Macros          = {TileMacros, _countof(TileMacros)};
+        ShaderCI.Desc.ShaderType = SHADER_TYPE_VERTEX;
+        ShaderCI.EntryPoint      = "main";
+        ShaderCI.Desc.Name       = "Tile instanced VS";
+        ShaderCI.FilePath        = "cube.vsh";
+        RefCntAutoPtr<IShader> pTileVS;
+        m_pDevice->CreateShader(ShaderCI, &pTileVS);
+
+        // TileInstanceData trae tambien el MaterialId: el stride se da explicito
+        constexpr Uint32 InstanceStride = sizeof(TileInstanceData);
+
+        // clang-format off
+        LayoutElement TileLayoutElems[] =
+        {
+            LayoutElement{0, 0, 3, VT_FLOAT32, False},
+            LayoutElement{1, 0, 3, VT_FLOAT32, False},
+            LayoutElement{2, 0, 2, VT_FLOAT32, False},
+            LayoutElement{3, 0, 4, VT_FLOAT32, False},
+            // Attributes 4..7 - filas de la matriz de mundo (TileInstanceData)
+            LayoutElement{4, 1, 4, VT_FLOAT32, False, LAYOUT_ELEMENT_AUTO_OFFSET, InstanceStride, INPUT_ELEMENT_FREQUENCY_PER_INSTANCE},
+            LayoutElement{5, 1, 4, VT_FLOAT32, False, LAYOUT_ELEMENT_AUTO_OFFSET, InstanceStride, INPUT_ELEMENT_FREQUENCY_PER_INSTANCE},
+            LayoutElement{6, 1, 4, VT_FLOAT32, False, LAYOUT_ELEMENT_AUTO_OFFSET, InstanceStride, INPUT_ELEMENT_FREQUENCY_PER_INSTANCE},
+            LayoutElement{7, 1, 4, VT_FLOAT32, False, LAYOUT_ELEMENT_AUTO_OFFSET, InstanceStride, INPUT_ELEMENT_FREQUENCY_PER_INSTANCE},
+            // Attribute 8 - MaterialId (solo MATERIAL_ARRAY)
+            LayoutElement{8, 1, 1, VT_UINT32, False, LAYOUT_ELEMENT_AUTO_OFFSET, InstanceStride, INPUT_ELEMENT_FREQUENCY_PER_INSTANCE},
+        };
+        // clang-format on
+        VertexQuantizer::WriteVertexLayout(VertexFormat, TileLayoutElems);
+
+        PSOCreateInfo.PSODesc.Name                                = "Tile instanced PSO";
+        PSOCreateInfo.pVS                                         = pTileVS;
+        PSOCreateInfo.GraphicsPipeline.InputLayout.LayoutElements = TileLayoutElems;
+        PSOCreateInfo.GraphicsPipeline.InputLayout.NumElements    = _countof(TileLayoutElems);
+        m_pDevice->CreateGraphicsPipelineState(PSOCreateInfo, &m_pPSOTiles);
+
+        // Sin Constants: en este VS g_World no se usa y el cbuffer desaparece.
+        // Los SRB de este PSO los crea cada POMMaterial (PrepareMaterialSRBs)
+        BindFrameConstants(m_pPSOTiles);
+
+        // Variante MATERIAL_ARRAY: texturas del catalogo en Texture2DArray y
+        // POMConstants por slice; toda la capa de tiles con un PSO y un SRB.
+        // El SRB se crea en CreateMaterialArray(), cuando ya hay materiales.
+        ShaderMacro ArrayMacros[] = {{"CONVERT_PS_OUTPUT_TO_GAMMA", m_ConvertPSOutputToGamma ? "1" : "0"},
+                                     {"COMPACT_VERTEX", CompactVertex},
+                                     {"TILE_INSTANCED", "1"},
+                                     {"MATERIAL_ARRAY", "1"}};
+        ShaderCI.Macros           = {ArrayMacros, _countof(ArrayMacros)};
+
+        ShaderCI.Desc.ShaderType = SHADER_TYPE_VERTEX;
+        ShaderCI.Desc.Name       = "Tile material array VS";
+        ShaderCI.FilePath        = "cube.vsh";
+        RefCntAutoPtr<IShader> pArrayVS;
+        m_pDevice->CreateShader(ShaderCI, &pArrayVS);
+
+        ShaderCI.Desc.ShaderType = SHADER_TYPE_PIXEL;
+        ShaderCI.Desc.Name       = "Tile material array PS";
+        ShaderCI.FilePath        = "cube.psh";
+        RefCntAutoPtr<IShader> pArrayPS;
+        m_pDevice->CreateShader(ShaderCI, &pArrayPS);
+
+        PSOCreateInfo.PSODesc.Name = "Tile material array PSO";
+        PSOCreateInfo.pVS          = pArrayVS;
+        PSOCreateInfo.pPS          = pArrayPS;
+        m_pDevice->CreateGraphicsPipelineState(PSOCreateInfo, &m_pPSOTilesArray);
+        BindFrameConstants(m_pPSOTilesArray);
+
+        BufferDesc MapDesc;
+        MapDesc.Name      = "Tile material map";
+        MapDesc.Size      = sizeof(TileMaterialMapData);
+        MapDesc.Usage     = USAGE_DEFAULT;
+        MapDesc.BindFlags = BIND_UNIFORM_BUFFER;
+
+        BufferData MapData;
+        MapData.pData    = &m_TileMaterialMap;
+        MapData.DataSize = sizeof(m_TileMaterialMap);
+        m_pDevice->CreateBuffer(MapDesc, &MapData, &m_TileMaterialMapCB);
+        m_pPSOTilesArray->GetStaticVariableByName(SHADER_TYPE_VERTEX, "TileMaterialMap")->Set(m_TileMaterialMapCB);
+    }
 
 
 
@@ -381,7 +514,7 @@ void Tutorial03_Texturing::InitializeScene()
 
    /* m_Cubo = std::make_unique<Cubo>(m_pDevice, m_pPSO, 0);
     m_Cubo->SetPosition(float3{0.0f, 2.0f, 0.0f});*/
-    m_Piso = std::make_unique<Cubo>(m_pDevice, m_pPSO, 1);
+    m_Piso = std::make_unique<Cubo>(m_pDevice, m_pPSO, 1, &m_GeometryPool);
     m_Piso->SetPosition(float3{80.0f, -1.0f, 0.0f});
     m_Piso->SetScale(float3{10.0f, 10.0f, 10.0f});
 
@@ -399,266 +532,43 @@ void Tutorial03_Texturing::InitializeScene()
 
     //m_Objetos3D.push_back(std::move(m_Cubo));
     m_Objetos3D.push_back(std::move(m_Piso));
+}
 
 
-    // MODELOS GTLF-----------------------------------------------------
-
-       //const char* modelNames[] = {
-       // "torture_chair/scene.gltf",
-       // "wine_barrel/scene.gltf",
-       // "rusty_cage/scene.gltf",
-       // "skull/scene.gltf",
-       // "treasure_chest/scene.gltf",
-       // "cauldron/scene.gltf"};
-
-    GLTF::ModelCreateInfo CI;
-    CI.FileName = "torture_chair/scene.gltf";
-
-    //m_Model          = std::make_unique<GLTF::Model>(m_pDevice, ModelCI);
-
-    //CI.FileName = modelNames[0];
- 
-
-    static constexpr GLTF::VertexAttributeDesc MyVertexAttrs[] =
-        {
-            // Nombre        , BufferId, Tipo, Componentes
-            {GLTF::PositionAttributeName, 0, VT_FLOAT32, 3},
-            {GLTF::NormalAttributeName, 0, VT_FLOAT32, 3},
-            {GLTF::Texcoord0AttributeName, 0, VT_FLOAT32, 2},
-            {GLTF::TangentAttributeName, 0, VT_FLOAT32, 4} // ojo: tangente es float4 (xyz + w)
-        };
-
-    static constexpr GLTF::TextureAttributeDesc MyTexAttrs[] =
-        {
-            {GLTF::BaseColorTextureName, GLTF::DefaultBaseColorTextureAttribId},
-            {GLTF::NormalTextureName, GLTF::DefaultNormalTextureAttribId},
-            // otros que quieras
-            //{"heightTexture", /*elige un ndice nico, p.e.*/ 5}
-    
-        };
-        
-        CI.VertexAttributes    = MyVertexAttrs;
-        CI.NumVertexAttributes = _countof(MyVertexAttrs);
-        
-        CI.TextureAttributes	= MyTexAttrs;
-        CI.NumTextureAttributes = _countof(MyTexAttrs);
-
-        m_Model = std::make_unique<GLTF::Model>(m_pDevice, m_pImmediateContext, CI);
-
-        m_Model->PrepareGPUResources(m_pDevice, m_pImmediateContext);
-
-
-        int normSlot = m_Model->GetTextureAttributeIndex(GLTF::NormalTextureName);
-        for (auto& mat : m_Model->Materials)
-        {
-            bool active = mat.IsTextureAttribActive(normSlot);
-            OutputDebugStringA(("Normal slot: " + std::to_string(normSlot) + " isActive: " + (active ? "true\n" : "false\n")).c_str());
-        }
-
-
-
-
-
-        //GLTF::Model::ImageData img {};
-
-        //if (LoadHeightMap("MyHeight.png", img))
-        //{
-        //    // Devuelve un ndice en Model.Textures[]
-        //    int heightTexId = m_Model->AddTexture(m_pDevice,
-        //                                         /*pTextureCache*/ nullptr,
-        //                                         /*pResourceMgr*/ nullptr,
-        //                                         img,
-        //                                         /*GltfSamplerId*/ 0,
-        //                                         "HeightMap");
-
-        //    // Asigna ese texture ID al slot 5 de cada material
-        //    int slot = m_Model->GetTextureAttributeIndex("heightTexture");
-        //    for (auto& M : m_Model->Materials)
-        //        M.SetTextureId(slot, heightTexId);
-
-        //    // Ya est en GPU; libera la copia CPU
-        //    stbi_image_free((void*)img.pData);
-        //}
-        //else
-        //{
-        //    OutputDebugStringA("Error: no pudimos cargar MyHeight.png\n");
-        //    // Error: no pudimos cargar MyHeight.png
-        //}
-        
-
-        // Barril
-
-       GLTF::ModelCreateInfo CI2;
-
-       CI2.FileName = "wine_barrel/scene.gltf";
-       CI2.VertexAttributes = MyVertexAttrs;
-       CI2.NumVertexAttributes = _countof(MyVertexAttrs);
-       CI2.TextureAttributes = MyTexAttrs;
-       CI2.NumTextureAttributes = _countof(MyTexAttrs);
-       m_Barril = std::make_unique<GLTF::Model>(m_pDevice, m_pImmediateContext, CI2);
-
-
-       //// Rusty cage
-
-       //GLTF::ModelCreateInfo CI3;
-
-       //CI3.FileName = "rusty_cage/scene.gltf";
-       //CI3.VertexAttributes = MyVertexAttrs;
-       //CI3.NumVertexAttributes = _countof(MyVertexAttrs);
-       //CI3.TextureAttributes = MyTexAttrs;
-       //CI3.NumTextureAttributes = _countof(MyTexAttrs);
-       //m_Cage = std::make_unique<GLTF::Model>(m_pDevice, m_pImmediateContext, CI3);
-
-       // Skull
-       GLTF::ModelCreateInfo CI4;
-
-       CI4.FileName = "skull/scene.gltf";
-       CI4.VertexAttributes = MyVertexAttrs;
-       CI4.NumVertexAttributes = _countof(MyVertexAttrs);
-       CI4.TextureAttributes = MyTexAttrs;
-       CI4.NumTextureAttributes = _countof(MyTexAttrs);
-
-       m_Skull = std::make_unique<GLTF::Model>(m_pDevice, m_pImmediateContext, CI4);
-
-       
-
-
-
-       // Cofre
-
-       //GLTF::ModelCreateInfo CI5;
-       //CI5.FileName = "treasure_chest/scene.gltf";
-       //CI5.VertexAttributes = MyVertexAttrs;
-       //CI5.NumVertexAttributes = _countof(MyVertexAttrs);
-       //CI5.TextureAttributes = MyTexAttrs;
-       //CI5.NumTextureAttributes = _countof(MyTexAttrs);
-       //m_Chest = std::make_unique<GLTF::Model>(m_pDevice, m_pImmediateContext, CI5);
-
-
-       //caldero
-
-       GLTF::ModelCreateInfo CI6;
-       CI6.FileName = "cauldron/scene.gltf";
-       CI6.VertexAttributes = MyVertexAttrs;
-       CI6.NumVertexAttributes = _countof(MyVertexAttrs);
-       CI6.TextureAttributes = MyTexAttrs;
-       CI6.NumTextureAttributes = _countof(MyTexAttrs);
-       m_Cauldron = std::make_unique<GLTF::Model>(m_pDevice, m_pImmediateContext, CI6);
-       //m_Cauldron->PrepareGPUResources(m_pDevice, m_pImmediateContext);
-
-       
-       const char* modelNames[] = {
-           "Altar/scene.gltf",
-           "Barrel/scene.gltf",
-           "Cage/scene.gltf",
-           //"Bed/scene.gltf",
-           //"Column/scene.gltf",
-           "Brazier/scene.gltf",
-           //"Knight/scene.gltf",
-           "BookCase/scene.gltf",
-           "WornBook/scene.gltf",
-           "BoneRest/scene.gltf",
-           "Bed/scene.gltf",
-           "Colum/scene.gltf",
-           "Chest/scene.gltf",
-           "Potions/scene.gltf",
-           "WizardTable/scene.gltf",
-           "WizardCauldron/scene.gltf",
-           "Wardrobe/scene.gltf",
-           "PileCoins/scene.gltf",
-           "Table/scene.gltf",
-
-       };
-
-
-       for (auto modelName: modelNames){
-           GLTF::ModelCreateInfo CI7;
-		   CI7.FileName = modelName;
-		   CI7.VertexAttributes = MyVertexAttrs;
-		   CI7.NumVertexAttributes = _countof(MyVertexAttrs);
-		   CI7.TextureAttributes = MyTexAttrs;
-		   CI7.NumTextureAttributes = _countof(MyTexAttrs);
-		   auto newModel = std::make_unique<GLTF::Model>(m_pDevice, m_pImmediateContext, CI7);
-		   newModel->PrepareGPUResources(m_pDevice, m_pImmediateContext);
-           m_modelsGLTF[modelName] = std::move(newModel);
-           OutputDebugStringA(("Modelo GLTF cargado: " + std::string(modelName) + "\n").c_str());
-        
-       
-       
-       }
-
-
-
-
-
-
-};
-     
-        
-    
+std::vector<TaskGraph::NodeId> Tutorial03_Texturing::AddMaterialLoadTasks(TaskGraph& graph)
+{
+    // Un nodo por material: decodificar sus tres texturas es lo mas lento del
+    // arranque y cada uno solo escribe su puntero
+    struct MaterialFiles
+    {
+        std::unique_ptr<POMMaterial>* pMaterial;
+        const char*                   Albedo;
+        const char*                   Height;
+        const char*                   Normal;
+    };
+    const MaterialFiles files[] = {
+        {&m_Brick2, "bricks2.jpg", "bricks2_dis.jpg", "bricks2_nor.jpg"},
+        {&m_Brick, "brick_wall.png", "brick_wall_dis.png", "brick_wall_nor.png"},
+        {&m_Rock, "rock.jpg", "rock_dis.jpg", "rock_nor.jpg"},
+        {&m_RockPath, "gray_rocks.png", "gray_rocks_dis.png", "gray_rocks_nor.png"},
+        {&m_Rocks2, "rocksLow.jpg", "rocksLow_dis.png", "rocksLow_nor.png"},
+        {&m_DungeonStone, "dungeonStone.png", "dungeonStone_dis.png", "dungeonStone_nor.png"},
+        {&m_DungeonFloor, "dungeonFloor.png", "dungeonFloor_dis.png", "dungeonFloor_nor.png"},
+        {&m_glossyMarble, "glossyMarble.png", "glossyMarble_dis.png", "glossyMarble_nor.png"},
+    };
 
+    std::vector<TaskGraph::NodeId> nodes;
+    for (const auto& f : files)
+    {
+        nodes.push_back(graph.Add(std::string("POMMaterial ") + f.Albedo, [this, f] {
+            *f.pMaterial = std::make_unique<POMMaterial>(m_pDevice, f.Albedo, f.Height, f.Normal, 0.057f); // HeightScale opcional
+        }));
+    }
+    return nodes;
+}
 
 void Tutorial03_Texturing::LoadMaterials() {
-    
-    m_Brick2 = std::make_unique<POMMaterial>(
-        m_pDevice,
-        "bricks2.jpg",
-        "bricks2_dis.jpg",
-        "bricks2_nor.jpg",
-        0.057f); // HeightScale opcional
-
-    m_Brick = std::make_unique<POMMaterial>(
-        m_pDevice,
-        "brick_wall.png",
-        "brick_wall_dis.png",
-        "brick_wall_nor.png",
-        0.057f); // HeightScale opcional
-    //m_Brick->CreateSRB(m_pPSO);
-
-    m_Rock = std::make_unique<POMMaterial>(
-        m_pDevice,
-        "rock.jpg",
-        "rock_dis.jpg",
-        "rock_nor.jpg",
-        0.057f); // HeightScale opcional
-    //m_Rock->CreateSRB(m_pPSO);
-
-    m_RockPath = std::make_unique<POMMaterial>(
-        m_pDevice,
-        "gray_rocks.png",
-        "gray_rocks_dis.png",
-        "gray_rocks_nor.png",
-        0.057f); // HeightScale opcional
-
-    m_Rocks2 = std::make_unique<POMMaterial>(
-        m_pDevice,
-        "rocksLow.jpg",
-        "rocksLow_dis.png",
-        "rocksLow_nor.png",
-        0.057f); // HeightScale opcional
-    
-    m_DungeonStone = std::make_unique<POMMaterial>(
-		m_pDevice,
-		"dungeonStone.png",
-		"dungeonStone_dis.png",
-		"dungeonStone_nor.png",
-		0.057f); // HeightScale opcional
-
-    m_DungeonFloor = std::make_unique<POMMaterial>(
-		m_pDevice,
-		"dungeonFloor.png",
-		"dungeonFloor_dis.png",
-		"dungeonFloor_nor.png",
-		0.057f); // HeightScale opcional
-    //  Regstralos en el catlogo
-
-    m_glossyMarble = std::make_unique<POMMaterial>(
-		m_pDevice,
-		"glossyMarble.png",
-		"glossyMarble_dis.png",
-		"glossyMarble_nor.png",
-		0.057f); // HeightScale opcional
-
+    // Las texturas ya estan cargadas (AddMaterialLoadTasks): registrarlos en el catalogo
     auto addMat = [&](const char* name, POMMaterial* pMat) {
         m_POMCatalog[name] = pMat;
         m_POMNames.push_back(name);
@@ -673,6 +583,11 @@ void Tutorial03_Texturing::LoadMaterials() {
     addMat("Brick", m_Brick.get());
     addMat("Glossy marble", m_glossyMarble.get());
 
+    for (auto& entry : m_POMCatalog)
+        PrepareMaterialSRBs(entry.second);
+
+    CreateMaterialArray();
+
 
     //  Seleccin por defecto
     m_pFloorMat = m_POMCatalog["Dungeon floor"];
@@ -689,47 +604,30 @@ void Tutorial03_Texturing::LoadMaterials() {
 
 }
 
-void Tutorial03_Texturing::InitializeTileScene(){
-
+void Tutorial03_Texturing::LoadTiledMap(const std::string& mapaEscena)
+{
     m_TiledMap = TiledMap();
-    if (m_TiledMap.Load("mapaMazmorra.json")) {
-    
-        OutputDebugStringA("Mapa cargado\n");
-	}
-	else {
-		OutputDebugStringA("Error al cargar el mapa\n");
-    
-    };
-
-    constexpr char suffix[] = "/scene.gltf";
-    // Mapea los nombres de los modelos a los objetos GLTF
-    std::unordered_map<std::string, GLTF::Model*> models;
-
-    for (auto& par:m_modelsGLTF ){
-        const auto& modelName = par.first;
-		auto& model = par.second;
-        std::string formattedName = modelName;
-        
-        auto pos = formattedName.rfind(suffix);
-        if (pos != std::string::npos && pos + std::strlen(suffix) == formattedName.size())
-        {
-            formattedName.erase(pos);
-        }
-
-
-        models[formattedName] = model.get();
+    if (m_TiledMap.Load(mapaEscena))
+    {
 
-		OutputDebugStringA(("Modelo GLTF aadido: " + modelName + "\n").c_str());
-    
+        OutputDebugStringA("Mapa cargado\n");
     }
+    else
+    {
+        OutputDebugStringA("Error al cargar el mapa\n");
+    };
+}
 
+void Tutorial03_Texturing::InitializeTileScene(){
 
+    // El mapa ya esta cargado (LoadTiledMap) y sus modelos pedidos al loader
 
-
+    // Cubo base compartido por todos los tiles (antes se creaba uno por frame).
+    // Antes que el instance buffer de tiles: este lleva su descuantizacion
+    m_TileCube = std::make_unique<Cubo>(m_pDevice, m_pPSO, 0, &m_GeometryPool);
 
     m_TiledScene = TileScene();
-
-    m_TiledScene.Build(m_TiledMap, models, 0, 1);
+    RebuildTileSceneObjects();
 
     //Generar malla del piso
 
@@ -747,90 +645,240 @@ void Tutorial03_Texturing::InitializeTileScene(){
     //};
 
     //// 
-     // 4-B)  Vertex buffer ------------------------------------------------------
+     // 4-B)  Al pool de geometria (se sube en el siguiente Flush) ------------
+    static_assert(sizeof(TileVertex) == GeometryPool::VertexStride, "TileVertex debe coincidir con el pool");
+    m_GeometryPool.Release(m_FloorMesh.Geometry);
     m_FloorMesh = FloorMesh();
+    m_FloorMesh.Geometry = m_GeometryPool.Allocate("", FloorVerts.data(), static_cast<Uint32>(FloorVerts.size()),
+                                                   FloorIdx.data(), static_cast<Uint32>(FloorIdx.size()));
 
 
-    BufferDesc VBDesc;
-    VBDesc.Name      = "Floor VB";
-    VBDesc.BindFlags = BIND_VERTEX_BUFFER;
-    VBDesc.Usage     = USAGE_IMMUTABLE;
-    VBDesc.Size      = static_cast<Uint32>(FloorVerts.size() * sizeof(TileVertex));
 
-    BufferData VBData;
-    VBData.pData    = FloorVerts.data();
-    VBData.DataSize = VBDesc.Size;
 
-    m_pDevice->CreateBuffer(VBDesc, &VBData, &m_FloorMesh.VertexBuffer);
+    OutputDebugStringA("TiledScene creado\n");
+}
 
-    // 4-C)  Index buffer -------------------------------------------------------
-    BufferDesc IBDesc;
-    IBDesc.Name      = "Floor IB";
-    IBDesc.BindFlags = BIND_INDEX_BUFFER;
-    IBDesc.Usage     = USAGE_IMMUTABLE;
-    IBDesc.Size      = static_cast<Uint32>(FloorIdx.size() * sizeof(uint32_t));
+void Tutorial03_Texturing::ReConstruirTileScene(std::string mapaEscena)
+{
+    LoadTiledMap(mapaEscena);
 
-    BufferData IBData;
-    IBData.pData    = FloorIdx.data();
-    IBData.DataSize = IBDesc.Size;
+    // Modelos del mapa nuevo a la cola; los que ya no aparecen se liberan
+    RequestReferencedModels();
+    ReleaseUnreferencedModels();
 
-    m_pDevice->CreateBuffer(IBDesc, &IBData, &m_FloorMesh.IndexBuffer);
+    m_TiledScene = TileScene();
+    RebuildTileSceneObjects();
+}
 
-    //poner numero indices
+void Tutorial03_Texturing::RequestReferencedModels()
+{
+    // Propiedad Name del tileset de cada objeto del mapa -> "<Name>/scene.gltf"
+    m_ReferencedModels.clear();
+    for (const auto& name : m_TiledMap.ReferencedObjectNames())
+    {
+        const std::string file = name + "/scene.gltf";
+        m_ReferencedModels.insert(file);
 
-    m_FloorMesh.NumIndices = static_cast<Uint32>(FloorIdx.size());
+        if (m_modelsGLTF.count(file) != 0 || m_ModelLoader.IsPending(file) || m_ModelLoader.HasFailed(file))
+            continue;
+        m_ModelLoader.Load(file, GetModelCookSettings(file));
 
+        if (!m_ModelLoadTiming)
+        {
+            m_ModelLoadStart  = std::chrono::high_resolution_clock::now();
+            m_ModelLoadTiming = true;
+        }
+    }
+}
 
+ModelCookSettings Tutorial03_Texturing::GetModelCookSettings(const std::string& file) const
+{
+    ModelCookSettings settings = m_ModelLoader.GetCookSettings();
+    settings.OptimizeMeshes    = m_UnoptimizedModels.count(file) == 0;
+    return settings;
+}
 
+void Tutorial03_Texturing::SetModelOptimized(const std::string& file, bool optimize)
+{
+    if (optimize)
+        m_UnoptimizedModels.erase(file);
+    else
+        m_UnoptimizedModels.insert(file);
 
-    OutputDebugStringA("TiledScene creado\n");
+    // Se recocina con los nuevos ajustes; mientras tanto sus placements
+    // vuelven a ser placeholders
+    auto it = m_modelsGLTF.find(file);
+    if (it == m_modelsGLTF.end() || m_ModelLoader.IsPending(file))
+        return;
+    ReleaseModelImpostor(it->second.get());
+    m_GLTFResources.erase(it->second.get());
+    m_modelsGLTF.erase(it);
+    m_ModelLoader.Load(file, GetModelCookSettings(file));
+    RebuildTileSceneObjects();
 }
 
-void Tutorial03_Texturing::ReConstruirTileScene(std::string mapaEscena)
+void Tutorial03_Texturing::ReleaseUnreferencedModels()
 {
-    m_TiledMap = TiledMap();
-    if (m_TiledMap.Load("mapaMazmorra.json"))
+    for (auto it = m_modelsGLTF.begin(); it != m_modelsGLTF.end();)
     {
-
-        OutputDebugStringA("Mapa cargado\n");
+        if (m_ReferencedModels.count(it->first) != 0)
+        {
+            ++it;
+            continue;
+        }
+        // Primero los SRB y el impostor del modelo (van por puntero), luego el modelo
+        ReleaseModelImpostor(it->second.get());
+        m_GLTFResources.erase(it->second.get());
+        OutputDebugStringA(("Modelo GLTF liberado: " + it->first + "\n").c_str());
+        it = m_modelsGLTF.erase(it);
     }
-    else
-    {
-        OutputDebugStringA("Error al cargar el mapa\n");
-    };
+}
 
+std::unordered_map<std::string, StaticModel*> Tutorial03_Texturing::BuildTileModelLookup() const
+{
+    // Nombre del tileset ("Barrel") -> modelo ("Barrel/scene.gltf"). Los que
+    // aun se estan cargando entran con nullptr: TileScene pone un placeholder
     constexpr char suffix[] = "/scene.gltf";
-    // Mapea los nombres de los modelos a los objetos GLTF
-    std::unordered_map<std::string, GLTF::Model*> models;
+    auto formatName = [&](std::string name) {
+        auto pos = name.rfind(suffix);
+        if (pos != std::string::npos && pos + std::strlen(suffix) == name.size())
+            name.erase(pos);
+        return name;
+    };
 
+    std::unordered_map<std::string, StaticModel*> models;
     for (auto& par : m_modelsGLTF)
-    {
-        const auto& modelName     = par.first;
-        auto&       model         = par.second;
-        std::string formattedName = modelName;
+        models[formatName(par.first)] = par.second.get();
+    m_ModelLoader.ForEachPending([&](const std::string& modelName) {
+        models[formatName(modelName)] = nullptr;
+    });
+    return models;
+}
 
-        auto pos = formattedName.rfind(suffix);
-        if (pos != std::string::npos && pos + std::strlen(suffix) == formattedName.size())
-        {
-            formattedName.erase(pos);
-        }
+void Tutorial03_Texturing::RebuildTileSceneObjects()
+{
+    m_TiledScene.Build(m_TiledMap, BuildTileModelLookup(), 0, 1);
+    m_TiledScene.CreateInstanceBuffer(m_pDevice, m_TileCube ? m_TileCube->GetMeshTransform() : float4x4::Identity());
+    BakeTileObjectTransforms();
+
+    // Los props estaticos cambiaron: la cache de sombras ya no vale
+    InvalidateStaticShadowCache();
+
+    m_TileSceneDirty       = false;
+    m_LastTileSceneRebuild = std::chrono::high_resolution_clock::now();
+}
+
+void Tutorial03_Texturing::PumpModelLoads()
+{
+    if (!m_ModelLoader.HasPending() && !m_TileSceneDirty)
+        return;
+
+    m_LoadedModels.clear();
+    if (m_ModelLoader.HasPending() && m_ModelLoader.ProcessUploads(m_ModelUploadBudgetMs, m_LoadedModels) > 0)
+        m_TileSceneDirty = true;
+
+    for (auto& loaded : m_LoadedModels)
+    {
+        // El mapa pudo cambiar mientras se cargaba
+        if (m_ReferencedModels.count(loaded.Name) == 0)
+            continue;
+        CreateGLTFResources(loaded.pModel.get());
+        const auto& cook = loaded.pModel->GetCookStats();
+        OutputDebugStringA(("Modelo GLTF cargado: " + loaded.Name + (loaded.FromCache ? " (cache)" : " (cocinado)") + ", ACMR " +
+                            std::to_string(cook.AcmrBefore) + " -> " + std::to_string(cook.AcmrAfter) + ", ATVR " +
+                            std::to_string(cook.AtvrBefore) + " -> " + std::to_string(cook.AtvrAfter) +
+                            (cook.Optimized ? "\n" : " (sin optimizar)\n")).c_str());
+        // Su geometria llega al GPU en el proximo Flush del pool: se hornea despues
+        m_ImpostorBakeQueue.push_back(loaded.pModel.get());
+        m_modelsGLTF[loaded.Name] = std::move(loaded.pModel);
+    }
 
+    // Los placements de estos modelos dejan de ser placeholders. Reconstruir
+    // la escena (y la cache de sombras) por cada modelo que llega es caro con
+    // el mapa entero: se agrupan los que llegan en m_TileSceneRebuildMs y el
+    // ultimo se aplica en cuanto no queda nada pendiente
+    const std::chrono::duration<double, std::milli> sinceRebuild = std::chrono::high_resolution_clock::now() - m_LastTileSceneRebuild;
+    if (m_TileSceneDirty && (!m_ModelLoader.HasPending() || sinceRebuild.count() >= m_TileSceneRebuildMs))
+        RebuildTileSceneObjects();
 
-        models[formattedName] = model.get();
+    if (m_ModelLoadTiming && !m_ModelLoader.HasPending())
+    {
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - m_ModelLoadStart;
+        m_ModelLoadMs                                           = elapsed.count();
+        m_ModelLoadTiming                                       = false;
 
-        OutputDebugStringA(("Modelo GLTF aadido: " + modelName + "\n").c_str());
+        const auto& stats = m_ModelLoader.GetStats();
+        OutputDebugStringA(("Modelos listos en " + std::to_string(m_ModelLoadMs) + " ms: " + std::to_string(stats.CacheHits) +
+                            " desde cache, " + std::to_string(stats.Cooked) + " cocinados\n").c_str());
     }
+}
 
+void Tutorial03_Texturing::RunModelCacheBenchmark()
+{
+    // Los modelos del mapa, uno a uno en este hilo. En frio: el loader GLTF
+    // (sin contexto, solo CPU) y el cooker. En caliente: proyectar y validar
+    // la cache recien escrita (con la cache de ficheros del SO caliente) y
+    // crear el StaticModel desde ella.
+    using clock  = std::chrono::high_resolution_clock;
+    auto msSince = [](clock::time_point t0) {
+        return std::chrono::duration<double, std::milli>(clock::now() - t0).count();
+    };
 
+    // Reescribe las caches: no pisar las que los workers aun estan usando
+    if (m_ModelLoader.HasPending())
+    {
+        OutputDebugStringA("Benchmark cache: hay modelos cargandose, prueba despues\n");
+        return;
+    }
 
+    ModelCacheBenchResult bench;
+    for (const auto& file : m_ReferencedModels)
+    {
+        const ModelCookSettings settings = GetModelCookSettings(file);
 
+        auto t0 = clock::now();
+        try
+        {
+            GLTF::Model gltf{m_pDevice, nullptr, MakeModelCreateInfo(file.c_str())};
+        }
+        catch (...)
+        {
+            OutputDebugStringA(("Benchmark cache: el loader GLTF fallo con " + file + "\n").c_str());
+            continue;
+        }
+        bench.GLTFParseMs += msSince(t0);
 
-    m_TiledScene = TileScene();
+        const std::string cachePath = ModelCache::GetCachePath(file);
+        CookedModelData   cooked;
+        std::string       error;
+        t0 = clock::now();
+        if (!ModelCooker::Cook(file, settings, cooked, error) || !ModelCache::Write(cachePath, cooked))
+        {
+            OutputDebugStringA(("Benchmark cache: no se pudo cocinar " + file + " " + error + "\n").c_str());
+            continue;
+        }
+        bench.CookMs += msSince(t0);
 
-    m_TiledScene.Build(m_TiledMap, models, 0, 1);
+        MappedCookedModel warm;
+        t0 = clock::now();
+        if (!warm.Open(cachePath, file, settings.GetHash()))
+            continue;
+        bench.WarmOpenMs += msSince(t0);
+        bench.CacheBytes += warm.File.GetSize();
 
+        t0 = clock::now();
+        StaticModel model;
+        model.Create(m_pDevice, file, warm.View);
+        bench.CreateMs += msSince(t0);
 
+        ++bench.NumModels;
+    }
+    bench.Valid       = bench.NumModels > 0;
+    m_ModelCacheBench = bench;
 
+    OutputDebugStringA(("Benchmark cache (" + std::to_string(bench.NumModels) + " modelos): GLTF " + std::to_string(bench.GLTFParseMs) +
+                        " ms, cooker " + std::to_string(bench.CookMs) + " ms, cache " + std::to_string(bench.WarmOpenMs) +
+                        " ms + crear " + std::to_string(bench.CreateMs) + " ms, " + std::to_string(bench.CacheBytes / 1024) + " KB\n").c_str());
 }
 
 void Tutorial03_Texturing::Initialize(const SampleInitInfo& InitInfo)
@@ -839,42 +887,99 @@ void Tutorial03_Texturing::Initialize(const SampleInitInfo& InitInfo)
 
     SampleBase::Initialize(InitInfo);
 
-    CreatePipelineState();
-    CreatePipelineStateGLTF();
+    // Anillo para todas las constantes por draw (world, material, sombras)
+    m_ConstantRing.Initialize(m_pDevice, "Per-draw constants ring", ConstantRingSize, BIND_UNIFORM_BUFFER,
+                              m_pDevice->GetAdapterInfo().Buffer.ConstantBufferOffsetAlignment);
+    // El formato del pool decide el input layout de todos los PSO de mallas: antes de crearlos
+    m_GeometryPool.Initialize(m_pDevice, GeometryPoolVertices, GeometryPoolIndices,
+                              m_CompactVertices ? MESH_VERTEX_FORMAT_COMPACT : MESH_VERTEX_FORMAT_FLOAT);
+
     CreateVertexBuffer();
     CreateIndexBuffer();
-    createShadowMapManager();
     LoadTexture();
-    LoadMaterials();
-    InitializeScene();
-
-    InitializeTileScene();
-
-
-    
-    m_DungeonGenerator.Generate(60, 40, 10, 20, 20);
-    m_DungeonGenerator.SavePPM("Dungeon.ppm");
-
-
-
-    m_DungeonScene = DungeonScene(m_pDevice, m_pPSO, m_RockPath.get(), m_RockPath.get());
-    m_DungeonScene.Build(m_DungeonGenerator);
-
-    OutputDebugStringA("POMMaterial binded\n");
-
-    m_ShadowMap = std::make_unique<ShadowMap>();
-
-    auto actualHeight = m_pSwapChain->GetDesc().Height;
-    auto actualWidth  = m_pSwapChain->GetDesc().Width;
-
-    m_ShadowMap->Initialize(m_pDevice, actualWidth, actualHeight);
 
+    // Arranque como grafo de dependencias: compilar PSOs, decodificar las
+    // texturas de los materiales, parsear el mapa, pedir los modelos y generar
+    // la mazmorra se solapan en un pool de hilos (el device es free-threaded).
+    // En este hilo solo lo que usa el contexto o el GeometryPool, que no es
+    // thread-safe
+    TaskGraph startup;
+
+    const auto pso = startup.Add("CreatePipelineState", [this] { CreatePipelineState(); });
+    // Los dos enlazan los CB del frame que crea CreatePipelineState
+    startup.Add("CreatePipelineStateGLTF", [this] { CreatePipelineStateGLTF(); }, {pso});
+    startup.Add("ImpostorAtlas", [this] {
+        m_Impostors.Initialize(m_pDevice, m_pSwapChain->GetDesc().ColorBufferFormat, m_pSwapChain->GetDesc().DepthBufferFormat,
+                               m_GeometryPool.GetVertexFormat(), m_FrameConstantsCB, m_LightAttribsCB);
+    }, {pso});
+    const auto shadowMgr = startup.Add("createShadowMapManager", [this] { createShadowMapManager(); });
+    startup.Add("ShadowMap", [this] {
+        m_ShadowMap = std::make_unique<ShadowMap>();
+
+        auto actualHeight = m_pSwapChain->GetDesc().Height;
+        auto actualWidth  = m_pSwapChain->GetDesc().Width;
+
+        m_ShadowMap->Initialize(m_pDevice, actualWidth, actualHeight, m_GeometryPool.GetVertexFormat());
+        m_ShadowMap->BindConstantsRing(m_ConstantRing.GetBuffer(), m_ConstantRing.GetAlignedSize(sizeof(ShadowConstantsData)));
+    });
+
+    // Catalogo: SRBs contra los PSO y con el shadow map; el material array sube con el contexto
+    std::vector<TaskGraph::NodeId> materialDeps = AddMaterialLoadTasks(startup);
+    materialDeps.push_back(pso);
+    materialDeps.push_back(shadowMgr);
+    const auto materials = startup.AddMain("LoadMaterials", [this] { LoadMaterials(); }, materialDeps);
+
+    // createShadowMapManager tambien escribe m_LightAttribs: la escena va despues
+    startup.AddMain("InitializeScene", [this] { InitializeScene(); }, {pso, shadowMgr, materials});
+
+    // Solo se cargan los modelos que coloca el mapa (RequestReferencedModels).
+    // Cada uno sale de su cache cocinada (ModelCache/<modelo>.dgcm) o se cocina la
+    // primera vez y se guarda; sus workers empiezan en cuanto se piden
+    const auto map    = startup.Add("LoadTiledMap", [this] { LoadTiledMap("mapaMazmorra.json"); });
+    const auto models = startup.Add("RequestReferencedModels", [this] {
+        m_ModelLoader.Initialize(m_pDevice, &m_GeometryPool);
+        RequestReferencedModels();
+    }, {map});
+    startup.AddMain("InitializeTileScene", [this] { InitializeTileScene(); }, {pso, models});
+
+    const auto dungeon = startup.Add("DungeonGenerator", [this] {
+        m_DungeonGenerator.Generate(60, 40, 10, 20, 20);
+        m_DungeonGenerator.SavePPM("Dungeon.ppm");
+    });
+    startup.AddMain("DungeonScene", [this] {
+        m_DungeonScene = DungeonScene(m_pDevice, m_pPSO, m_RockPath.get(), m_RockPath.get(), 2.0f, 2.0f, 0.1f, &m_GeometryPool);
+        m_DungeonScene.Build(m_DungeonGenerator);
+    }, {pso, materials, dungeon});
+
+    // En GL el device no admite crear recursos desde otros hilos: todo en orden
+    if (m_pDevice->GetDeviceInfo().IsGLDevice())
+    {
+        startup.Run(nullptr);
+    }
+    else
+    {
+        ThreadPool startupPool;
+        startup.Run(&startupPool);
+    }
 
+    m_StartupReport = startup.GetReport();
+    OutputDebugStringA(("Arranque:\n" + startup.FormatReport()).c_str());
 }
 
 // Render a frame
 void Tutorial03_Texturing::Render()
 {
+    // Constantes del frame: una escritura por buffer, antes de cualquier draw
+    if (m_ConstantRing.BeginFrame())
+        BindConstantRing();
+    m_RenderQueue.BeginFrame();
+    m_LastFrameCBStats = m_FrameCBStats;
+    m_FrameCBStats     = {};
+    UploadFrameConstants();
+
+    // Mallas nuevas (modelos recien cargados) al VB/IB compartido antes de grabar draws
+    m_GeometryPool.Flush(m_pImmediateContext);
+    BakePendingImpostors();
 
     ////Shadow map
     //m_pImmediateContext->SetRenderTargets(0, nullptr, m_ShadowMap->GetDSV(), RESOURCE_STATE_TRANSITION_MODE_NONE);
@@ -917,6 +1022,115 @@ void Tutorial03_Texturing::Render()
 
 }
 
+void Tutorial03_Texturing::UploadFrameConstants()
+{
+    FrameConstantsData frameData{};
+    frameData.g_ViewProj  = m_Camera.GetViewMatrix() * m_Camera.GetProjMatrix();
+    frameData.g_CameraPos = m_Camera.GetPos();
+    WriteFrameConstants(m_FrameConstantsCB, frameData);
+
+    // Constantes de intento de luz spot
+    LightConstants lightData  = {};
+    lightData.g_LightPos      = m_LightCamera.GetPos();
+    lightData.g_ViewProjLight = m_LightCamera.GetViewMatrix() * m_LightCamera.GetProjMatrix();
+    WriteFrameConstants(m_BufferLightConstants, lightData);
+
+    // Luz direccional (cascadas ya distribuidas en Update)
+    WriteFrameConstants(m_LightAttribsCB, m_LightAttribs);
+
+    WriteFrameConstants(m_ParallaxAttribsCB, m_ParallaxAttribs);
+
+    // cbPOM de cada material: solo sube los que cambiaron desde el ultimo frame
+    for (auto& entry : m_POMCatalog)
+        entry.second->Upload(m_pImmediateContext);
+    if (m_MaterialArray.IsValid())
+        m_MaterialArray.Upload(m_pImmediateContext);
+}
+
+void Tutorial03_Texturing::PrepareMaterialSRBs(POMMaterial* pMat)
+{
+    // Pase principal: el world llega por draw desde el anillo de constantes
+    auto* pSRB = pMat->CreateSRB(m_pPSO);
+    pSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_ShadowMap")->Set(m_ShadowMapMgr.GetSRV());
+    pMat->GetConstantsVar(m_pPSO)->SetBufferRange(m_ConstantRing.GetBuffer(), 0, m_ConstantRing.GetAlignedSize(sizeof(ConstantsData)));
+
+    // Tiles instanciados: el world viene en el buffer de instancias
+    auto* pTileSRB = pMat->CreateSRB(m_pPSOTiles);
+    pTileSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_ShadowMap")->Set(m_ShadowMapMgr.GetSRV());
+}
+
+void Tutorial03_Texturing::BindConstantRing()
+{
+    OutputDebugStringA(("Anillo de constantes por draw: " + std::to_string(m_ConstantRing.GetSize() / 1024) + " KB\n").c_str());
+
+    for (auto& entry : m_POMCatalog)
+    {
+        if (auto* pVar = entry.second->GetConstantsVar(m_pPSO))
+            pVar->SetBufferRange(m_ConstantRing.GetBuffer(), 0, m_ConstantRing.GetAlignedSize(sizeof(ConstantsData)));
+    }
+    if (m_ShadowMap)
+        m_ShadowMap->BindConstantsRing(m_ConstantRing.GetBuffer(), m_ConstantRing.GetAlignedSize(sizeof(ShadowConstantsData)));
+
+    const auto shared = GetConstantRingBindings();
+    for (auto& entry : m_GLTFResources)
+        entry.second.BindConstantRing(shared);
+}
+
+void Tutorial03_Texturing::CreateMaterialArray()
+{
+    // Slices en el orden de m_POMNames, el mismo que ven los combos de la UI
+    std::vector<POMMaterial*> materials;
+    for (const auto& name : m_POMNames)
+        materials.push_back(m_POMCatalog[name]);
+
+    if (!m_MaterialArray.Build(m_pDevice, m_pImmediateContext, materials))
+    {
+        OutputDebugStringA("Material array desactivado: menos de dos materiales compatibles\n");
+        m_UseMaterialArray = false;
+        return;
+    }
+
+    // g_POMConstants es estatica: se enlaza en el PSO antes de crear el SRB
+    m_pPSOTilesArray->GetStaticVariableByName(SHADER_TYPE_PIXEL, "g_POMConstants")->Set(m_MaterialArray.GetConstantsSRV());
+
+    m_pPSOTilesArray->CreateShaderResourceBinding(&m_SRBTilesArray, true);
+    m_SRBTilesArray->GetVariableByName(SHADER_TYPE_PIXEL, "g_Albedo")->Set(m_MaterialArray.GetAlbedoSRV());
+    m_SRBTilesArray->GetVariableByName(SHADER_TYPE_PIXEL, "g_HeightMap")->Set(m_MaterialArray.GetHeightSRV());
+    m_SRBTilesArray->GetVariableByName(SHADER_TYPE_PIXEL, "g_NormalMap")->Set(m_MaterialArray.GetNormalSRV());
+    m_SRBTilesArray->GetVariableByName(SHADER_TYPE_PIXEL, "g_ShadowMap")->Set(m_ShadowMapMgr.GetSRV());
+}
+
+POMMaterial* Tutorial03_Texturing::GetTileMaterial(Uint32 materialId) const
+{
+    if (materialId == 0)
+        return m_pFloorMat;
+    if (materialId == 1)
+        return m_pWallMat;
+    return nullptr;
+}
+
+void Tutorial03_Texturing::BindPOMMaterial(POMMaterial* pMat, const float4x4& world, IShaderResourceBinding*& pLastSRB)
+{
+    pMat->GetConstantsVar(m_pPSO)->SetBufferOffset(m_ConstantRing.Upload(m_pImmediateContext, ConstantsData{world}));
+
+    // Cambiar de material = un commit; el offset del world se lee en cada draw
+    auto* pSRB = pMat->GetSRB(m_pPSO);
+    if (pSRB != pLastSRB)
+    {
+        m_pImmediateContext->CommitShaderResources(pSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        pLastSRB = pSRB;
+    }
+}
+
+void Tutorial03_Texturing::BindFrameConstants(IPipelineState* pPSO)
+{
+    SetStaticVariable(pPSO, SHADER_TYPE_VERTEX, "FrameConstants", m_FrameConstantsCB);
+    SetStaticVariable(pPSO, SHADER_TYPE_VERTEX, "LightConstants", m_BufferLightConstants);
+    SetStaticVariable(pPSO, SHADER_TYPE_VERTEX, "cbLightAttribs", m_LightAttribsCB);
+    SetStaticVariable(pPSO, SHADER_TYPE_PIXEL, "cbLightAttribs", m_LightAttribsCB);
+    SetStaticVariable(pPSO, SHADER_TYPE_PIXEL, "parallaxConstants", m_ParallaxAttribsCB);
+}
+
 void Tutorial03_Texturing::RenderizarObjetos()
 {
     //// Renderizar el cubo
@@ -1013,91 +1227,405 @@ void Tutorial03_Texturing::RenderizarObjetos()
     m_pImmediateContext->SetPipelineState(m_pPSO);
 
     
+     IShaderResourceBinding* pLastSRB      = nullptr;
+     const float4x4          meshTransform = cuboDungeon->GetMeshTransform();
      for (auto& tile : m_DungeonScene.GetInstances()){
-         
-         {
-             ConstantsData cbData{};
-             cbData.g_World = tile.World;
 
-             cbData.g_ViewProj  = m_Camera.GetViewMatrix() * m_Camera.GetProjMatrix();
-             cbData.g_CameraPos = m_Camera.GetPos();
-             MapHelper<ConstantsData> CBHelper(m_pImmediateContext, m_BufferConstantsObjects, MAP_WRITE, MAP_FLAG_DISCARD);
+         POMMaterial* pMat = GetTileMaterial(tile.MaterialId);
+         if (pMat == nullptr)
+             continue;
 
-             *CBHelper = cbData;
-         }
+         // Solo el mundo es por draw; camara y luz ya estan en los CB del frame
+         BindPOMMaterial(pMat, meshTransform * tile.World, pLastSRB);
 
-          // Constantes de intento de luz spot
-         {
-             LightConstants cbDataL = {};
+         DrawIndexedAttribs drawAttrs;
+         drawAttrs.IndexType  = VT_UINT32;
+         drawAttrs.NumIndices         = cuboDungeon->GetNumIndices();
+         drawAttrs.FirstIndexLocation = cuboDungeon->GetFirstIndex();
+         drawAttrs.BaseVertex         = cuboDungeon->GetBaseVertex();
+         drawAttrs.Flags              = DRAW_FLAG_VERIFY_ALL;
+         m_pImmediateContext->DrawIndexed(drawAttrs);
 
-             cbDataL.g_LightPos      = m_LightCamera.GetPos();
-             cbDataL.g_ViewProjLight = m_LightCamera.GetViewMatrix() * m_LightCamera.GetProjMatrix();
 
 
-             MapHelper<LightConstants> CBHelperL(m_pImmediateContext, m_BufferLightConstants, MAP_WRITE, MAP_FLAG_DISCARD);
-             *CBHelperL = cbDataL;
-         }
+
+	
+         
+         
 
 
-          // Luz direccional
+        
+     }
+
+
+
+}
+
+ void Tutorial03_Texturing::RenderizarTilesInstanced()
+ {
+     if (m_TiledScene.Batches().empty())
+         return;
+
+     IBuffer* pVBs[]    = {m_TileCube->GetVertexBuffer(), m_TiledScene.GetInstanceBuffer()};
+     Uint64   offsets[] = {0, 0};
+     m_pImmediateContext->SetVertexBuffers(0, _countof(pVBs), pVBs, offsets, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, SET_VERTEX_BUFFERS_FLAG_RESET);
+     m_pImmediateContext->SetIndexBuffer(m_TileCube->GetIndexBuffer(), 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+     // Modo array: si suelo y muro estan en el Texture2DArray, los rangos
+     // visibles se funden sin mirar el material (sin culling: un solo draw)
+     const int  floorSlice = m_MaterialArray.GetSlice(m_pFloorMat);
+     const int  wallSlice  = m_MaterialArray.GetSlice(m_pWallMat);
+     const bool useArray   = m_UseMaterialArray && floorSlice >= 0 && wallSlice >= 0;
+     CollectVisibleTileRanges(useArray);
+     if (m_VisibleTileRanges.empty())
+         return;
+
+     if (useArray)
+     {
+         // El mapa MaterialId -> slice solo se sube cuando cambia la seleccion
+         if (m_TileMaterialMap.Slices[0] != static_cast<Uint32>(floorSlice) ||
+             m_TileMaterialMap.Slices[1] != static_cast<Uint32>(wallSlice))
          {
-             MapHelper<LightAttribs> CBHelperLightAttribs(m_pImmediateContext, m_LightAttribsCB, MAP_WRITE, MAP_FLAG_DISCARD);
-             *CBHelperLightAttribs = m_LightAttribs;
+             m_TileMaterialMap.Slices[0] = static_cast<Uint32>(floorSlice);
+             m_TileMaterialMap.Slices[1] = static_cast<Uint32>(wallSlice);
+             m_pImmediateContext->UpdateBuffer(m_TileMaterialMapCB, 0, sizeof(m_TileMaterialMap), &m_TileMaterialMap,
+                                               RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
          }
 
+         m_pImmediateContext->SetPipelineState(m_pPSOTilesArray);
+         m_pImmediateContext->CommitShaderResources(m_SRBTilesArray, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+     }
+     else
+     {
+         m_pImmediateContext->SetPipelineState(m_pPSOTiles);
+     }
 
+     // Camara y luz ya estan en los CB del frame; el mundo viene por instancia.
+     // Un draw instanciado por rango visible, un commit solo al cambiar de material
+     IShaderResourceBinding* pLastSRB = nullptr;
+     for (const auto& range : m_VisibleTileRanges)
+     {
+         if (!useArray)
          {
-             MapHelper<parallaxConstants> CBHelperParallax(m_pImmediateContext, m_ParallaxAttribsCB, MAP_WRITE, MAP_FLAG_DISCARD);
-             *CBHelperParallax = m_ParallaxAttribs;
+             auto* pSRB = GetTileMaterial(range.MaterialId)->GetSRB(m_pPSOTiles);
+             if (pSRB != pLastSRB)
+             {
+                 m_pImmediateContext->CommitShaderResources(pSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+                 pLastSRB = pSRB;
+             }
          }
 
+         DrawIndexedAttribs drawAttrs;
+         drawAttrs.IndexType             = VT_UINT32;
+         drawAttrs.NumIndices            = m_TileCube->GetNumIndices();
+         drawAttrs.FirstIndexLocation    = m_TileCube->GetFirstIndex();
+         drawAttrs.BaseVertex            = m_TileCube->GetBaseVertex();
+         drawAttrs.NumInstances          = range.NumInstances;
+         drawAttrs.FirstInstanceLocation = range.FirstInstance;
+         drawAttrs.Flags                 = DRAW_FLAG_VERIFY_ALL;
+         m_pImmediateContext->DrawIndexed(drawAttrs);
+         ++m_TileStats[1].DrawCalls;
+     }
+ }
 
-         if (tile.MaterialId == 0) {
-      /*      m_RockPath->Upload(m_pImmediateContext);
-            m_RockPath->Bind(m_SRB);*/
-             m_pFloorMat->Upload(m_pImmediateContext);
-             m_pFloorMat->Bind(m_SRB);
+void Tutorial03_Texturing::CollectVisibleTileRanges(bool mergeMaterials)
+{
+    // Batches ordenados por (material, chunk): los visibles y contiguos en el
+    // instance buffer se funden en un solo rango
+    m_VisibleTileRanges.clear();
+    for (const auto& batch : m_TiledScene.Batches())
+    {
+        if (GetTileMaterial(batch.MaterialId) == nullptr)
+            continue;
+        if (m_CullTiles && !m_TiledScene.IsChunkVisible(batch.ChunkId))
+            continue;
 
-         
-         }
+        if (!m_VisibleTileRanges.empty())
+        {
+            auto& last = m_VisibleTileRanges.back();
+            if (last.FirstInstance + last.NumInstances == batch.FirstInstance &&
+                (mergeMaterials || last.MaterialId == batch.MaterialId))
+            {
+                last.NumInstances += batch.NumInstances;
+                continue;
+            }
+        }
+        m_VisibleTileRanges.push_back(batch);
+    }
+}
+
+void Tutorial03_Texturing::CullTileScene()
+{
+    m_CullStats.TotalChunks = m_TiledScene.NumChunks();
+    if (!m_CullTiles)
+    {
+        m_CullStats.VisibleChunks = m_CullStats.TotalChunks;
+        return;
+    }
+
+    const auto tStart = std::chrono::high_resolution_clock::now();
 
-         else if (tile.MaterialId ==1) {
-      /*      m_Brick2->Upload(m_pImmediateContext);
-			m_Brick2->Bind(m_SRB);*/
-             m_pWallMat->Upload(m_pImmediateContext);
-             m_pWallMat->Bind(m_SRB);
+    const float4x4 viewProj   = m_Camera.GetViewMatrix() * m_Camera.GetProjMatrix();
+    m_CullStats.VisibleChunks = m_TiledScene.CullChunks(viewProj, m_pDevice->GetDeviceInfo().IsGLDevice());
+
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - tStart;
+    m_CullStats.CullTimeMs = m_CullStats.CullTimeMs * 0.9 + elapsed.count() * 0.1;
+}
+
+void Tutorial03_Texturing::SelectTileObjectLods()
+{
+    // Tamano en pantalla = radio / semialtura del frustum a la distancia del
+    // centro (proj._22 = cot(fov / 2)): 1 = la esfera llena la altura
+    const auto&  objects = m_TiledScene.Objects();
+    const float  projY   = m_Camera.GetProjMatrix()._22;
+    const float3 camPos  = m_Camera.GetPos();
+
+    m_LodStats = {};
+    m_TileObjectLods.resize(objects.size());
+    for (size_t i = 0; i < objects.size(); ++i)
+    {
+        const auto&  obj = objects[i];
+        const auto&  cook = obj.pModel->GetCookStats();
+        const float3 center{obj.Bounds.x, obj.Bounds.y, obj.Bounds.z};
+        const float  dist = (std::max)(length(center - camPos), obj.Bounds.w);
 
-		 }
+        // Lejos y con el modelo ya horneado: un quad del atlas
+        if (m_UseImpostors && dist > m_ImpostorDistance && m_Impostors.GetSlice(obj.pModel) >= 0)
+        {
+            m_TileObjectLods[i] = ImpostorLod;
+            ++m_LodStats.Impostors;
+            m_LodStats.Triangles += 2;
+            m_LodStats.TrianglesLod0 += cook.LodTriangles[0];
+            continue;
+        }
+
+        Uint32 lod = 0;
+        if (m_UseLods)
+        {
+            const float size = dist > 0.f ? obj.Bounds.w * projY / dist : 1.f;
+            while (lod + 1 < CookedMaxLods && size < m_LodScreenSize[lod])
+                ++lod;
+        }
+        m_TileObjectLods[i] = static_cast<Uint8>(lod);
+
+        ++m_LodStats.Objects[lod];
+        m_LodStats.Triangles += cook.LodTriangles[lod];
+        m_LodStats.TrianglesLod0 += cook.LodTriangles[0];
+    }
+}
+
+Uint32 Tutorial03_Texturing::GetTileObjectLod(Uint32 objectIdx, bool isShadowPass) const
+{
+    // Objetos de un Build() posterior a la seleccion de este frame: LOD0
+    const Uint32 lod = objectIdx < m_TileObjectLods.size() ? m_TileObjectLods[objectIdx] : 0;
+    // Los impostores proyectan sombra con la malla mas simple
+    if (isShadowPass && lod == ImpostorLod)
+        return CookedMaxLods - 1;
+    if (!isShadowPass || !m_UseLods)
+        return lod;
+    return (std::min)(lod + static_cast<Uint32>(m_ShadowLodBias), CookedMaxLods - 1);
+}
+
+Uint32 Tutorial03_Texturing::GetShadowCasterLod(Uint32 objectIdx, const float4x4& cascadeViewProj) const
+{
+    if (!m_DrawingStaticShadows)
+        return GetTileObjectLod(objectIdx, true);
+    if (!m_UseLods)
+        return 0;
+
+    // Mismo criterio que SelectTileObjectLods con la cascada como pantalla:
+    // radio / semialtura de la cascada. La escala Y de la proyeccion ortogonal
+    // es 1 / semialtura en mundo, asi que solo depende de la ViewProj
+    const float scaleY = length(float3(cascadeViewProj._12, cascadeViewProj._22, cascadeViewProj._32));
+    const float size   = m_TiledScene.Objects()[objectIdx].Bounds.w * scaleY;
+
+    Uint32 lod = 0;
+    while (lod + 1 < CookedMaxLods && size < m_LodScreenSize[lod])
+        ++lod;
+    return (std::min)(lod + static_cast<Uint32>(m_ShadowLodBias), CookedMaxLods - 1);
+}
+
+void Tutorial03_Texturing::BakePendingImpostors()
+{
+    // Cambia render targets y viewport: antes de las sombras y del pase principal
+    for (StaticModel* modelo : m_ImpostorBakeQueue)
+    {
+        if (m_Impostors.Bake(m_pImmediateContext, *modelo))
+            OutputDebugStringA(("Impostor horneado: " + modelo->GetName() + ", slice " + std::to_string(m_Impostors.GetSlice(modelo)) + "\n").c_str());
+    }
+    m_ImpostorBakeQueue.clear();
+}
 
-         m_SRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_ShadowMap")->Set(m_ShadowMapMgr.GetSRV(), SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
-         m_pImmediateContext->CommitShaderResources(m_SRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+void Tutorial03_Texturing::ReleaseModelImpostor(StaticModel* modelo)
+{
+    m_Impostors.Release(modelo);
+    m_ImpostorBakeQueue.erase(std::remove(m_ImpostorBakeQueue.begin(), m_ImpostorBakeQueue.end(), modelo), m_ImpostorBakeQueue.end());
+}
 
-         DrawIndexedAttribs drawAttrs;
-         drawAttrs.IndexType  = VT_UINT32;
-         drawAttrs.NumIndices = cuboDungeon->GetNumIndices();
-         drawAttrs.Flags      = DRAW_FLAG_VERIFY_ALL;
-         m_pImmediateContext->DrawIndexed(drawAttrs);
+void Tutorial03_Texturing::CollectImpostors(std::vector<Uint32>& objects)
+{
+    // Compacta la lista en su sitio (sigue creciente para RecordTileObjects)
+    // y deja los impostores en m_ImpostorInstances
+    m_ImpostorInstances.clear();
+    const auto& sceneObjects = m_TiledScene.Objects();
+    size_t      numMeshes    = 0;
+    for (const Uint32 idx : objects)
+    {
+        const int slice = idx < m_TileObjectLods.size() && m_TileObjectLods[idx] == ImpostorLod ? m_Impostors.GetSlice(sceneObjects[idx].pModel) : -1;
+        if (slice < 0)
+        {
+            objects[numMeshes++] = idx;
+            continue;
+        }
+        const auto& obj = sceneObjects[idx];
+        m_ImpostorInstances.push_back(ImpostorAtlas::MakeInstance(obj.World, obj.pModel->GetBoundingSphere(), slice));
+    }
+    objects.resize(numMeshes);
+}
 
+void Tutorial03_Texturing::RunCullingBenchmark()
+{
+    // Mapa sintetico de 512x512 celdas con las medidas de TileScene, centrado
+    // como en TileScene::Build. Mismo frustum que la camara actual.
+    constexpr int    MapCells   = 512;
+    constexpr int    NumChunks  = MapCells / TileScene::ChunkCells;
+    constexpr int    Iterations = 1000;
+    const float      TS         = m_TiledScene.GetTileSize();
+    const float      halfH      = m_TiledScene.GetWallHeight() * 0.5f;
+    const float      origin     = -MapCells * TS * 0.5f;
+    const float      chunkSize  = TileScene::ChunkCells * TS;
+
+    ChunkBoundsSoA bounds;
+    for (int cz = 0; cz < NumChunks; ++cz)
+    {
+        for (int cx = 0; cx < NumChunks; ++cx)
+        {
+            const float x0 = origin + cx * chunkSize;
+            const float z0 = origin + cz * chunkSize;
+            bounds.Add(float3{x0, -halfH, z0}, float3{x0 + chunkSize, halfH, z0 + chunkSize});
+        }
+    }
 
+    const float4x4         viewProj = m_Camera.GetViewMatrix() * m_Camera.GetProjMatrix();
+    const FrustumPlanesSoA planes{viewProj, m_pDevice->GetDeviceInfo().IsGLDevice()};
+
+    std::vector<Uint8> visibleSIMD, visibleScalar;
+    Uint32             numVisible = 0;
+
+    auto tStart = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < Iterations; ++i)
+        numVisible = CullChunks(bounds, planes, visibleSIMD, true);
+    const std::chrono::duration<double, std::micro> simdTime = std::chrono::high_resolution_clock::now() - tStart;
+
+    tStart = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < Iterations; ++i)
+        CullChunks(bounds, planes, visibleScalar, false);
+    const std::chrono::duration<double, std::micro> scalarTime = std::chrono::high_resolution_clock::now() - tStart;
+
+    m_CullBench.Valid         = true;
+    m_CullBench.Match         = visibleSIMD == visibleScalar;
+    m_CullBench.NumChunks     = bounds.Size();
+    m_CullBench.VisibleChunks = numVisible;
+    m_CullBench.SIMDTimeUs    = simdTime.count() / Iterations;
+    m_CullBench.ScalarTimeUs  = scalarTime.count() / Iterations;
+
+    OutputDebugStringA(("Culling 512x512: " + std::to_string(m_CullBench.VisibleChunks) + "/" + std::to_string(m_CullBench.NumChunks) +
+                        " chunks visibles, SSE " + std::to_string(m_CullBench.SIMDTimeUs) + " us, escalar " +
+                        std::to_string(m_CullBench.ScalarTimeUs) + " us" + (m_CullBench.Match ? "" : " (RESULTADOS DISTINTOS)") + "\n")
+                           .c_str());
+}
 
+void Tutorial03_Texturing::RunDungeonBenchmark()
+{
+    // Mismos parametros de BSP que la mazmorra de Initialize. Un generador
+    // nuevo por tamano: el tiempo no incluye liberar el arbol anterior.
+    // La pasada en el pool tiene que dar la misma mazmorra que la de 1 hilo.
+    constexpr uint32_t Seed = 1234;
 
-	
-         
-         
+    enum BenchPass
+    {
+        PassSerial,
+        PassParallel,
+        PassPacked,
+        PassCount
+    };
 
+    ThreadPool pool;
+    m_DungeonBenchThreads = pool.GetNumThreads();
 
-        
-     }
+    m_DungeonBench.clear();
+    for (int size = 64; size <= 8192; size *= 2)
+    {
+        DungeonBenchResult result;
+        result.Size = size;
 
+        TileBitplane floorBits[PassCount];
+        for (int pass = 0; pass < PassCount; ++pass)
+        {
+            DungeonGenerator generator;
+            generator.SetStorage(pass == PassPacked ? DungeonGenerator::Storage::Packed2Bit : DungeonGenerator::Storage::Bytes);
 
+            const auto tStart = std::chrono::high_resolution_clock::now();
+            generator.Generate(size, size, 10, 20, Seed, pass == PassParallel ? &pool : nullptr);
+            const std::chrono::duration<double, std::milli> time = std::chrono::high_resolution_clock::now() - tStart;
 
+            const double gridMB = generator.GetGridBytes() / (1024.0 * 1024.0);
+            switch (pass)
+            {
+                case PassSerial:
+                    result.Ms      = time.count();
+                    result.GridMB  = gridMB;
+                    result.FloorPc = 100.0 * generator.CountTiles(DungeonGenerator::Tile::Floor) / (static_cast<double>(size) * size);
+                    result.Nodes      = generator.GetTreeStats().Nodes;
+                    result.TreeAllocs = generator.GetTreeStats().Allocations;
+                    result.OldAllocs  = generator.GetTreeStats().PerNodeAllocations();
+                    break;
+                case PassParallel:
+                    result.ParallelMs = time.count();
+                    break;
+                case PassPacked:
+                    result.PackedMs = time.count();
+                    result.PackedMB = gridMB;
+                    break;
+            }
+            generator.ExportBitplane(DungeonGenerator::Tile::Floor, floorBits[pass]);
+        }
+        result.Match = floorBits[PassSerial].Words == floorBits[PassParallel].Words && floorBits[PassSerial].Words == floorBits[PassPacked].Words;
+        m_DungeonBench.push_back(result);
+
+        OutputDebugStringA(("Mazmorra " + std::to_string(size) + "x" + std::to_string(size) + ": " + std::to_string(result.Ms) + " ms (" +
+                            std::to_string(result.GridMB) + " MB), " + std::to_string(m_DungeonBenchThreads) + " hilos " +
+                            std::to_string(result.ParallelMs) + " ms, 2 bits " + std::to_string(result.PackedMs) + " ms (" +
+                            std::to_string(result.PackedMB) + " MB), " + std::to_string(result.FloorPc) + "% suelo, " +
+                            std::to_string(result.Nodes) + " nodos en " + std::to_string(result.TreeAllocs) + " bloques (antes " +
+                            std::to_string(result.OldAllocs) + " news)" + (result.Match ? "" : " (RESULTADOS DISTINTOS)") + "\n")
+                               .c_str());
+    }
 }
 
- void Tutorial03_Texturing::RenderizarTileScene(bool isShadowPass, float4x4 cascadeProj) {
+ void Tutorial03_Texturing::RenderizarTileScene(bool isShadowPass, float4x4 cascadeProj, const std::vector<Uint32>* pCasterObjects) {
 
+     // Las sombras siguen dibujando todo: un caster fuera de camara puede
+     // proyectar dentro
      if (!isShadowPass)
+         CullTileScene();
+
+     if (!isShadowPass && m_UseInstancedTiles)
      {
-         auto     cuboBase = new Cubo(m_pDevice, m_pPSO, 0);
+         const auto tStart = std::chrono::high_resolution_clock::now();
+         m_TileStats[1].DrawCalls = 0;
+
+         RenderizarTilesInstanced();
+
+         const std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - tStart;
+         m_TileStats[1].CPUTimeMs = m_TileStats[1].CPUTimeMs * 0.9 + elapsed.count() * 0.1;
+     }
+     else if (!isShadowPass)
+     {
+         const auto tStart = std::chrono::high_resolution_clock::now();
+         m_TileStats[0].DrawCalls = 0;
+
+         auto*    cuboBase = m_TileCube.get();
          IBuffer* pvB[]    = {cuboBase->GetVertexBuffer()};
          Uint64   offset[] = {0};
 
@@ -1179,247 +1707,87 @@ void Tutorial03_Texturing::RenderizarObjetos()
 
 
 
+         IShaderResourceBinding* pLastSRB      = nullptr;
+         const float4x4          meshTransform = cuboBase->GetMeshTransform();
          for (auto& tile : m_TiledScene.Tiles())
          {
+             POMMaterial* pMat = GetTileMaterial(tile.MaterialId);
+             if (pMat == nullptr)
+                 continue;
+             if (m_CullTiles && !m_TiledScene.IsChunkVisible(tile.ChunkId))
+                 continue;
 
-             {
-                 ConstantsData cbData{};
-                 cbData.g_World = tile.World;
-
-                 cbData.g_ViewProj  = m_Camera.GetViewMatrix() * m_Camera.GetProjMatrix();
-                 cbData.g_CameraPos = m_Camera.GetPos();
-                 MapHelper<ConstantsData> CBHelper(m_pImmediateContext, m_BufferConstantsObjects, MAP_WRITE, MAP_FLAG_DISCARD);
-
-                 *CBHelper = cbData;
-             }
-
-             //Output de materialID
-
-             // OutputDebugStringA(("Material ID: " + std::to_string(tile.MaterialId) + "\n").c_str());
-
-             if (tile.MaterialId == 0)
-             {
-                 /*m_RockPath->Upload(m_pImmediateContext);
-                 m_RockPath->Bind(m_SRB);*/
-
-                 /*m_DungeonStone->Upload(m_pImmediateContext);
-                 m_DungeonStone->Bind(m_SRB);*/
-
-                /* m_DungeonFloor->Upload(m_pImmediateContext);
-                 m_DungeonFloor->Bind(m_SRB);*/
-
-                 m_pFloorMat->Upload(m_pImmediateContext);
-                 m_pFloorMat->Bind(m_SRB);
+             BindPOMMaterial(pMat, meshTransform * tile.World, pLastSRB);
 
-
-             }
-             else if (tile.MaterialId == 1)
-             {
-                 /*m_Brick2->Upload(m_pImmediateContext);
-                 m_Brick2->Bind(m_SRB);*/
-              /*   m_DungeonStone->Upload(m_pImmediateContext);
-                 m_DungeonStone->Bind(m_SRB);*/
-                 m_pWallMat->Upload(m_pImmediateContext);
-                 m_pWallMat->Bind(m_SRB);
-
-
-             }
-
-             m_SRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_ShadowMap")->Set(m_ShadowMapMgr.GetSRV(), SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
-             m_pImmediateContext->CommitShaderResources(m_SRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
              DrawIndexedAttribs drawAttrs;
              drawAttrs.IndexType  = VT_UINT32;
-             drawAttrs.NumIndices = cuboBase->GetNumIndices();
-             drawAttrs.Flags      = DRAW_FLAG_VERIFY_ALL;
+             drawAttrs.NumIndices         = cuboBase->GetNumIndices();
+             drawAttrs.FirstIndexLocation = cuboBase->GetFirstIndex();
+             drawAttrs.BaseVertex         = cuboBase->GetBaseVertex();
+             drawAttrs.Flags              = DRAW_FLAG_VERIFY_ALL;
              m_pImmediateContext->DrawIndexed(drawAttrs);
+             ++m_TileStats[0].DrawCalls;
          }
+
+         const std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - tStart;
+         m_TileStats[0].CPUTimeMs = m_TileStats[0].CPUTimeMs * 0.9 + elapsed.count() * 0.1;
      }
 
 
 
      // ----------------------------------- Renderizar modelos GLTF -----------------------------------
-     if (!isShadowPass) { 
-         m_pImmediateContext->SetPipelineState(m_pPSOGLTF);
-     }
-     else
+     // Se graban todas las primitivas y la cola las emite ordenadas por estado
+     // Pase de sombra con lista de casters de la cascada: solo esos
+     if (isShadowPass && pCasterObjects != nullptr)
      {
-         m_pImmediateContext->SetPipelineState(m_ShadowMap->GetShadowPSO());
-     }
-     //Tamao de m_tiledScene.objects() en outpud
-     //OutputDebugStringA(("Tamao de m_TiledScene.Objects(): " + std::to_string(m_TiledScene.Objects().size()) + "\n").c_str());
-
-
-     for (auto& tileObjeto: m_TiledScene.Objects()){
-        
-         auto modeloGLTF = tileObjeto.pModel;
-
-
-         GLTF::ModelTransforms transforms;
-
-         modeloGLTF->ComputeTransforms(modeloGLTF->DefaultSceneId, transforms);
-
-       
-    // 2) Recorre cada nodo del modelo
-         for (size_t nodeIdx = 0; nodeIdx < modeloGLTF->Nodes.size(); ++nodeIdx)
+         if (m_UseInstancedProps)
          {
-             const auto& node = modeloGLTF->Nodes[nodeIdx];
-             if (node.pMesh == nullptr)
-                 continue; // este nodo no tiene geometra
-
-             // 3) Obtn su matrix mundo
-             const float4x4& world = transforms.NodeGlobalMatrices[nodeIdx] * tileObjeto.World;
-
-             // 4) Por cada primitiva dentro de ese mesh
-             for (const auto& prim : node.pMesh->Primitives)
-             {
-                 // 5) Bind VB/IB
-                 Uint64   offsets[] = {0};
-                 IBuffer* pVB[]     = {modeloGLTF->GetVertexBuffer(0)};
-                 m_pImmediateContext->SetVertexBuffers(
-                     0, 1, pVB, offsets,
-                     RESOURCE_STATE_TRANSITION_MODE_TRANSITION,
-                     SET_VERTEX_BUFFERS_FLAG_RESET);
-                 m_pImmediateContext->SetIndexBuffer(
-                     modeloGLTF->GetIndexBuffer(), 0,
-                     RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
-
-                 if (!isShadowPass)
-                 {
-                     //m_pImmediateContext->SetPipelineState(m_pPSOGLTF);
-                     // 6a) Actualiza constantes de cmara+world
-                     ConstantsData cb{world,
-                                      m_Camera.GetViewMatrix() * m_Camera.GetProjMatrix(),
-                                      m_Camera.GetPos()};
-                     {
-                         MapHelper<ConstantsData> helper(
-                             m_pImmediateContext,
-                             m_BufferConstantsObjects,
-                             MAP_WRITE, MAP_FLAG_DISCARD);
-                         *helper = cb;
-                     }
-
-                     materialConstants matCb{};
-
-                     matCb.materialId = prim.MaterialId;
-                     matCb._mPad = 0; // Padding para alinear a 16 bytes
-                     matCb._mPd1 = 0; // Padding para alinear a 16 bytes
-                     matCb._mPd2 = 0; // Padding para alinear a 16 bytes
-
-
-                     {
-                         MapHelper<materialConstants> helper(
-                             m_pImmediateContext,
-                             m_MaterialAttribsCB,
-                             MAP_WRITE, MAP_FLAG_DISCARD);
-                         *helper = matCb;
-                     }
-
-
-                     // Constantes de intento de luz spot
-                     {
-                         LightConstants cbDataL = {};
-
-                         cbDataL.g_LightPos      = m_LightCamera.GetPos();
-                         cbDataL.g_ViewProjLight = m_LightCamera.GetViewMatrix() * m_LightCamera.GetProjMatrix();
-
-
-                         MapHelper<LightConstants> CBHelperL(m_pImmediateContext, m_BufferLightConstants, MAP_WRITE, MAP_FLAG_DISCARD);
-                         *CBHelperL = cbDataL;
-                     }
-
-
-                     // Luz direccional
-                     {
-                         MapHelper<LightAttribs> CBHelperLightAttribs(m_pImmediateContext, m_LightAttribsCB, MAP_WRITE, MAP_FLAG_DISCARD);
-                         *CBHelperLightAttribs = m_LightAttribs;
-                     }
-
-                     m_SRBGLTF->GetVariableByName(SHADER_TYPE_PIXEL, "g_ShadowMap")->Set(m_ShadowMapMgr.GetSRV(), SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
-
-
-                     // 6b) Bindea las texturas del material de la primitiva
-                     auto& mat = modeloGLTF->Materials[prim.MaterialId];
-                     // Recorre slo los atributos de textura activos
-                     for (Uint32 i = 0; i < modeloGLTF->GetNumTextureAttributes(); ++i)
-                     {
-                         const auto&  texAttr = modeloGLTF->GetTextureAttribute(i);
-                         const Uint32 slot    = texAttr.Index; // <-- aqu, usa el Id, no "i"
-                         if (!mat.IsTextureAttribActive(slot))
-                             continue;
-
-                         int   texId   = mat.GetTextureId(slot);
-                         auto* pTex    = modeloGLTF->GetTexture(texId);
-                         auto* pTexSRV = pTex->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE);
-
-                         auto correctName = AttrToShaderName.at(texAttr.Name);
-                        // OutputDebugStringA((correctName + " Original Name: " + texAttr.Name + "\n").c_str());
-
-                         m_SRBGLTF->GetVariableByName(
-                                      SHADER_TYPE_PIXEL, correctName.c_str())
-                             ->Set(pTexSRV, SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
-                     }
-
-
-                     // 6c) Commit y draw
-                     m_pImmediateContext->CommitShaderResources(
-                         m_SRBGLTF, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
-                 }
-                 else
-                 {   
-                     //auto cascadeProj = float4x4::Identity();
-                     // Pase de sombra: slo world + cascadeProj
-                    /* ShadowConstantsData scb{world, cascadeProj};
-                     {
-                         MapHelper<ShadowConstantsData> helper(
-                             m_pImmediateContext,
-                             m_ShadowMap->GetCB(),
-                             MAP_WRITE, MAP_FLAG_DISCARD);
-                         *helper = scb;
-                     }*/
-
-                     ShadowConstantsData cbData = {};
-
-                     cbData.g_LightViewProj = cascadeProj;
-                     cbData.g_World         = world;
-
-                     MapHelper<ShadowConstantsData> CBHelper(m_pImmediateContext, m_ShadowMap->GetCB(), MAP_WRITE, MAP_FLAG_DISCARD);
-                     *CBHelper = cbData;
-
-
-                     m_pImmediateContext->CommitShaderResources(
-                         m_ShadowMap->GetSRB(),
-                         RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
-                 }
-
-                 // 7) DrawIndexed
-                 DrawIndexedAttribs drawAttrs;
-                 drawAttrs.IndexType          = VT_UINT32;
-                 drawAttrs.NumIndices         = prim.IndexCount;
-                 drawAttrs.FirstIndexLocation = prim.FirstIndex;
-                 drawAttrs.BaseVertex         = modeloGLTF->GetBaseVertex();
-                 drawAttrs.Flags              = DRAW_FLAG_VERIFY_ALL;
-                 m_pImmediateContext->DrawIndexed(drawAttrs);
-             }
+             RecordTileObjects(*pCasterObjects, true, cascadeProj);
+         }
+         else
+         {
+             const auto& objects = m_TiledScene.Objects();
+             for (const Uint32 idx : *pCasterObjects)
+                 RecordGLTFInstance(objects[idx].pModel, m_TiledScene.NodeWorlds(objects[idx]), GetShadowCasterLod(idx, cascadeProj), true, cascadeProj);
          }
 
+         SubmitRenderQueue();
+         return;
+     }
 
-     
-     
-     
-     
-     
-     
-     
+     const auto& objects = m_TiledScene.Objects();
+     m_TileObjectList.clear();
+     for (Uint32 idx = 0; idx < static_cast<Uint32>(objects.size()); ++idx)
+     {
+         if (!isShadowPass && m_CullTiles && !m_TiledScene.IsChunkVisible(objects[idx].ChunkId))
+             continue;
+         m_TileObjectList.push_back(idx);
      }
- 
- 
-    // ----------------------------------- Renderizar modelos GLTF -----------------------------------
- 
- 
+     if (!isShadowPass)
+     {
+         m_CullStats.VisibleObjects = static_cast<Uint32>(m_TileObjectList.size());
+         // Los lejanos salen de la lista: van todos en el draw de impostores
+         CollectImpostors(m_TileObjectList);
+     }
+
+     if (m_UseInstancedProps)
+     {
+         RecordTileObjects(m_TileObjectList, isShadowPass, cascadeProj);
+     }
+     else
+     {
+         for (const Uint32 idx : m_TileObjectList)
+             RecordGLTFInstance(objects[idx].pModel, m_TiledScene.NodeWorlds(objects[idx]), GetTileObjectLod(idx, isShadowPass), isShadowPass,
+                                cascadeProj);
+     }
+
+     SubmitRenderQueue();
+
+     if (!isShadowPass)
+         m_ImpostorDraws = m_Impostors.Draw(m_pImmediateContext, m_ImpostorInstances);
  }
  
 
-
 void Tutorial03_Texturing::RenderShadowPass()
 {
 
@@ -1464,6 +1832,10 @@ void Tutorial03_Texturing::RenderShadowPass()
 
 
     auto iNumShadowCascades = m_LightAttribs.ShadowAttribs.iNumCascades;
+
+    // Matrices de todas las cascadas primero: las listas de casters se
+    // construyen todas antes de emitir ningun draw
+    std::vector<float4x4> cascadeViewProj(iNumShadowCascades);
     for (int iCascade = 0; iCascade < iNumShadowCascades; ++iCascade)
     {
         const auto CascadeProjMatr = m_ShadowMapMgr.GetCascadeTransform(iCascade).Proj;
@@ -1472,7 +1844,18 @@ void Tutorial03_Texturing::RenderShadowPass()
             m_LightAttribs.ShadowAttribs.mWorldToLightView :
             m_LightAttribs.ShadowAttribs.mWorldToLightView.Transpose();
 
-        const auto WorldToLightProjSpaceMatr = WorldToLightViewSpaceMatr * CascadeProjMatr;
+        cascadeViewProj[iCascade] = WorldToLightViewSpaceMatr * CascadeProjMatr;
+    }
+    BuildShadowCasterLists(cascadeViewProj);
+
+    m_ShadowCacheStats = {};
+    if (m_UseStaticShadowCache)
+        EnsureStaticShadowCache(static_cast<Uint32>(iNumShadowCascades));
+
+    for (int iCascade = 0; iCascade < iNumShadowCascades; ++iCascade)
+    {
+        const auto& WorldToLightProjSpaceMatr = cascadeViewProj[iCascade];
+        const auto& casters                   = m_CascadeCasters[iCascade];
 
         CameraAttribs ShadowCameraAttribs = {};
 
@@ -1491,8 +1874,26 @@ void Tutorial03_Texturing::RenderShadowPass()
         }*/
 
         auto* pCascadeDSV = m_ShadowMapMgr.GetCascadeDSV(iCascade);
-        m_pImmediateContext->SetRenderTargets(0, nullptr, pCascadeDSV, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
-        m_pImmediateContext->ClearDepthStencil(pCascadeDSV, CLEAR_DEPTH_FLAG, 1.f, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        if (m_UseStaticShadowCache && m_StaticShadowCache)
+        {
+            // Estaticos desde la cache (redibujada solo si la cascada cambio)
+            UpdateStaticShadowCascade(iCascade, WorldToLightProjSpaceMatr, casters.TileObjects);
+
+            CopyTextureAttribs CopyAttribs(m_StaticShadowCache, RESOURCE_STATE_TRANSITION_MODE_TRANSITION,
+                                           m_ShadowMapMgr.GetSRV()->GetTexture(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+            CopyAttribs.SrcSlice = iCascade;
+            CopyAttribs.DstSlice = iCascade;
+            m_pImmediateContext->CopyTexture(CopyAttribs);
+
+            m_pImmediateContext->SetRenderTargets(0, nullptr, pCascadeDSV, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        }
+        else
+        {
+            m_pImmediateContext->SetRenderTargets(0, nullptr, pCascadeDSV, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+            m_pImmediateContext->ClearDepthStencil(pCascadeDSV, CLEAR_DEPTH_FLAG, 1.f, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+            RenderizarTileScene(true, WorldToLightProjSpaceMatr, &casters.TileObjects);
+        }
 
         //ViewFrustumExt Frutstum;
         //ExtractViewFrustumPlanesFromMatrix(WorldToLightProjSpaceMatr, Frutstum, m_pDevice->GetDeviceInfo().IsGLDevice());
@@ -1503,11 +1904,9 @@ void Tutorial03_Texturing::RenderShadowPass()
         /*RenderizarObjeto(m_Piso.get(), true, WorldToLightProjSpaceMatr);
         RenderizarObjeto(m_Cubo.get(), true, WorldToLightProjSpaceMatr);*/
 
-        for (const auto& objeto : m_Objetos3D) {
-			RenderizarObjeto(objeto.get(), true, WorldToLightProjSpaceMatr);
-		}
-
-        RenderizarTileScene(true, WorldToLightProjSpaceMatr);
+        // Dinamicos (m_Objetos3D se pueden mover): cada frame, encima
+        for (const Uint32 idx : casters.Objetos)
+            RenderizarObjeto(m_Objetos3D[idx].get(), true, WorldToLightProjSpaceMatr);
 
 
 
@@ -1521,94 +1920,157 @@ void Tutorial03_Texturing::RenderShadowPass()
 }
 
 
-void Tutorial03_Texturing::RenderizarObjeto(Objeto3D* objeto, bool isShadowPass, float4x4 cascadeProj) {
-
-    IBuffer* pVB[]    = {objeto->GetVertexBuffer()};
-    Uint64   offset[] = {0};
+void Tutorial03_Texturing::BuildShadowCasterLists(const std::vector<float4x4>& cascadeViewProj)
+{
+    const auto tStart = std::chrono::high_resolution_clock::now();
 
-    auto viewProj = m_Camera.GetViewMatrix() * m_Camera.GetProjMatrix();
-    //PrintFloat4x4(viewProj, "viewProj");
+    const Uint32 numCascades = static_cast<Uint32>(cascadeViewProj.size());
+    const auto&  tileObjects = m_TiledScene.Objects();
+    const bool   isGL        = m_pDevice->GetDeviceInfo().IsGLDevice();
 
-    m_pImmediateContext->SetVertexBuffers(0, 1, pVB, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, SET_VERTEX_BUFFERS_FLAG_RESET);
+    // Las esferas de m_Objetos3D recorren la jerarquia: una vez, en serie
+    m_CasterSpheres.resize(m_Objetos3D.size());
+    for (size_t i = 0; i < m_Objetos3D.size(); ++i)
+        m_CasterSpheres[i] = float4{m_Objetos3D[i]->GetBoundingSphereCenter(), m_Objetos3D[i]->GetBoundingSphereRadius()};
 
-    m_pImmediateContext->SetIndexBuffer(objeto->GetIndexBuffer(), 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    m_ShadowCasterStats.Candidates = static_cast<Uint32>(m_CasterSpheres.size() + tileObjects.size());
+    m_CascadeCasters.resize(numCascades);
 
-    if (!isShadowPass)
+    // En serie: son unos cientos de esferas contra 6 planos por cascada, menos
+    // que lo que cuesta lanzar un hilo por cascada (BuildTimeMs lo mide)
+    for (Uint32 iCascade = 0; iCascade < numCascades; ++iCascade)
     {
-        m_pImmediateContext->SetPipelineState(m_pPSO);
-        {
-            ConstantsData cbData = {};
-            cbData.g_World       = objeto->GetWorldTransform();
+        auto& list = m_CascadeCasters[iCascade];
+        list.Objetos.clear();
+        list.TileObjects.clear();
 
-            cbData.g_ViewProj = m_Camera.GetViewMatrix() * m_Camera.GetProjMatrix();
+        FrustumPlanesSoA planes{cascadeViewProj[iCascade], isGL};
+        planes.IgnorePlane(FrustumPlanesSoA::NEAR_PLANE);
 
-            cbData.g_CameraPos = m_Camera.GetPos();
-
-            MapHelper<ConstantsData> CBHelper(m_pImmediateContext, m_BufferConstantsObjects, MAP_WRITE, MAP_FLAG_DISCARD);
-            *CBHelper = cbData;
+        for (Uint32 i = 0; i < static_cast<Uint32>(m_CasterSpheres.size()); ++i)
+        {
+            const float4& s = m_CasterSpheres[i];
+            if (!m_CullShadowCasters || IsSphereVisible(planes, float3{s.x, s.y, s.z}, s.w))
+                list.Objetos.push_back(i);
         }
-
-        // Constantes de intento de luz spot
+        for (Uint32 i = 0; i < static_cast<Uint32>(tileObjects.size()); ++i)
         {
-            LightConstants cbDataL = {};
+            const float4& s = tileObjects[i].Bounds;
+            if (!m_CullShadowCasters || IsSphereVisible(planes, float3{s.x, s.y, s.z}, s.w))
+                list.TileObjects.push_back(i);
+        }
+    }
 
-            cbDataL.g_LightPos      = m_LightCamera.GetPos();
-            cbDataL.g_ViewProjLight = m_LightCamera.GetViewMatrix() * m_LightCamera.GetProjMatrix();
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - tStart;
+    m_ShadowCasterStats.BuildTimeMs = m_ShadowCasterStats.BuildTimeMs * 0.9 + elapsed.count() * 0.1;
+}
 
+void Tutorial03_Texturing::EnsureStaticShadowCache(Uint32 numCascades)
+{
+    // Mismo formato/tamano que el shadow map para poder copiar slice a slice
+    const auto& ShadowDesc = m_ShadowMapMgr.GetSRV()->GetTexture()->GetDesc();
+    if (m_StaticShadowCache)
+    {
+        const auto& CacheDesc = m_StaticShadowCache->GetDesc();
+        if (CacheDesc.Width == ShadowDesc.Width && CacheDesc.Height == ShadowDesc.Height &&
+            CacheDesc.Format == ShadowDesc.Format && CacheDesc.ArraySize == ShadowDesc.ArraySize)
+            return;
+    }
 
-            MapHelper<LightConstants> CBHelperL(m_pImmediateContext, m_BufferLightConstants, MAP_WRITE, MAP_FLAG_DISCARD);
-            *CBHelperL = cbDataL;
-        }
+    TextureDesc Desc = ShadowDesc;
+    Desc.Name        = "Static shadow cache";
+    m_StaticShadowCache.Release();
+    m_pDevice->CreateTexture(Desc, nullptr, &m_StaticShadowCache);
 
+    m_StaticShadowDSVs.clear();
+    m_StaticShadowDSVs.resize(Desc.ArraySize);
+    for (Uint32 slice = 0; slice < Desc.ArraySize; ++slice)
+    {
+        TextureViewDesc ViewDesc;
+        ViewDesc.ViewType        = TEXTURE_VIEW_DEPTH_STENCIL;
+        ViewDesc.TextureDim      = RESOURCE_DIM_TEX_2D_ARRAY;
+        ViewDesc.FirstArraySlice = slice;
+        ViewDesc.NumArraySlices  = 1;
+        m_StaticShadowCache->CreateView(ViewDesc, &m_StaticShadowDSVs[slice]);
+    }
 
-        // Luz direccional
-        {
-            MapHelper<LightAttribs> CBHelperLightAttribs(m_pImmediateContext, m_LightAttribsCB, MAP_WRITE, MAP_FLAG_DISCARD);
-			*CBHelperLightAttribs = m_LightAttribs;
+    m_StaticShadowViewProj.assign(numCascades, float4x4{});
+    m_StaticShadowValid.assign(numCascades, false);
+}
 
-        }
+void Tutorial03_Texturing::UpdateStaticShadowCascade(Uint32 iCascade, const float4x4& cascadeViewProj, const std::vector<Uint32>& tileObjects)
+{
+    if (iCascade >= m_StaticShadowValid.size())
+    {
+        m_StaticShadowViewProj.resize(iCascade + 1);
+        m_StaticShadowValid.resize(iCascade + 1, false);
+    }
 
+    // La ViewProj ya incluye la direccion de la luz y el snap de la cascada.
+    // Los casters salen de esa ViewProj y su LOD tambien (GetShadowCasterLod),
+    // asi que mover la camara sin mover la cascada no redibuja
+    if (m_StaticShadowValid[iCascade] &&
+        std::memcmp(&m_StaticShadowViewProj[iCascade], &cascadeViewProj, sizeof(float4x4)) == 0)
+    {
+        ++m_ShadowCacheStats.CascadesCached;
+        return;
+    }
 
-        {
-            MapHelper<parallaxConstants> CBHelperParallax(m_pImmediateContext, m_ParallaxAttribsCB, MAP_WRITE, MAP_FLAG_DISCARD);
-            *CBHelperParallax = m_ParallaxAttribs;
-        
-        
-        }
+    auto* pCacheDSV = m_StaticShadowDSVs[iCascade].RawPtr();
+    m_pImmediateContext->SetRenderTargets(0, nullptr, pCacheDSV, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    m_pImmediateContext->ClearDepthStencil(pCacheDSV, CLEAR_DEPTH_FLAG, 1.f, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    m_DrawingStaticShadows = true;
+    RenderizarTileScene(true, cascadeViewProj, &tileObjects);
+    m_DrawingStaticShadows = false;
+    // Desenlazar antes de copiar desde la cache
+    m_pImmediateContext->SetRenderTargets(0, nullptr, nullptr, RESOURCE_STATE_TRANSITION_MODE_NONE);
+
+    m_StaticShadowViewProj[iCascade] = cascadeViewProj;
+    m_StaticShadowValid[iCascade]    = true;
+    ++m_ShadowCacheStats.CascadesRendered;
+}
 
+void Tutorial03_Texturing::RenderizarObjeto(Objeto3D* objeto, bool isShadowPass, float4x4 cascadeProj) {
 
+    IBuffer* pVB[]    = {objeto->GetVertexBuffer()};
+    Uint64   offset[] = {0};
 
-        objeto->commitMaterial(m_SRB, m_pImmediateContext);
+    auto viewProj = m_Camera.GetViewMatrix() * m_Camera.GetProjMatrix();
+    //PrintFloat4x4(viewProj, "viewProj");
 
-       // auto* matSRB =  objeto->getMaterial()->GetSRB();
+    m_pImmediateContext->SetVertexBuffers(0, 1, pVB, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, SET_VERTEX_BUFFERS_FLAG_RESET);
 
-        //objeto->getMaterial()->Upload(m_pImmediateContext);
+    m_pImmediateContext->SetIndexBuffer(objeto->GetIndexBuffer(), 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
 
+    if (!isShadowPass)
+    {
+        m_pImmediateContext->SetPipelineState(m_pPSO);
 
-        //m_SRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_ShadowMap")->Set(m_ShadowMap->GetSRV(), SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
-        m_SRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_ShadowMap")->Set(m_ShadowMapMgr.GetSRV(), SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
-        //m_pImmediateContext->CommitShaderResources(matSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
-        m_pImmediateContext->CommitShaderResources(m_SRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        // SRB propio del material: texturas, cbPOM y shadow map ya enlazados
+        IShaderResourceBinding* pLastSRB = nullptr;
+        BindPOMMaterial(objeto->getMaterial(), objeto->GetMeshTransform() * objeto->GetWorldTransform(), pLastSRB);
 
         
         
     }
 
     else{
-        
+        // SubmitRenderQueue() puede dejar enlazado el PSO instanciado de sombras
+        // (slot 1 con las filas por instancia): fijar siempre el no instanciado
+        m_pImmediateContext->SetPipelineState(m_ShadowMap->GetShadowPSO());
+
         {
             ShadowConstantsData cbData = {};
             //cbData.g_LightViewProj     = m_LightCamera.GetViewMatrix() * m_LightCamera.GetProjMatrix();
             cbData.g_LightViewProj	 = cascadeProj;
-            cbData.g_World             = objeto->GetWorldTransform();
+            cbData.g_World             = objeto->GetMeshTransform() * objeto->GetWorldTransform();
 
 
             //PrintFloat4x4(m_LightCamera.GetViewMatrix(), "LightView");
             //PrintFloat4x4(m_LightCamera.GetProjMatrix(), "LightProj");
 
 
-            MapHelper<ShadowConstantsData> CBHelper(m_pImmediateContext, m_ShadowMap->GetCB(), MAP_WRITE, MAP_FLAG_DISCARD);
-            *CBHelper = cbData;
+            m_ShadowMap->GetConstantsVar()->SetBufferOffset(m_ConstantRing.Upload(m_pImmediateContext, cbData));
         }
 
         m_pImmediateContext->CommitShaderResources(m_ShadowMap->GetSRB(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
@@ -1621,8 +2083,10 @@ void Tutorial03_Texturing::RenderizarObjeto(Objeto3D* objeto, bool isShadowPass,
     // Realiza el draw call
     DrawIndexedAttribs drawAttrs;
     drawAttrs.IndexType  = VT_UINT32;
-    drawAttrs.NumIndices = objeto->GetNumIndices();
-    drawAttrs.Flags      = DRAW_FLAG_VERIFY_ALL;
+    drawAttrs.NumIndices         = objeto->GetNumIndices();
+    drawAttrs.FirstIndexLocation = objeto->GetFirstIndex();
+    drawAttrs.BaseVertex         = objeto->GetBaseVertex();
+    drawAttrs.Flags              = DRAW_FLAG_VERIFY_ALL;
     m_pImmediateContext->DrawIndexed(drawAttrs);
     //OutputDebugStringA("Dibujando cubo sombras\n");
     if (!isShadowPass)
@@ -1637,144 +2101,211 @@ void Tutorial03_Texturing::RenderizarObjeto(Objeto3D* objeto, bool isShadowPass,
 }
 
 
-void Tutorial03_Texturing::RenderizarObjeto(GLTF::Model* modelo, bool isShadowPass, float4x4 cascadeProj, float4x4 worldMatrix)
+void Tutorial03_Texturing::RenderizarObjeto(StaticModel* modelo, bool isShadowPass, float4x4 cascadeProj, float4x4 worldMatrix)
 {
-    // 1) Calcula las transformaciones de la escena por defecto
-    
-    GLTF::ModelTransforms transforms;
-    modelo->ComputeTransforms(modelo->DefaultSceneId, transforms);
-
-    // 2) Recorre cada nodo del modelo
-    for (size_t nodeIdx = 0; nodeIdx < modelo->Nodes.size(); ++nodeIdx)
-    {
-        const auto& node = modelo->Nodes[nodeIdx];
-        if (node.pMesh == nullptr)
-            continue; // este nodo no tiene geometra
+    RecordGLTFModel(modelo, worldMatrix, isShadowPass, cascadeProj);
+    SubmitRenderQueue();
+}
 
-        // 3) Obtn su matrix mundo
-        const float4x4& world = transforms.NodeGlobalMatrices[nodeIdx] * worldMatrix;
+GLTFModelResources::SharedBindings Tutorial03_Texturing::GetConstantRingBindings() const
+{
+    GLTFModelResources::SharedBindings shared;
+    shared.pConstantRing      = m_ConstantRing.GetBuffer();
+    shared.ConstantsRangeSize = m_ConstantRing.GetAlignedSize(sizeof(ConstantsData));
+    shared.MaterialRangeSize  = m_ConstantRing.GetAlignedSize(sizeof(materialConstants));
+    return shared;
+}
 
-        // 4) Por cada primitiva dentro de ese mesh
-        for (const auto& prim : node.pMesh->Primitives)
-        {
-            // 5) Bind VB/IB
-            Uint64   offsets[] = {0};
-            IBuffer* pVB[]     = {modelo->GetVertexBuffer(0)};
-            m_pImmediateContext->SetVertexBuffers(
-                0, 1, pVB, offsets,
-                RESOURCE_STATE_TRANSITION_MODE_TRANSITION,
-                SET_VERTEX_BUFFERS_FLAG_RESET);
-            m_pImmediateContext->SetIndexBuffer(
-                modelo->GetIndexBuffer(), 0,
-                RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+GLTFModelResources& Tutorial03_Texturing::CreateGLTFResources(StaticModel* modelo)
+{
+    auto shared               = GetConstantRingBindings();
+    shared.pShadowMapSRV      = m_ShadowMapMgr.GetSRV();
+    shared.DefaultTextures    = {
+        {"g_Albedo", m_DefaultAlbedoTex->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE)},
+        {"g_NormalMap", m_DefaultNormalTex->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE)},
+    };
 
-            if (!isShadowPass)
-            {
-                m_pImmediateContext->SetPipelineState(m_pPSOGLTF);
-                // 6a) Actualiza constantes de cmara+world
-                ConstantsData cb{world,
-                                 m_Camera.GetViewMatrix() * m_Camera.GetProjMatrix(),
-                                 m_Camera.GetPos()};
-                {
-                    MapHelper<ConstantsData> helper(
-                        m_pImmediateContext,
-                        m_BufferConstantsObjects,
-                        MAP_WRITE, MAP_FLAG_DISCARD);
-                    *helper = cb;
-                }
+    auto& resources = m_GLTFResources[modelo];
+    resources.Create(*modelo, m_pPSOGLTF, m_pPSOGLTFInstanced, static_cast<Uint32>(m_GLTFResources.size() - 1),
+                     m_NextMaterialSortId, AttrToShaderName, shared);
+    return resources;
+}
 
-                materialConstants matCb{};
+const GLTFModelResources& Tutorial03_Texturing::GetGLTFResources(StaticModel* modelo)
+{
+    auto it = m_GLTFResources.find(modelo);
+    if (it != m_GLTFResources.end())
+        return it->second;
 
-                matCb.materialId = prim.MaterialId;
+    // Modelos cargados fuera de m_modelsGLTF (p.e. via RenderizarObjeto) se preparan al primer uso
+    return CreateGLTFResources(modelo);
+}
 
-				{
-					MapHelper<materialConstants> helper(
-						m_pImmediateContext,
-						m_MaterialAttribsCB,
-						MAP_WRITE, MAP_FLAG_DISCARD);
-					*helper = matCb;
-				}
+void Tutorial03_Texturing::RecordGLTFModel(StaticModel* modelo, const float4x4& worldMatrix, bool isShadowPass, const float4x4& cascadeProj)
+{
+    // Matrices globales de los nodos horneadas por el cooker: sin ComputeTransforms
+    const auto& resources = GetGLTFResources(modelo);
+    for (const auto& meshNode : modelo->GetMeshNodes())
+        RecordGLTFMeshNode(modelo, resources, *meshNode.pMesh, meshNode.GlobalMatrix * worldMatrix, 0, isShadowPass, cascadeProj);
+}
 
+void Tutorial03_Texturing::RecordGLTFInstance(StaticModel* modelo, const float4x4* pNodeWorlds, Uint32 lod, bool isShadowPass, const float4x4& cascadeProj)
+{
+    // Instancia estatica: world por nodo ya premultiplicado (TileScene::BakeObjectNodeWorlds)
+    const auto& resources = GetGLTFResources(modelo);
+    const auto& meshNodes = modelo->GetMeshNodes();
+    for (size_t i = 0; i < meshNodes.size(); ++i)
+        RecordGLTFMeshNode(modelo, resources, *meshNodes[i].pMesh, pNodeWorlds[i], lod, isShadowPass, cascadeProj);
+}
 
-                 // Constantes de intento de luz spot
-                {
-                    LightConstants cbDataL = {};
+void Tutorial03_Texturing::BakeTileObjectTransforms()
+{
+    m_TiledScene.BakeObjectNodeWorlds([](StaticModel* modelo) -> const std::vector<StaticModel::MeshNode>& {
+        return modelo->GetMeshNodes();
+    });
+    m_TiledScene.CreateObjectInstanceBuffer(m_pDevice);
+}
 
-                    cbDataL.g_LightPos      = m_LightCamera.GetPos();
-                    cbDataL.g_ViewProjLight = m_LightCamera.GetViewMatrix() * m_LightCamera.GetProjMatrix();
+void Tutorial03_Texturing::RecordTileObjects(const std::vector<Uint32>& objects, bool isShadowPass, const float4x4& cascadeProj)
+{
+    // Cada tramo de indices consecutivos del mismo modelo y LOD es un rango
+    // contiguo del instance buffer: un draw por primitiva y tramo
+    const auto& sceneObjects = m_TiledScene.Objects();
+    const auto& batches      = m_TiledScene.ObjectBatches();
 
+    size_t i = 0;
+    while (i < objects.size())
+    {
+        const Uint32 first   = objects[i];
+        const Uint32 batchId = sceneObjects[first].BatchId;
+        const Uint32 lod     = isShadowPass ? GetShadowCasterLod(first, cascadeProj) : GetTileObjectLod(first, false);
 
-                    MapHelper<LightConstants> CBHelperL(m_pImmediateContext, m_BufferLightConstants, MAP_WRITE, MAP_FLAG_DISCARD);
-                    *CBHelperL = cbDataL;
-                }
+        size_t end = i + 1;
+        while (end < objects.size() && objects[end] == objects[end - 1] + 1 && sceneObjects[objects[end]].BatchId == batchId &&
+               (isShadowPass ? GetShadowCasterLod(objects[end], cascadeProj) : GetTileObjectLod(objects[end], false)) == lod)
+            ++end;
 
+        RecordTileObjectRun(batches[batchId], first, static_cast<Uint32>(end - i), lod, isShadowPass, cascadeProj);
+        i = end;
+    }
+}
 
-                // Luz direccional
-                {
-                    MapHelper<LightAttribs> CBHelperLightAttribs(m_pImmediateContext, m_LightAttribsCB, MAP_WRITE, MAP_FLAG_DISCARD);
-                    *CBHelperLightAttribs = m_LightAttribs;
-		        }
+void Tutorial03_Texturing::RecordTileObjectRun(const ObjectBatch& batch, Uint32 firstObject, Uint32 numObjects, Uint32 lod,
+                                               bool isShadowPass, const float4x4& cascadeProj)
+{
+    const auto& resources = GetGLTFResources(batch.pModel);
+    const auto& meshNodes = batch.pModel->GetMeshNodes();
 
-                 m_SRBGLTF->GetVariableByName(SHADER_TYPE_PIXEL, "g_ShadowMap")->Set(m_ShadowMapMgr.GetSRV(), SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
+    // Profundidad de la clave: la del primer placement del tramo
+    const auto&  firstWorld = m_TiledScene.Objects()[firstObject].World;
+    const Uint32 depth      = isShadowPass ? 0 :
+        RenderQueue::QuantizeDepth(length(float3(firstWorld._41, firstWorld._42, firstWorld._43) - m_Camera.GetPos()), RenderQueueMaxDepth);
 
+    // En sombra g_World no se usa: un bloque por tramo con la ViewProj de la cascada
+    const Uint32 shadowBlock = isShadowPass ? m_RenderQueue.AddConstants(ShadowConstantsData{cascadeProj, float4x4::Identity()}) : 0;
 
-                // 6b) Bindea las texturas del material de la primitiva
-                auto& mat = modelo->Materials[prim.MaterialId];
-                // Recorre slo los atributos de textura activos
-                for (Uint32 i = 0; i < modelo->GetNumTextureAttributes(); ++i)
-                {
-                    const auto&  texAttr = modelo->GetTextureAttribute(i);
-                    const Uint32 slot    = texAttr.Index; // <-- aqu, usa el Id, no "i"
-                    if (!mat.IsTextureAttribActive(slot))
-                        continue;
+    for (Uint32 n = 0; n < static_cast<Uint32>(meshNodes.size()); ++n)
+    {
+        const Uint32 firstInstance = batch.FirstInstance + n * batch.NumObjects + (firstObject - batch.FirstObject);
 
-                    int   texId   = mat.GetTextureId(slot);
-                    auto* pTex    = modelo->GetTexture(texId);
-                    auto* pTexSRV = pTex->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE);
+        for (const auto& prim : meshNodes[n].pMesh->Primitives)
+        {
+            const auto& range = prim.GetLod(lod);
+
+            DrawPacket packet;
+            packet.pVB           = batch.pModel->GetVertexBuffer();
+            packet.pIB           = batch.pModel->GetIndexBuffer();
+            packet.pInstanceVB   = m_TiledScene.GetObjectInstanceBuffer();
+            packet.FirstInstance = firstInstance;
+            packet.NumInstances  = numObjects;
+            packet.NumIndices    = range.IndexCount;
+            packet.FirstIndex    = range.FirstIndex;
+            packet.BaseVertex    = batch.pModel->GetBaseVertex();
 
-                    auto correctName = AttrToShaderName.at(texAttr.Name);
-                    //OutputDebugStringA((correctName + " Original Name: " + texAttr.Name + "\n").c_str());
+            if (!isShadowPass)
+            {
+                const auto& material = resources.GetMaterial(prim.MaterialId);
 
-                    m_SRBGLTF->GetVariableByName(
-                                 SHADER_TYPE_PIXEL, correctName.c_str())
-                        ->Set(pTexSRV, SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
-                }
+                packet.Key  = RenderQueue::MakeKey(RENDER_PASS_MAIN, SORT_PSO_GLTF_INSTANCED, material.SortId, resources.GetModelId(), depth);
+                packet.pPSO = m_pPSOGLTFInstanced;
+                packet.pSRB = material.InstancedSRB;
 
+                materialConstants matCb{};
+                matCb.materialId = prim.MaterialId;
 
-                // 6c) Commit y draw
-                m_pImmediateContext->CommitShaderResources(
-                    m_SRBGLTF, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+                packet.pDynamicVars[0]   = material.pInstancedMaterialVar;
+                packet.ConstantBlocks[0] = m_RenderQueue.AddConstants(matCb);
             }
             else
             {
-                // Pase de sombra: slo world + cascadeProj
-                ShadowConstantsData scb{world, cascadeProj};
-                {
-                    MapHelper<ShadowConstantsData> helper(
-                        m_pImmediateContext,
-                        m_ShadowMap->GetCB(),
-                        MAP_WRITE, MAP_FLAG_DISCARD);
-                    *helper = scb;
-                }
-                m_pImmediateContext->CommitShaderResources(
-                    m_ShadowMap->GetSRB(),
-                    RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+                packet.Key  = RenderQueue::MakeKey(RENDER_PASS_SHADOW, SORT_PSO_SHADOW_INSTANCED, 0, resources.GetModelId(), 0);
+                packet.pPSO = m_ShadowMap->GetInstancedPSO();
+                packet.pSRB = m_ShadowMap->GetInstancedSRB();
+
+                packet.pDynamicVars[0]   = m_ShadowMap->GetInstancedConstantsVar();
+                packet.ConstantBlocks[0] = shadowBlock;
             }
 
-            // 7) DrawIndexed
-            DrawIndexedAttribs drawAttrs;
-            drawAttrs.IndexType          = VT_UINT32;
-            drawAttrs.NumIndices         = prim.IndexCount;
-            drawAttrs.FirstIndexLocation = prim.FirstIndex;
-            drawAttrs.BaseVertex         = modelo->GetBaseVertex();
-            drawAttrs.Flags              = DRAW_FLAG_VERIFY_ALL;
-            m_pImmediateContext->DrawIndexed(drawAttrs);
+            m_RenderQueue.Push(packet);
         }
     }
 }
 
+void Tutorial03_Texturing::RecordGLTFMeshNode(StaticModel* modelo, const GLTFModelResources& resources, const StaticModel::Mesh& mesh,
+                                              const float4x4& world, Uint32 lod, bool isShadowPass, const float4x4& cascadeProj)
+{
+    // Orden de cerca a lejos dentro del mismo estado (solo pase principal)
+    const Uint32 depth = isShadowPass ? 0 :
+        RenderQueue::QuantizeDepth(length(float3(world._41, world._42, world._43) - m_Camera.GetPos()), RenderQueueMaxDepth);
+
+    for (const auto& prim : mesh.Primitives)
+    {
+        const auto& range = prim.GetLod(lod);
+
+        DrawPacket packet;
+        packet.pVB        = modelo->GetVertexBuffer();
+        packet.pIB        = modelo->GetIndexBuffer();
+        packet.NumIndices = range.IndexCount;
+        packet.FirstIndex = range.FirstIndex;
+        packet.BaseVertex = modelo->GetBaseVertex();
+
+        if (!isShadowPass)
+        {
+            const auto& material = resources.GetMaterial(prim.MaterialId);
+
+            packet.Key  = RenderQueue::MakeKey(RENDER_PASS_MAIN, SORT_PSO_GLTF, material.SortId, resources.GetModelId(), depth);
+            packet.pPSO = m_pPSOGLTF;
+            packet.pSRB = material.SRB;
+
+            materialConstants matCb{};
+            matCb.materialId = prim.MaterialId;
+
+            packet.pDynamicVars[0]   = material.pConstantsVar;
+            packet.ConstantBlocks[0] = m_RenderQueue.AddConstants(ConstantsData{world});
+            packet.pDynamicVars[1]   = material.pMaterialVar;
+            packet.ConstantBlocks[1] = m_RenderQueue.AddConstants(matCb);
+        }
+        else
+        {
+            // Pase de sombra: solo cascadeProj + world, sin texturas
+            packet.Key  = RenderQueue::MakeKey(RENDER_PASS_SHADOW, SORT_PSO_SHADOW, 0, resources.GetModelId(), 0);
+            packet.pPSO = m_ShadowMap->GetShadowPSO();
+            packet.pSRB = m_ShadowMap->GetSRB();
+
+            packet.pDynamicVars[0]   = m_ShadowMap->GetConstantsVar();
+            packet.ConstantBlocks[0] = m_RenderQueue.AddConstants(ShadowConstantsData{cascadeProj, world});
+        }
 
+        m_RenderQueue.Push(packet);
+    }
+}
 
+void Tutorial03_Texturing::SubmitRenderQueue()
+{
+    m_RenderQueue.Sort();
+    m_RenderQueue.Submit(m_pImmediateContext, m_ConstantRing);
+    m_RenderQueue.Reset();
+}
 void Tutorial03_Texturing::WindowResize(Uint32 Width, Uint32 Height)
 {
     if (Width == 0 || Height == 0)
@@ -1818,7 +2349,11 @@ void Tutorial03_Texturing::Update(double CurrTime, double ElapsedTime)
     SampleBase::Update(CurrTime, ElapsedTime);
     UpdateUI();
 
+    // Modelos que terminaron de parsearse en segundo plano
+    PumpModelLoads();
+
     m_Camera.Update(m_InputController, static_cast<float>(ElapsedTime));
+    SelectTileObjectLods();
 
     ShadowMapManager::DistributeCascadeInfo DistrInfo;
     DistrInfo.pCameraView   = &m_Camera.GetViewMatrix();
@@ -1919,7 +2454,12 @@ void Tutorial03_Texturing::CreatePipelineStateGLTF() {
     // converted from linear to gamma space by the GPU. However, some platforms (e.g. Android in GLES mode,
     // or Emscripten in WebGL mode) do not support gamma-correction. In this case the application
     // has to do the conversion manually.
-    ShaderMacro Macros[] = {{"CONVERT_PS_OUTPUT_TO_GAMMA", m_ConvertPSOutputToGamma ? "1" : "0"}};
+    // COMPACT_VERTEX: el VS lee el vertice cuantizado del pool (VertexDecode.fxh)
+    const MESH_VERTEX_FORMAT VertexFormat  = m_GeometryPool.GetVertexFormat();
+    const char*              CompactVertex = VertexFormat == MESH_VERTEX_FORMAT_COMPACT ? "1" : "0";
+
+    ShaderMacro Macros[] = {{"CONVERT_PS_OUTPUT_TO_GAMMA", m_ConvertPSOutputToGamma ? "1" : "0"},
+                            {"COMPACT_VERTEX", CompactVertex}};
     ShaderCI.Macros      = {Macros, _countof(Macros)};
 
     // Create a shader source stream factory to load shaders from files.
@@ -1974,6 +2514,7 @@ void Tutorial03_Texturing::CreatePipelineStateGLTF() {
         //Attribute 2- normal
     };
     // clang-format on
+    VertexQuantizer::WriteVertexLayout(VertexFormat, LayoutElems);
 
     PSOCreateInfo.pVS = pVS;
     PSOCreateInfo.pPS = pPS;
@@ -1993,13 +2534,14 @@ void Tutorial03_Texturing::CreatePipelineStateGLTF() {
         {SHADER_TYPE_PIXEL, "g_HeightMap", SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
         {SHADER_TYPE_PIXEL, "g_NormalMap", SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
         {SHADER_TYPE_PIXEL, "g_ShadowMap", SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
-        {SHADER_TYPE_VERTEX, "Constants", SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
-        {SHADER_TYPE_VERTEX, "LightConstants", SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {SHADER_TYPE_VERTEX, "Constants", SHADER_RESOURCE_VARIABLE_TYPE_DYNAMIC},
+        {SHADER_TYPE_VERTEX, "FrameConstants", SHADER_RESOURCE_VARIABLE_TYPE_STATIC},
+        {SHADER_TYPE_VERTEX, "LightConstants", SHADER_RESOURCE_VARIABLE_TYPE_STATIC},
         {SHADER_TYPE_PIXEL, "cbPOM", SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
-        {SHADER_TYPE_PIXEL, "cbLightAttribs", SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
-        {SHADER_TYPE_VERTEX, "cbLightAttribs", SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
-        {SHADER_TYPE_PIXEL, "parallaxConstants", SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
-        {SHADER_TYPE_PIXEL, "materialConstants", SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {SHADER_TYPE_PIXEL, "cbLightAttribs", SHADER_RESOURCE_VARIABLE_TYPE_STATIC},
+        {SHADER_TYPE_VERTEX, "cbLightAttribs", SHADER_RESOURCE_VARIABLE_TYPE_STATIC},
+        {SHADER_TYPE_PIXEL, "parallaxConstants", SHADER_RESOURCE_VARIABLE_TYPE_STATIC},
+        {SHADER_TYPE_PIXEL, "materialConstants", SHADER_RESOURCE_VARIABLE_TYPE_DYNAMIC},
 
         //{SHADER_TYPE_PIXEL, (m_ShadowSettings.iShadowMode==SHADOW_MODE_PCF ? "g_tex2DShadowMap" : "g_tex2DFilterableShadowMap"), SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE}
 
@@ -2037,31 +2579,59 @@ void Tutorial03_Texturing::CreatePipelineStateGLTF() {
     PSOCreateInfo.PSODesc.ResourceLayout.NumImmutableSamplers = _countof(ImtblSamplers);
 
     m_pDevice->CreateGraphicsPipelineState(PSOCreateInfo, &m_pPSOGLTF);
+    BindFrameConstants(m_pPSOGLTF);
+
+    // Variante instanciada para los props de TileScene: mismo PS y estado, la
+    // matriz de mundo de cada placement llega por instancia en el slot 1
+    {
+        ShaderMacro InstancedMacros[] = {{"CONVERT_PS_OUTPUT_TO_GAMMA", m_ConvertPSOutputToGamma ? "1" : "0"},
+                                         {"COMPACT_VERTEX", CompactVertex},
+                                         {"TILE_INSTANCED", "1"}};
+        ShaderCI.Macros               = {InstancedMacros, _countof(InstancedMacros)};
+        ShaderCI.Desc.ShaderType      = SHADER_TYPE_VERTEX;
+        ShaderCI.EntryPoint           = "main";
+        ShaderCI.Desc.Name            = "GLTF instanced VS";
+        ShaderCI.FilePath             = "cube.vsh";
+        RefCntAutoPtr<IShader> pInstancedVS;
+        m_pDevice->CreateShader(ShaderCI, &pInstancedVS);
+
+        constexpr Uint32 InstanceStride = sizeof(float4x4);
+
+        // clang-format off
+        LayoutElement InstancedLayoutElems[] =
+        {
+            LayoutElement{0, 0, 3, VT_FLOAT32, False},
+            LayoutElement{1, 0, 3, VT_FLOAT32, False},
+            LayoutElement{2, 0, 2, VT_FLOAT32, False},
+            LayoutElement{3, 0, 4, VT_FLOAT32, False},
+            // Attributes 4..7 - filas de la matriz de mundo (TileScene prop instance buffer)
+            LayoutElement{4, 1, 4, VT_FLOAT32, False, LAYOUT_ELEMENT_AUTO_OFFSET, InstanceStride, INPUT_ELEMENT_FREQUENCY_PER_INSTANCE},
+            LayoutElement{5, 1, 4, VT_FLOAT32, False, LAYOUT_ELEMENT_AUTO_OFFSET, InstanceStride, INPUT_ELEMENT_FREQUENCY_PER_INSTANCE},
+            LayoutElement{6, 1, 4, VT_FLOAT32, False, LAYOUT_ELEMENT_AUTO_OFFSET, InstanceStride, INPUT_ELEMENT_FREQUENCY_PER_INSTANCE},
+            LayoutElement{7, 1, 4, VT_FLOAT32, False, LAYOUT_ELEMENT_AUTO_OFFSET, InstanceStride, INPUT_ELEMENT_FREQUENCY_PER_INSTANCE},
+        };
+        // clang-format on
+        VertexQuantizer::WriteVertexLayout(VertexFormat, InstancedLayoutElems);
+
+        PSOCreateInfo.PSODesc.Name                                = "GLTF instanced PSO";
+        PSOCreateInfo.pVS                                         = pInstancedVS;
+        PSOCreateInfo.GraphicsPipeline.InputLayout.LayoutElements = InstancedLayoutElems;
+        PSOCreateInfo.GraphicsPipeline.InputLayout.NumElements    = _countof(InstancedLayoutElems);
+        m_pDevice->CreateGraphicsPipelineState(PSOCreateInfo, &m_pPSOGLTFInstanced);
+
+        // Sin Constants: los SRB por material los crea GLTFModelResources
+        BindFrameConstants(m_pPSOGLTFInstanced);
+    }
 
     // Since we did not explicitly specify the type for 'Constants' variable, default
     // type (SHADER_RESOURCE_VARIABLE_TYPE_STATIC) will be used. Static variables
     // never change and are bound directly through the pipeline state object.
     //m_pPSO->GetStaticVariableByName(SHADER_TYPE_VERTEX, "Constants")->Set(m_VSConstants);
 
-    // Since we are using mutable variable, we must create a shader resource binding object
-    // http://diligentgraphics.com/2016/03/23/resource-binding-model-in-diligent-engine-2-0/
-    m_pPSOGLTF->CreateShaderResourceBinding(&m_SRBGLTF, true);
-
-    BufferDesc CBDesc;
-    CBDesc.Name           = "GLTF Constants objects";
-    CBDesc.Size           = sizeof(materialConstants);
-    CBDesc.Usage          = USAGE_DYNAMIC;
-    CBDesc.BindFlags      = BIND_UNIFORM_BUFFER;
-    CBDesc.CPUAccessFlags = CPU_ACCESS_WRITE;
-    m_pDevice->CreateBuffer(CBDesc, nullptr, &m_MaterialAttribsCB);
-    m_SRBGLTF->GetVariableByName(SHADER_TYPE_PIXEL, "materialConstants")->Set(m_MaterialAttribsCB);
-    m_SRBGLTF->GetVariableByName(SHADER_TYPE_VERTEX, "Constants")->Set(m_BufferConstantsObjects);
-    m_SRBGLTF->GetVariableByName(SHADER_TYPE_VERTEX, "LightConstants")->Set(m_BufferLightConstants);
-    m_SRBGLTF->GetVariableByName(SHADER_TYPE_PIXEL, "cbLightAttribs")->Set(m_LightAttribsCB);
-    m_SRBGLTF->GetVariableByName(SHADER_TYPE_VERTEX, "cbLightAttribs")->Set(m_LightAttribsCB);
-    //m_SRBGLTF->GetVariableByName(SHADER_TYPE_PIXEL, "cbPOM")->Set(m_ParallaxAttribsCB);
-    //m_SRBGLTF->GetVariableByName(SHADER_TYPE_PIXEL, "parallaxConstants")->Set(m_ParallaxAttribsCB);
-    m_SRBGLTF->GetVariableByName(SHADER_TYPE_PIXEL, "g_ShadowMap")->Set(m_ShadowMapMgr.GetSRV());
+    // Los SRB se crean por material al cargar cada modelo (CreateGLTFResources).
+    // Estas texturas cubren los atributos que un material no trae.
+    m_DefaultAlbedoTex = GLTFModelResources::CreateSolidTexture(m_pDevice, "GLTF default albedo", 0xFFFFFFFF);
+    m_DefaultNormalTex = GLTFModelResources::CreateSolidTexture(m_pDevice, "GLTF default normal", 0xFFFF8080);
 
 
 
@@ -2174,12 +2744,181 @@ void Tutorial03_Texturing::UpdateUI()
         SelectMaterial(m_POMNames[wallIdx], m_pWallMat);
     }
 
+    // cbPOM solo se vuelve a subir cuando el valor cambia (ver POMMaterial::Upload)
+    float floorHeight = m_pFloorMat->GetHeightScale();
+    if (ImGui::SliderFloat("Floor height scale", &floorHeight, 0.0f, 0.2f))
+        m_pFloorMat->SetHeightScale(floorHeight);
+    float wallHeight = m_pWallMat->GetHeightScale();
+    if (ImGui::SliderFloat("Wall height scale", &wallHeight, 0.0f, 0.2f))
+        m_pWallMat->SetHeightScale(wallHeight);
+    ImGui::Text("cbPOM version: floor %u, wall %u", m_pFloorMat->GetVersion(), m_pWallMat->GetVersion());
+
     // ---------------- PARALLAX -------------------------------
     ImGui::Separator();
     ImGui::Text("Parallax settings");
     ImGui::SliderFloat("Height", &m_ParallaxAttribs.generalHeightScale, 0.0f, 1.0f);
     ImGui::SliderInt("Mode", &m_ParallaxAttribs.parallaxMode, 0, 2);
 
+    // ---------------- TILES: loop vs instanciado -------------
+    ImGui::Separator();
+    ImGui::Checkbox("Instanced tiles", &m_UseInstancedTiles);
+    ImGui::Checkbox("Chunk frustum culling", &m_CullTiles);
+    ImGui::Text("Chunks: %u / %u visible, objects %u / %u, %.3f ms cull", m_CullStats.VisibleChunks, m_CullStats.TotalChunks,
+                m_CullStats.VisibleObjects, static_cast<Uint32>(m_TiledScene.Objects().size()), m_CullStats.CullTimeMs);
+    if (ImGui::Button("Culling benchmark 512x512"))
+        RunCullingBenchmark();
+    ImGui::Checkbox("Cull shadow casters per cascade", &m_CullShadowCasters);
+    ImGui::Checkbox("Static shadow cache", &m_UseStaticShadowCache);
+    ImGui::Checkbox("Instanced props (per model)", &m_UseInstancedProps);
+    // La cache de sombras estaticas se dibujo con estos umbrales: si cambian, redibujar
+    bool lodSettingsChanged = ImGui::Checkbox("Prop LODs (screen size)", &m_UseLods);
+    if (m_UseLods)
+    {
+        // Distancia equivalente para una esfera de radio 1
+        const float projY = m_Camera.GetProjMatrix()._22;
+        for (Uint32 l = 0; l + 1 < CookedMaxLods; ++l)
+        {
+            const std::string label = "LOD" + std::to_string(l + 1) + " below screen size";
+            lodSettingsChanged |= ImGui::SliderFloat(label.c_str(), &m_LodScreenSize[l], 0.005f, 0.5f, "%.3f");
+            ImGui::SameLine();
+            ImGui::Text("(%.1f m for r = 1)", projY / (std::max)(m_LodScreenSize[l], 1e-4f));
+        }
+        lodSettingsChanged |= ImGui::SliderInt("Shadow LOD bias", &m_ShadowLodBias, 0, static_cast<int>(CookedMaxLods) - 1);
+    }
+    if (lodSettingsChanged)
+        InvalidateStaticShadowCache();
+    ImGui::Text("Prop LODs: %u / %u / %u / %u objects, %.1fk of %.1fk tris", m_LodStats.Objects[0], m_LodStats.Objects[1],
+                m_LodStats.Objects[2], m_LodStats.Objects[3], m_LodStats.Triangles / 1000.0, m_LodStats.TrianglesLod0 / 1000.0);
+    ImGui::Checkbox("Prop impostors", &m_UseImpostors);
+    if (m_UseImpostors)
+        ImGui::SliderFloat("Impostor distance", &m_ImpostorDistance, 5.0f, 100.0f, "%.1f m");
+    const auto& impostorStats = m_Impostors.GetStats();
+    ImGui::Text("Impostors: %u objects (%u visible, %u draws), atlas %u / %u slices, %u full, bake %.1f ms", m_LodStats.Impostors,
+                static_cast<Uint32>(m_ImpostorInstances.size()), m_ImpostorDraws, m_Impostors.GetNumSlicesUsed(), ImpostorAtlas::MaxSlices,
+                impostorStats.Failed, impostorStats.BakeMs);
+    const auto& loadStats = m_ModelLoader.GetStats();
+    ImGui::Text("Models: %u / %u ready, %u failed, %u placeholders, %u threads", loadStats.Ready, loadStats.Requested, loadStats.Failed,
+                m_TiledScene.NumPlaceholders(), m_ModelLoader.GetNumThreads());
+    ImGui::Text("Map references %u models, %u resident", static_cast<Uint32>(m_ReferencedModels.size()),
+                static_cast<Uint32>(m_modelsGLTF.size()));
+    ImGui::Text("Model uploads: %u last call, %.2f ms", loadStats.LastUploads, loadStats.LastUploadMs);
+    ImGui::SliderFloat("Upload budget (ms)", &m_ModelUploadBudgetMs, 0.5f, 16.0f);
+    ImGui::Text("Model cache: %u warm (%.1f ms), %u cooked (%.1f ms), create %.1f ms", loadStats.CacheHits, loadStats.CacheMs,
+                loadStats.Cooked, loadStats.CookMs, loadStats.CreateMs);
+    if (m_ModelLoadMs > 0.0)
+        ImGui::Text("Startup model load: %.1f ms", m_ModelLoadMs);
+    ImGui::Text("Startup graph: %.1f ms (serial %.1f ms, critical path %.1f ms)", m_StartupReport.WallMs, m_StartupReport.SerialMs,
+                m_StartupReport.CriticalPathMs);
+    for (const auto& node : m_StartupReport.Nodes)
+        ImGui::Text("%s %s: %.1f ms at %.1f ms%s", node.Critical ? "*" : " ", node.Name.c_str(), node.DurationMs, node.StartMs,
+                    node.MainThread ? " [main]" : "");
+    if (ImGui::Button("Model cache benchmark"))
+        RunModelCacheBenchmark();
+    if (m_ModelCacheBench.Valid)
+    {
+        ImGui::Text("Bench %u models: GLTF %.1f ms, cook %.1f ms | warm %.1f + create %.1f ms, %.1f MB", m_ModelCacheBench.NumModels,
+                    m_ModelCacheBench.GLTFParseMs, m_ModelCacheBench.CookMs, m_ModelCacheBench.WarmOpenMs, m_ModelCacheBench.CreateMs,
+                    m_ModelCacheBench.CacheBytes / (1024.0 * 1024.0));
+    }
+    if (ImGui::Button("Dungeon benchmark 64..8192"))
+        RunDungeonBenchmark();
+    for (const auto& bench : m_DungeonBench)
+        ImGui::Text("Dungeon %dx%d: %.2f ms (%.1f MB), %u threads %.2f ms, 2-bit %.2f ms (%.1f MB), %.1f%% floor%s", bench.Size, bench.Size,
+                    bench.Ms, bench.GridMB, m_DungeonBenchThreads, bench.ParallelMs, bench.PackedMs, bench.PackedMB, bench.FloorPc,
+                    bench.Match ? "" : " MISMATCH");
+    if (!m_DungeonBench.empty())
+    {
+        const auto& largest = m_DungeonBench.back();
+        ImGui::Text("Dungeon BSP %dx%d: %u nodes in %u allocations (%u with one new per node and room)", largest.Size, largest.Size,
+                    static_cast<Uint32>(largest.Nodes), static_cast<Uint32>(largest.TreeAllocs), static_cast<Uint32>(largest.OldAllocs));
+    }
+    ImGui::Text("Props: %u models, %u placements", static_cast<Uint32>(m_TiledScene.ObjectBatches().size()),
+                static_cast<Uint32>(m_TiledScene.Objects().size()));
+    ImGui::Text("Static shadows: %u cascades redrawn, %u from cache", m_ShadowCacheStats.CascadesRendered,
+                m_ShadowCacheStats.CascadesCached);
+    ImGui::Text("Shadow casters: %u candidates, %.3f ms build", m_ShadowCasterStats.Candidates, m_ShadowCasterStats.BuildTimeMs);
+    for (size_t c = 0; c < m_CascadeCasters.size(); ++c)
+    {
+        ImGui::Text("  Cascade %d: %u objects, %u tile objects", static_cast<int>(c),
+                    static_cast<Uint32>(m_CascadeCasters[c].Objetos.size()), static_cast<Uint32>(m_CascadeCasters[c].TileObjects.size()));
+    }
+    if (m_CullBench.Valid)
+    {
+        ImGui::Text("Bench: %u / %u chunks, SSE %.2f us, scalar %.2f us%s", m_CullBench.VisibleChunks, m_CullBench.NumChunks,
+                    m_CullBench.SIMDTimeUs, m_CullBench.ScalarTimeUs, m_CullBench.Match ? "" : " MISMATCH");
+    }
+    if (m_MaterialArray.IsValid())
+    {
+        ImGui::Checkbox("Material array (1 draw)", &m_UseMaterialArray);
+        ImGui::Text("Material array: %u slices, floor %d, wall %d", m_MaterialArray.GetNumSlices(),
+                    m_MaterialArray.GetSlice(m_pFloorMat), m_MaterialArray.GetSlice(m_pWallMat));
+    }
+    ImGui::Text("Per-tile loop: %u draws, %.3f ms CPU", m_TileStats[0].DrawCalls, m_TileStats[0].CPUTimeMs);
+    ImGui::Text("Instanced:     %u draws, %.3f ms CPU", m_TileStats[1].DrawCalls, m_TileStats[1].CPUTimeMs);
+
+    // ---------------- SUBIDA DE CONSTANTES -------------------
+    ImGui::Separator();
+    const auto& ringStats = m_ConstantRing.GetLastFrameStats();
+    ImGui::Text("Frame CBs: %u maps, %llu bytes", m_LastFrameCBStats.MapCalls,
+                static_cast<unsigned long long>(m_LastFrameCBStats.BytesUploaded));
+    ImGui::Text("Draw ring: %u maps, %llu bytes, %u wraps, %llu KB", ringStats.MapCalls,
+                static_cast<unsigned long long>(ringStats.BytesUploaded), ringStats.Wraps,
+                static_cast<unsigned long long>(m_ConstantRing.GetSize() / 1024));
+
+    // ---------------- POOL DE GEOMETRIA ----------------------
+    ImGui::Separator();
+    const auto& poolStats = m_GeometryPool.GetStats();
+    ImGui::Text("Geometry pool: %u meshes (%u shared), VB %u / %u verts, IB %u / %u indices", poolStats.Allocations,
+                poolStats.SharedHits, m_GeometryPool.GetUsedVertices(), m_GeometryPool.GetVertexCapacity(),
+                m_GeometryPool.GetUsedIndices(), m_GeometryPool.GetIndexCapacity());
+    ImGui::Text("  %u grows, %u free blocks, %.1f MB uploaded", poolStats.Grows, poolStats.FreeBlocks,
+                poolStats.UploadedBytes / (1024.0 * 1024.0));
+    if (m_GeometryPool.GetVertexFormat() == MESH_VERTEX_FORMAT_COMPACT)
+    {
+        // Cada malla se decodifica al subirla y se compara con sus vertices float
+        const auto& quant = poolStats.Quantization;
+        ImGui::Text("  Compact vertices (%u B): %.2f MB vs %.2f MB float", m_GeometryPool.GetGPUVertexStride(),
+                    m_GeometryPool.GetUsedVertices() * double{m_GeometryPool.GetGPUVertexStride()} / (1024.0 * 1024.0),
+                    m_GeometryPool.GetUsedVertices() * double{GeometryPool::VertexStride} / (1024.0 * 1024.0));
+        ImGui::Text("  Max error over %u verts: pos %.1e, normal %.4f deg, tangent %.4f deg, uv %.1e, %u sign", quant.NumVertices,
+                    quant.MaxPosError, quant.MaxNormalDeg, quant.MaxTangentDeg, quant.MaxUVError, quant.SignErrors);
+        if (poolStats.QuantizationFailures > 0)
+            ImGui::Text("  %u meshes OUT OF TOLERANCE", poolStats.QuantizationFailures);
+    }
+    else
+    {
+        ImGui::Text("  Float vertices (%u B)", m_GeometryPool.GetGPUVertexStride());
+    }
+
+    // ---------------- MESH OPTIMIZER ------------------------
+    ImGui::Separator();
+    ImGui::Text("Mesh optimizer (FIFO %u): LOD0..3 tris, ACMR / ATVR / overfetch gltf -> cooked", MeshOptimizer::CacheSize);
+    std::string toggledModel;
+    for (const auto& par : m_modelsGLTF)
+    {
+        const auto& cook      = par.second->GetCookStats();
+        bool        optimized = m_UnoptimizedModels.count(par.first) == 0;
+        if (ImGui::Checkbox(par.first.c_str(), &optimized))
+            toggledModel = par.first;
+        ImGui::SameLine();
+        ImGui::Text("%u/%u/%u/%u tris: %.3f -> %.3f / %.2f -> %.2f / %.2fx -> %.2fx, %u clusters", cook.LodTriangles[0],
+                    cook.LodTriangles[1], cook.LodTriangles[2], cook.LodTriangles[3], cook.AcmrBefore, cook.AcmrAfter, cook.AtvrBefore,
+                    cook.AtvrAfter, cook.OverfetchBefore, cook.OverfetchAfter, cook.NumClusters);
+    }
+    // Fuera del bucle: recargar borra el modelo de m_modelsGLTF
+    if (!toggledModel.empty())
+        SetModelOptimized(toggledModel, m_UnoptimizedModels.count(toggledModel) != 0);
+
+    // ---------------- COLA DE DRAWS (GLTF) -------------------
+    ImGui::Separator();
+    const char* passNames[] = {"Shadow", "Main"};
+    for (Uint32 pass = RENDER_PASS_SHADOW; pass <= RENDER_PASS_MAIN; ++pass)
+    {
+        const auto& qs = m_RenderQueue.GetLastFrameStats(pass);
+        ImGui::Text("%-6s %u draws (%u inst) | PSO %u VB %u IB %u SRB %u", passNames[pass],
+                    qs.Draws, qs.Instances, qs.PSOChanges, qs.VBChanges, qs.IBChanges, qs.SRBCommits);
+    }
+
     ImGui::End();
 }
 
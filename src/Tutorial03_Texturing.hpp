@@ -30,11 +30,15 @@
 #include "SampleBase.hpp"
 #include "BasicMath.hpp"
 #include "FirstPersonCamera.hpp"
+#include "MapHelper.hpp"
 #include "Cubo.h"
 #include "POMMaterial.h"
+#include "POMMaterialArray.h"
 #include "ShadowMap.h"
 #include "FigureBase.h"
 #include <vector>
+#include <unordered_set>
+#include <chrono>
 #include "ShadowMapManager.hpp"
 #include "BasicStructures.fxh"
 #include "Utilities/interface/DiligentFXShaderSourceStreamFactory.hpp"
@@ -45,6 +49,13 @@
 #include "DungeonScene.h"
 #include "TiledMap.h"
 #include "TiledScene.h"
+#include "DynamicUploadRing.h"
+#include "RenderQueue.h"
+#include "GLTFModelResources.h"
+#include "AsyncModelLoader.h"
+#include "GeometryPool.h"
+#include "ImpostorAtlas.h"
+#include "TaskGraph.h"
 
 
 
@@ -52,11 +63,18 @@
 
 namespace Diligent
 {
+// Por draw (cbuffer Constants): se sub-asigna del anillo de constantes
 struct ConstantsData
 {
     float4x4 g_World;
+};
+
+// Por frame (cbuffer FrameConstants)
+struct FrameConstantsData
+{
     float4x4 g_ViewProj;
     float3 g_CameraPos;
+    float  _fPad;
     //float4x4 g_LightViewProj;
 };
 
@@ -103,7 +121,7 @@ public:
 
 private:
     void RenderizarObjeto(Objeto3D* objeto, bool isShadowPass, float4x4 cascadeProj = float4x4::Translation(float3(0.0f,0.0f,0.0f)));
-    void RenderizarObjeto(GLTF::Model* objeto, bool isShadowPass, float4x4 cascadeproj = float4x4::Translation(float3(0.0f, 0.0f, 0.0f)), float4x4 worldMatrix = float4x4::Translation(float3(0.0f, 0.0f, 0.0f)));
+    void RenderizarObjeto(StaticModel* objeto, bool isShadowPass, float4x4 cascadeproj = float4x4::Translation(float3(0.0f, 0.0f, 0.0f)), float4x4 worldMatrix = float4x4::Translation(float3(0.0f, 0.0f, 0.0f)));
     void RenderizarDungeon();
     void CreatePipelineState();
     void CreateVertexBuffer();
@@ -114,11 +132,82 @@ private:
     void UpdateUI();
     void InitializeScene();
     void LoadMaterials();
+    std::vector<TaskGraph::NodeId> AddMaterialLoadTasks(TaskGraph& graph);
+    void LoadTiledMap(const std::string& mapaEscena);
     void CreatePipelineStateGLTF();
     void InitializeTileScene();
-    void RenderizarTileScene(bool isShadowPass, float4x4 cascadeProj = float4x4::Translation(float3(0.0f, 0.0f, 0.0f)));
+    void RenderizarTileScene(bool isShadowPass, float4x4 cascadeProj = float4x4::Translation(float3(0.0f, 0.0f, 0.0f)),
+                             const std::vector<Uint32>* pCasterObjects = nullptr);
+    void BuildShadowCasterLists(const std::vector<float4x4>& cascadeViewProj);
+    void EnsureStaticShadowCache(Uint32 numCascades);
+    void UpdateStaticShadowCascade(Uint32 iCascade, const float4x4& cascadeViewProj, const std::vector<Uint32>& tileObjects);
+    void InvalidateStaticShadowCache() { m_StaticShadowValid.assign(m_StaticShadowValid.size(), false); }
+    void RenderizarTilesInstanced();
+    void CreateMaterialArray();
+    void CullTileScene();
+    void SelectTileObjectLods();
+    Uint32 GetTileObjectLod(Uint32 objectIdx, bool isShadowPass) const;
+    // LOD de un caster en un pase de sombra: el de la camara o, al dibujar la
+    // cache estatica, uno que solo depende de la cascada
+    Uint32 GetShadowCasterLod(Uint32 objectIdx, const float4x4& cascadeViewProj) const;
+    void CollectVisibleTileRanges(bool mergeMaterials);
+    void RunCullingBenchmark();
+    void RunDungeonBenchmark();
+    void UploadFrameConstants();
+    void BindFrameConstants(IPipelineState* pPSO);
+    // Vuelve a enlazar el anillo de constantes por draw tras recrearlo
+    void BindConstantRing();
+
+    // Solo los campos del anillo; CreateGLTFResources completa el resto
+    GLTFModelResources::SharedBindings GetConstantRingBindings() const;
+
+    // Materiales POM: SRB propio por PSO, commit solo al cambiar de material
+    void         PrepareMaterialSRBs(POMMaterial* pMat);
+    POMMaterial* GetTileMaterial(Uint32 materialId) const;
+    void         BindPOMMaterial(POMMaterial* pMat, const float4x4& world, IShaderResourceBinding*& pLastSRB);
+
+    // Cola de draws GLTF: un SRB por material, creado al cargar el modelo
+    GLTFModelResources&       CreateGLTFResources(StaticModel* modelo);
+    const GLTFModelResources& GetGLTFResources(StaticModel* modelo);
+    void                      RecordGLTFModel(StaticModel* modelo, const float4x4& worldMatrix, bool isShadowPass, const float4x4& cascadeProj);
+    void                      RecordGLTFInstance(StaticModel* modelo, const float4x4* pNodeWorlds, Uint32 lod, bool isShadowPass, const float4x4& cascadeProj);
+    void                      RecordGLTFMeshNode(StaticModel* modelo, const GLTFModelResources& resources, const StaticModel::Mesh& mesh,
+                                                 const float4x4& world, Uint32 lod, bool isShadowPass, const float4x4& cascadeProj);
+    void                      BakeTileObjectTransforms();
+    void                      SubmitRenderQueue();
+
+    // Props de TileScene instanciados por modelo: objects es una lista
+    // creciente de indices en m_TiledScene.Objects(); un tramo comparte LOD
+    void RecordTileObjects(const std::vector<Uint32>& objects, bool isShadowPass, const float4x4& cascadeProj);
+    void RecordTileObjectRun(const ObjectBatch& batch, Uint32 firstObject, Uint32 numObjects, Uint32 lod, bool isShadowPass,
+                             const float4x4& cascadeProj);
+
+    // Impostores: bake de los modelos recien cargados (tras el Flush del pool)
+    // y separacion de los objetos lejanos de la lista del pase principal
+    void BakePendingImpostors();
+    void ReleaseModelImpostor(StaticModel* modelo);
+    void CollectImpostors(std::vector<Uint32>& objects);
+
+    template <typename T>
+    void WriteFrameConstants(IBuffer* pCB, const T& Data)
+    {
+        MapHelper<T> CBHelper(m_pImmediateContext, pCB, MAP_WRITE, MAP_FLAG_DISCARD);
+        *CBHelper = Data;
+        ++m_FrameCBStats.MapCalls;
+        m_FrameCBStats.BytesUploaded += sizeof(T);
+    }
     void ReConstruirTileScene(std::string mapaEscena = "mapaMazmorra.json");
 
+    // TileScene a partir de m_TiledMap y de los modelos cargados hasta ahora
+    std::unordered_map<std::string, StaticModel*> BuildTileModelLookup() const;
+    void                                          RebuildTileSceneObjects();
+    void                                          PumpModelLoads();
+    void                                          RequestReferencedModels();
+    void                                          ReleaseUnreferencedModels();
+    void                                          RunModelCacheBenchmark();
+    ModelCookSettings                             GetModelCookSettings(const std::string& file) const;
+    void                                          SetModelOptimized(const std::string& file, bool optimize);
+
     // helper cmodo
     void SelectMaterial(const std::string& key, POMMaterial*& dst)
     {
@@ -131,10 +220,23 @@ private:
 
     RefCntAutoPtr<IPipelineState>         m_pPSO;
     RefCntAutoPtr<IPipelineState>         m_pPSOGLTF;
+    RefCntAutoPtr<IPipelineState>         m_pPSOGLTFInstanced; // props de TileScene, world por instancia
     RefCntAutoPtr<IBuffer>                m_VSConstants;
     RefCntAutoPtr<ITextureView>           m_TextureSRV;
     RefCntAutoPtr<IShaderResourceBinding> m_SRB;
-    RefCntAutoPtr<IShaderResourceBinding> m_SRBGLTF;
+    RefCntAutoPtr<IPipelineState>         m_pPSOTiles; // capa de tiles instanciada
+    RefCntAutoPtr<IPipelineState>         m_pPSOTilesArray; // tiles instanciados + MATERIAL_ARRAY
+    RefCntAutoPtr<IShaderResourceBinding> m_SRBTilesArray;  // unico SRB de toda la capa de tiles
+
+    // Catalogo en Texture2DArray: pisos y muros de cualquier material en un draw
+    struct TileMaterialMapData
+    {
+        Uint32 Slices[16] = {}; // MaterialId -> slice (uint4 g_TileMaterialSlices[4])
+    };
+    POMMaterialArray       m_MaterialArray;
+    RefCntAutoPtr<IBuffer> m_TileMaterialMapCB;
+    TileMaterialMapData    m_TileMaterialMap;
+    bool                   m_UseMaterialArray = true;
 
 
     POMMaterial* m_pFloorMat = nullptr; // textura usada cuando MaterialId == 0
@@ -145,17 +247,51 @@ private:
 
 
     float4x4                              m_WorldViewProjMatrix;
-    RefCntAutoPtr<IBuffer>                m_BufferConstantsObjects;
+    RefCntAutoPtr<IBuffer>                m_FrameConstantsCB;
     RefCntAutoPtr<IBuffer>                m_BufferLightConstants;
+
+    // Constantes por draw: sub-asignadas de un solo buffer dinamico. Tamano
+    // inicial; tras un frame que dio la vuelta crece a lo que ese frame uso
+    static constexpr Uint64      ConstantRingSize = 1 << 20;
+    DynamicUploadRing            m_ConstantRing;
+    DynamicUploadRing::FrameStats m_FrameCBStats;
+    DynamicUploadRing::FrameStats m_LastFrameCBStats;
+
+    // Geometria estatica de toda la escena (cubos, piso, modelos GLTF) en un
+    // VB y un IB compartidos. Declarado antes que cualquier malla: se destruye
+    // despues de todas las que le devuelven su rango
+    static constexpr Uint32 GeometryPoolVertices = 1 << 16; // capacidad inicial; crece al doble si hace falta
+    static constexpr Uint32 GeometryPoolIndices  = 1 << 18;
+    GeometryPool            m_GeometryPool;
+    // Vertices cuantizados en el pool (20 bytes en vez de 48). Se lee una vez
+    // en Initialize: el pool y los input layout de los PSO se crean con el
+    bool m_CompactVertices = true;
+
+    // Campos de la clave de orden de la cola (pase y PSO)
+    enum RenderPassId : Uint32
+    {
+        RENDER_PASS_SHADOW = 0,
+        RENDER_PASS_MAIN   = 1
+    };
+    enum SortPSOId : Uint32
+    {
+        SORT_PSO_SHADOW           = 0,
+        SORT_PSO_GLTF             = 1,
+        SORT_PSO_SHADOW_INSTANCED = 2,
+        SORT_PSO_GLTF_INSTANCED   = 3
+    };
+    static constexpr float RenderQueueMaxDepth = 500.0f; // distancia que cubre la parte de profundidad de la clave
+
+    RenderQueue                                                m_RenderQueue;
+    std::unordered_map<const StaticModel*, GLTFModelResources> m_GLTFResources;
+    Uint32                                                     m_NextMaterialSortId = 0;
+    RefCntAutoPtr<ITexture>                                    m_DefaultAlbedoTex;
+    RefCntAutoPtr<ITexture>                                    m_DefaultNormalTex;
+
     FirstPersonCamera                     m_Camera;
     FirstPersonCamera					 m_LightCamera;
     std::unique_ptr<Cubo>         m_Cubo;
     std::unique_ptr<Cubo>         m_Piso;
-    std::unique_ptr<GLTF::Model>         m_Barril;
-    std::unique_ptr<GLTF::Model>         m_Cage;
-    std::unique_ptr<GLTF::Model>         m_Skull;
-    std::unique_ptr<GLTF::Model>         m_Chest;
-    std::unique_ptr<GLTF::Model>         m_Cauldron;
     std::unordered_map<std::string, POMMaterial*> m_POMCatalog; 
     std::vector<std::string>                      m_POMNames;  
 
@@ -170,7 +306,6 @@ private:
     std::unique_ptr<POMMaterial>          m_DungeonFloor; // en tu .hpp
     std::unique_ptr<POMMaterial>          m_glossyMarble; // en tu .hpp
     std::unique_ptr<ShadowMap>  m_ShadowMap; 
-    std::unique_ptr<GLTF::Model>          m_Model;
     std::vector<std::unique_ptr<Objeto3D>> m_ModelListGLTF;
     std::vector<std::unique_ptr<Objeto3D>> m_ModelList;
    
@@ -181,22 +316,169 @@ private:
     TiledMap m_TiledMap;
     TileScene m_TiledScene;
 
-    std::unordered_map<std::string, std::unique_ptr<GLTF::Model>> m_modelsGLTF;
+    std::unordered_map<std::string, std::unique_ptr<StaticModel>> m_modelsGLTF;     // solo los que usa el mapa
+    std::unordered_set<std::string>                               m_ReferencedModels; // "<Name>/scene.gltf" del mapa actual
 
+    // Carga de modelos en segundo plano; se vacia en PumpModelLoads()
+    AsyncModelLoader                           m_ModelLoader;
+    std::vector<AsyncModelLoader::LoadedModel> m_LoadedModels;
+    float                                      m_ModelUploadBudgetMs = 4.0f; // subida a GPU por frame
 
+    // Modelos subidos cuyos placements aun son placeholders: PumpModelLoads
+    // reconstruye la escena como mucho una vez cada m_TileSceneRebuildMs
+    bool                                           m_TileSceneDirty     = false;
+    double                                         m_TileSceneRebuildMs = 250.0;
+    std::chrono::high_resolution_clock::time_point m_LastTileSceneRebuild;
 
+    // Modelos cocinados sin MeshOptimizer (desmarcados en la UI para comparar)
+    std::unordered_set<std::string> m_UnoptimizedModels;
 
-    struct FloorMesh
+    // Duracion de cada nodo del grafo de Initialize y su camino critico
+    TaskGraph::Report m_StartupReport;
+
+    // Arranque: desde InitializeTileScene hasta que no queda ningun modelo pendiente
+    std::chrono::high_resolution_clock::time_point m_ModelLoadStart;
+    double                                         m_ModelLoadMs     = 0.0;
+    bool                                           m_ModelLoadTiming = false;
+
+    // Cache de modelos cocinados: GLTF en frio contra .dgcm en caliente
+    struct ModelCacheBenchResult
     {
-        RefCntAutoPtr<IBuffer> VertexBuffer;
-        RefCntAutoPtr<IBuffer> IndexBuffer;
-        uint32_t NumIndices;
+        bool   Valid       = false;
+        Uint32 NumModels   = 0;
+        double GLTFParseMs = 0.0; // GLTF::Model sin contexto: JSON, buffers, PNG/JPEG, intercalado
+        double CookMs      = 0.0; // ModelCooker::Cook (incluye mips y BC1)
+        double WarmOpenMs  = 0.0; // proyectar + validar el hash de las fuentes
+        double CreateMs    = 0.0; // StaticModel::Create desde el fichero proyectado
+        Uint64 CacheBytes  = 0;
+    };
+    ModelCacheBenchResult m_ModelCacheBench;
+
+    // DungeonGenerator::Generate de 64x64 a 8192x8192, misma semilla: rejilla de
+    // bytes en 1 hilo, en el pool, y empaquetada a 2 bits
+    struct DungeonBenchResult
+    {
+        int    Size       = 0;
+        double Ms         = 0.0;
+        double ParallelMs = 0.0;
+        double PackedMs   = 0.0;
+        double FloorPc    = 0.0; // % de celdas de suelo
+        double GridMB     = 0.0;
+        double PackedMB   = 0.0;
+        size_t Nodes      = 0;
+        size_t TreeAllocs = 0; // bloques de nodos del BSP (antes, un new por nodo y sala)
+        size_t OldAllocs  = 0;
+        bool   Match      = true; // mismos bitplanes de suelo en las tres pasadas
+    };
+    std::vector<DungeonBenchResult> m_DungeonBench;
+    Uint32                          m_DungeonBenchThreads = 0;
+
 
 
+
+    struct FloorMesh
+    {
+        GeometryRange Geometry; // rango en m_GeometryPool
     };
 
     FloorMesh m_FloorMesh; // piso de la escena
 
+    std::unique_ptr<Cubo> m_TileCube; // malla base de todos los tiles de TileScene
+
+    // Comparacion loop por tile vs. instanciado: [0] = loop, [1] = instanciado
+    struct TileRenderStats
+    {
+        Uint32 DrawCalls = 0;
+        double CPUTimeMs = 0.0; // media movil del tiempo de CPU de la capa de tiles
+    } m_TileStats[2];
+    bool m_UseInstancedTiles = true;
+
+    // Frustum culling de TileScene por chunks (solo pase principal)
+    struct CullStats
+    {
+        Uint32 VisibleChunks  = 0;
+        Uint32 TotalChunks    = 0;
+        Uint32 VisibleObjects = 0;
+        double CullTimeMs     = 0.0; // media movil
+    } m_CullStats;
+    struct CullBenchmark
+    {
+        bool   Valid         = false;
+        bool   Match         = true; // SSE y escalar dieron el mismo resultado
+        Uint32 NumChunks     = 0;
+        Uint32 VisibleChunks = 0;
+        double SIMDTimeUs    = 0.0;
+        double ScalarTimeUs  = 0.0;
+    } m_CullBench;
+    bool                   m_CullTiles = true;
+    std::vector<TileBatch> m_VisibleTileRanges; // batches visibles ya fundidos
+
+    // Props de TileScene: un draw por primitiva y modelo con NumInstances = placements
+    bool                m_UseInstancedProps = true;
+    std::vector<Uint32> m_TileObjectList; // indices de objetos a grabar en este pase
+
+    // LOD de los props por tamano en pantalla de su esfera: radio / semialtura
+    // del frustum a esa distancia. Por debajo de m_LodScreenSize[i] se pasa al
+    // LOD i + 1. Lo elige la camara una vez por frame (SelectTileObjectLods) y
+    // las cascadas lo reutilizan con m_ShadowLodBias niveles mas; la cache de
+    // sombras estaticas aplica los mismos umbrales al tamano en la cascada
+    bool               m_UseLods                           = true;
+    float              m_LodScreenSize[CookedMaxLods - 1] = {0.20f, 0.08f, 0.03f};
+    int                m_ShadowLodBias                     = 1;
+    std::vector<Uint8> m_TileObjectLods; // por objeto de m_TiledScene
+    struct LodStats
+    {
+        Uint32 Objects[CookedMaxLods] = {};
+        Uint32 Impostors              = 0;
+        Uint64 Triangles              = 0; // de los props elegidos, pase principal sin culling
+        Uint64 TrianglesLod0          = 0; // los mismos, todos a LOD0
+    } m_LodStats;
+
+    // Impostores octaedricos de los props: cada modelo se hornea al cargarse
+    // y mas alla de m_ImpostorDistance sus placements son un quad del atlas
+    // (ImpostorLod en m_TileObjectLods). Todos en un draw instanciado; en
+    // sombra siguen siendo malla con su LOD mas simple
+    static constexpr Uint8        ImpostorLod        = CookedMaxLods;
+    ImpostorAtlas                 m_Impostors;
+    bool                          m_UseImpostors     = true;
+    float                         m_ImpostorDistance = 35.f;
+    std::vector<StaticModel*>     m_ImpostorBakeQueue; // cargados, sin hornear todavia
+    std::vector<ImpostorInstance> m_ImpostorInstances; // los del frame actual
+    Uint32                        m_ImpostorDraws = 0;
+
+    // Casters de sombra por cascada: indices en m_Objetos3D y en
+    // m_TiledScene.Objects() que tocan el volumen de luz de esa cascada
+    struct ShadowCasterList
+    {
+        std::vector<Uint32> Objetos;
+        std::vector<Uint32> TileObjects;
+    };
+    struct ShadowCasterStats
+    {
+        Uint32 Candidates  = 0;   // casters totales antes del culling
+        double BuildTimeMs = 0.0; // media movil de la construccion de listas
+    } m_ShadowCasterStats;
+    std::vector<ShadowCasterList> m_CascadeCasters;
+    std::vector<float4>           m_CasterSpheres; // esferas de m_Objetos3D del frame
+    bool                          m_CullShadowCasters = true;
+
+    // Cache de sombras estaticas (props de TileScene) por cascada. Se vuelve a
+    // dibujar solo si cambia la ViewProj de la cascada (direccion de la luz o
+    // snap de la cascada); cada frame se copia y encima van los dinamicos.
+    // Los casters van con un LOD elegido por su tamano en la cascada, no por
+    // la camara (m_DrawingStaticShadows).
+    RefCntAutoPtr<ITexture>                  m_StaticShadowCache;
+    std::vector<RefCntAutoPtr<ITextureView>> m_StaticShadowDSVs;
+    std::vector<float4x4>                    m_StaticShadowViewProj;
+    std::vector<bool>                        m_StaticShadowValid;
+    bool                                     m_DrawingStaticShadows = false;
+    struct ShadowCacheStats
+    {
+        Uint32 CascadesRendered = 0; // cascadas estaticas redibujadas este frame
+        Uint32 CascadesCached   = 0; // cascadas servidas desde la cache
+    } m_ShadowCacheStats;
+    bool m_UseStaticShadowCache = true;
+
     //ShadowMapManager m_ShadowMapManager;
 
     
@@ -228,7 +510,6 @@ private:
     RefCntAutoPtr<IBuffer>  m_CameraAttribsCB; // VS   (matrices view/proj)
     RefCntAutoPtr<IBuffer>  m_LightAttribsCB;  // VS+PS (direccin luz, cascadas)
     RefCntAutoPtr<IBuffer>  m_ParallaxAttribsCB; // VS+PS (direccin luz, cascadas)
-    RefCntAutoPtr<IBuffer>  m_MaterialAttribsCB; // VS+PS (direccin luz, cascadas)
     RefCntAutoPtr<ISampler> m_pCmpSampler;     // PCF
     RefCntAutoPtr<ISampler> m_pAnisoSampler;   // VSM / EVSM
 
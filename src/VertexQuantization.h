@@ -0,0 +1,320 @@
+#pragma once
+#include "BasicMath.hpp"
+#include "InputLayout.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring> // std::memcpy
+
+namespace Diligent
+{
+
+// Formato de los vertices en el VB del GeometryPool (y de los PSO que lo leen)
+enum MESH_VERTEX_FORMAT : Uint8
+{
+    MESH_VERTEX_FORMAT_FLOAT = 0, // 48 bytes: float3 pos, float3 normal, float2 uv, float4 tangent
+    MESH_VERTEX_FORMAT_COMPACT,   // 20 bytes: CompactMeshVertex
+};
+
+// Vertice de entrada de todas las mallas: mismo layout que TangentVertex,
+// TileVertex y CookedVertex
+struct FloatMeshVertex
+{
+    float3 Pos;
+    float3 Normal;
+    float2 UV;
+    float4 Tangent; // .w = signo de la bitangente
+};
+static_assert(sizeof(FloatMeshVertex) == 48, "FloatMeshVertex debe ser el vertice de 48 bytes de los PSO");
+
+struct CompactMeshVertex
+{
+    Int16  Pos[4];     // snorm16: xyz en la caja de la malla, w = signo de la bitangente
+    Int16  Normal[2];  // octaedrico, snorm16
+    Int16  Tangent[2]; // octaedrico, snorm16
+    Uint16 UV[2];      // half
+};
+static_assert(sizeof(CompactMeshVertex) == 20, "CompactMeshVertex debe ser de 20 bytes");
+
+// -----------------------------------------------------------------------------
+// Cuantizacion de vertices al subir las mallas al pool. Las posiciones van en
+// snorm16 dentro de una caja centrada en el AABB de la malla con el medio lado
+// mayor como escala (uniforme: normales y tangentes no necesitan correccion);
+// esa caja vuelve como Dequant (centro xyz, escala w) y se lleva en la matriz
+// de mundo de la malla (GetDequantTransform), asi el VS solo decodifica
+// normal y tangente (VertexDecode.fxh). Decode() repite en CPU lo que hace el
+// shader y Measure() compara contra los float originales.
+// -----------------------------------------------------------------------------
+class VertexQuantizer
+{
+public:
+    // Error maximo acumulado contra los vertices float
+    struct ErrorStats
+    {
+        Uint32 NumVertices   = 0;
+        float  MaxPosError   = 0; // relativo al radio de la caja (medio lado mayor)
+        float  MaxNormalDeg  = 0;
+        float  MaxTangentDeg = 0;
+        float  MaxUVError    = 0; // relativo a max(1, |uv|)
+        Uint32 SignErrors    = 0; // signo de la bitangente distinto
+
+        void Merge(const ErrorStats& Other)
+        {
+            NumVertices += Other.NumVertices;
+            MaxPosError   = (std::max)(MaxPosError, Other.MaxPosError);
+            MaxNormalDeg  = (std::max)(MaxNormalDeg, Other.MaxNormalDeg);
+            MaxTangentDeg = (std::max)(MaxTangentDeg, Other.MaxTangentDeg);
+            MaxUVError    = (std::max)(MaxUVError, Other.MaxUVError);
+            SignErrors += Other.SignErrors;
+        }
+    };
+
+    // Cotas de la comprobacion: 16 bits por componente dan ~1.5e-5 de
+    // posicion, ~0.005 grados en octaedrico y 2^-11 relativo en half
+    static constexpr float MaxPosErrorTol = 2e-5f;
+    static constexpr float MaxAngleTolDeg = 0.02f;
+    static constexpr float MaxUVErrorTol  = 1.f / 1024.f;
+
+    static Uint32 GetVertexStride(MESH_VERTEX_FORMAT Format)
+    {
+        return Format == MESH_VERTEX_FORMAT_COMPACT ? sizeof(CompactMeshVertex) : sizeof(FloatMeshVertex);
+    }
+
+    // Atributos 0..3 (los del vertice) en pElems[0..3]; las tablas de los PSO
+    // los declaran en float y se sobrescriben con esto antes de crear el PSO
+    static void WriteVertexLayout(MESH_VERTEX_FORMAT Format, LayoutElement* pElems)
+    {
+        if (Format == MESH_VERTEX_FORMAT_COMPACT)
+        {
+            pElems[0] = LayoutElement{0, 0, 4, VT_INT16, True};    // pos + signo
+            pElems[1] = LayoutElement{1, 0, 2, VT_INT16, True};    // normal
+            pElems[2] = LayoutElement{2, 0, 2, VT_FLOAT16, False}; // uv
+            pElems[3] = LayoutElement{3, 0, 2, VT_INT16, True};    // tangent
+        }
+        else
+        {
+            pElems[0] = LayoutElement{0, 0, 3, VT_FLOAT32, False};
+            pElems[1] = LayoutElement{1, 0, 3, VT_FLOAT32, False};
+            pElems[2] = LayoutElement{2, 0, 2, VT_FLOAT32, False};
+            pElems[3] = LayoutElement{3, 0, 4, VT_FLOAT32, False};
+        }
+    }
+
+    // Centro del AABB (xyz) y medio lado mayor (w)
+    static float4 ComputeDequant(const FloatMeshVertex* pVertices, Uint32 NumVertices)
+    {
+        if (NumVertices == 0)
+            return float4{0, 0, 0, 1};
+
+        float3 Min = pVertices[0].Pos;
+        float3 Max = pVertices[0].Pos;
+        for (Uint32 v = 1; v < NumVertices; ++v)
+        {
+            const float3& p = pVertices[v].Pos;
+            Min             = float3{(std::min)(Min.x, p.x), (std::min)(Min.y, p.y), (std::min)(Min.z, p.z)};
+            Max             = float3{(std::max)(Max.x, p.x), (std::max)(Max.y, p.y), (std::max)(Max.z, p.z)};
+        }
+        const float3 Half  = (Max - Min) * 0.5f;
+        const float  Scale = (std::max)({Half.x, Half.y, Half.z});
+        return float4{(Min + Max) * 0.5f, Scale > 0.f ? Scale : 1.f};
+    }
+
+    // Espacio de la caja -> espacio de la malla (filas: escala y luego traslacion)
+    static float4x4 GetDequantTransform(const float4& Dequant)
+    {
+        return float4x4::Scale(Dequant.w, Dequant.w, Dequant.w) * float4x4::Translation(Dequant.x, Dequant.y, Dequant.z);
+    }
+
+    static void Encode(const FloatMeshVertex* pSrc, Uint32 NumVertices, const float4& Dequant, CompactMeshVertex* pDst)
+    {
+        const float InvScale = 1.f / Dequant.w;
+        for (Uint32 v = 0; v < NumVertices; ++v)
+        {
+            const FloatMeshVertex& In  = pSrc[v];
+            CompactMeshVertex&     Out = pDst[v];
+
+            Out.Pos[0] = FloatToSnorm16((In.Pos.x - Dequant.x) * InvScale);
+            Out.Pos[1] = FloatToSnorm16((In.Pos.y - Dequant.y) * InvScale);
+            Out.Pos[2] = FloatToSnorm16((In.Pos.z - Dequant.z) * InvScale);
+            Out.Pos[3] = In.Tangent.w < 0.f ? -32767 : 32767;
+            OctEncode(In.Normal, Out.Normal);
+            OctEncode(float3{In.Tangent.x, In.Tangent.y, In.Tangent.z}, Out.Tangent);
+            Out.UV[0] = FloatToHalf(In.UV.x);
+            Out.UV[1] = FloatToHalf(In.UV.y);
+        }
+    }
+
+    // Lo mismo que el VS con COMPACT_VERTEX, mas la descuantizacion de la posicion
+    static FloatMeshVertex Decode(const CompactMeshVertex& In, const float4& Dequant)
+    {
+        FloatMeshVertex Out;
+        Out.Pos = float3{Snorm16ToFloat(In.Pos[0]), Snorm16ToFloat(In.Pos[1]), Snorm16ToFloat(In.Pos[2])} * Dequant.w +
+            float3{Dequant.x, Dequant.y, Dequant.z};
+        Out.Normal  = OctDecode(In.Normal);
+        Out.UV      = float2{HalfToFloat(In.UV[0]), HalfToFloat(In.UV[1])};
+        Out.Tangent = float4{OctDecode(In.Tangent), In.Pos[3] < 0 ? -1.f : 1.f};
+        return Out;
+    }
+
+    // Decodifica pEncoded y lo compara con pSrc. Las tangentes nulas (mallas
+    // sin UV) no cuentan: el shader tampoco las puede usar
+    static ErrorStats Measure(const FloatMeshVertex* pSrc, const CompactMeshVertex* pEncoded, Uint32 NumVertices, const float4& Dequant)
+    {
+        ErrorStats Stats;
+        Stats.NumVertices = NumVertices;
+        for (Uint32 v = 0; v < NumVertices; ++v)
+        {
+            const FloatMeshVertex& Ref = pSrc[v];
+            const FloatMeshVertex  Dec = Decode(pEncoded[v], Dequant);
+
+            const float3 dPos = Dec.Pos - Ref.Pos;
+            Stats.MaxPosError = (std::max)(Stats.MaxPosError, (std::max)({std::abs(dPos.x), std::abs(dPos.y), std::abs(dPos.z)}) / Dequant.w);
+
+            Stats.MaxNormalDeg = (std::max)(Stats.MaxNormalDeg, AngleDeg(Ref.Normal, Dec.Normal));
+
+            const float3 RefT{Ref.Tangent.x, Ref.Tangent.y, Ref.Tangent.z};
+            if (dot(RefT, RefT) > 1e-12f)
+            {
+                Stats.MaxTangentDeg = (std::max)(Stats.MaxTangentDeg, AngleDeg(RefT, float3{Dec.Tangent.x, Dec.Tangent.y, Dec.Tangent.z}));
+                if ((Ref.Tangent.w < 0.f) != (Dec.Tangent.w < 0.f))
+                    ++Stats.SignErrors;
+            }
+
+            const float du = std::abs(Dec.UV.x - Ref.UV.x) / (std::max)(1.f, std::abs(Ref.UV.x));
+            const float dv = std::abs(Dec.UV.y - Ref.UV.y) / (std::max)(1.f, std::abs(Ref.UV.y));
+            Stats.MaxUVError = (std::max)({Stats.MaxUVError, du, dv});
+        }
+        return Stats;
+    }
+
+    static bool IsWithinTolerance(const ErrorStats& Stats)
+    {
+        return Stats.MaxPosError <= MaxPosErrorTol && Stats.MaxNormalDeg <= MaxAngleTolDeg && Stats.MaxTangentDeg <= MaxAngleTolDeg &&
+            Stats.MaxUVError <= MaxUVErrorTol && Stats.SignErrors == 0;
+    }
+
+    // Conversiones de componente (mismas reglas que el input assembler)
+    static Int16 FloatToSnorm16(float f)
+    {
+        f = (std::min)((std::max)(f, -1.f), 1.f);
+        return static_cast<Int16>(std::lround(f * 32767.f));
+    }
+
+    static float Snorm16ToFloat(Int16 s)
+    {
+        return (std::max)(static_cast<float>(s) / 32767.f, -1.f);
+    }
+
+    // float -> half con redondeo al par mas cercano; satura a infinito
+    static Uint16 FloatToHalf(float f)
+    {
+        Uint32 Bits;
+        std::memcpy(&Bits, &f, sizeof(Bits));
+        const Uint16 Sign = static_cast<Uint16>((Bits >> 16) & 0x8000u);
+        const Uint32 Abs  = Bits & 0x7FFFFFFFu;
+
+        if (Abs >= 0x7F800000u) // inf / nan
+            return static_cast<Uint16>(Sign | 0x7C00u | (Abs > 0x7F800000u ? 0x200u : 0u));
+        if (Abs >= 0x477FF000u) // >= 65520: fuera de rango tras redondear
+            return static_cast<Uint16>(Sign | 0x7C00u);
+        if (Abs < 0x38800000u) // subnormal en half
+        {
+            if (Abs < 0x33000000u)
+                return Sign;
+            const Uint32 Mant  = (Abs & 0x007FFFFFu) | 0x00800000u;
+            const Uint32 Shift = 126u - (Abs >> 23); // 24..14
+            Uint32       Half  = Mant >> Shift;
+            const Uint32 Rem   = Mant & ((1u << Shift) - 1u);
+            const Uint32 Mid   = 1u << (Shift - 1u);
+            if (Rem > Mid || (Rem == Mid && (Half & 1u)))
+                ++Half;
+            return static_cast<Uint16>(Sign | Half);
+        }
+
+        Uint32       Half = ((Abs - 0x38000000u) >> 13);
+        const Uint32 Rem  = Abs & 0x1FFFu;
+        if (Rem > 0x1000u || (Rem == 0x1000u && (Half & 1u)))
+            ++Half;
+        return static_cast<Uint16>(Sign | Half);
+    }
+
+    static float HalfToFloat(Uint16 h)
+    {
+        const Uint32 Sign = Uint32{h & 0x8000u} << 16;
+        const Uint32 Exp  = (h >> 10) & 0x1Fu;
+        const Uint32 Mant = h & 0x3FFu;
+
+        Uint32 Bits;
+        if (Exp == 0)
+        {
+            const float f = std::ldexp(static_cast<float>(Mant), -24);
+            return Sign ? -f : f;
+        }
+        if (Exp == 31)
+            Bits = Sign | 0x7F800000u | (Mant << 13);
+        else
+            Bits = Sign | ((Exp + 112u) << 23) | (Mant << 13);
+
+        float f;
+        std::memcpy(&f, &Bits, sizeof(f));
+        return f;
+    }
+
+    // Proyeccion octaedrica (Cigolle et al. 2014). Se prueban los cuatro
+    // redondeos vecinos y se queda el que mejor reconstruye la direccion
+    static void OctEncode(const float3& Dir, Int16 Out[2])
+    {
+        const float L1 = std::abs(Dir.x) + std::abs(Dir.y) + std::abs(Dir.z);
+        if (L1 < 1e-20f)
+        {
+            Out[0] = Out[1] = 0; // +Z
+            return;
+        }
+
+        float x = Dir.x / L1;
+        float y = Dir.y / L1;
+        if (Dir.z < 0.f)
+        {
+            const float ox = (1.f - std::abs(y)) * (x >= 0.f ? 1.f : -1.f);
+            const float oy = (1.f - std::abs(x)) * (y >= 0.f ? 1.f : -1.f);
+            x              = ox;
+            y              = oy;
+        }
+
+        const float3 N    = Dir / length(Dir);
+        const float  fx   = std::floor(x * 32767.f);
+        const float  fy   = std::floor(y * 32767.f);
+        float        Best = 4.f;
+        for (int c = 0; c < 4; ++c)
+        {
+            const float  qx           = (std::min)((std::max)(fx + (c & 1), -32767.f), 32767.f);
+            const float  qy           = (std::min)((std::max)(fy + (c >> 1), -32767.f), 32767.f);
+            const Int16  Candidate[2] = {static_cast<Int16>(qx), static_cast<Int16>(qy)};
+            const float3 d            = OctDecode(Candidate) - N;
+            if (dot(d, d) < Best)
+            {
+                Best   = dot(d, d);
+                Out[0] = Candidate[0];
+                Out[1] = Candidate[1];
+            }
+        }
+    }
+
+    static float3 OctDecode(const Int16 In[2])
+    {
+        float3      n{Snorm16ToFloat(In[0]), Snorm16ToFloat(In[1]), 0.f};
+        n.z           = 1.f - std::abs(n.x) - std::abs(n.y);
+        const float t = (std::max)(-n.z, 0.f);
+        n.x += n.x >= 0.f ? -t : t;
+        n.y += n.y >= 0.f ? -t : t;
+        return n / length(n);
+    }
+
+private:
+    // atan2 en vez de acos: acos(dot) no resuelve angulos de centesimas de grado en float
+    static float AngleDeg(const float3& a, const float3& b)
+    {
+        return std::atan2(length(cross(a, b)), dot(a, b)) * (180.f / PI_F);
+    }
+};
+
+} // namespace Diligent
@@ -0,0 +1,80 @@
+#include "TestFramework.h"
+#include "ChunkCulling.h"
+#include <random>
+
+using namespace Diligent;
+
+namespace
+{
+
+// Chunks de 16 celdas de 2 m sobre un mapa de 512x512, como TileScene, mas
+// unas cajas sueltas para que la cola escalar de CullChunks tambien trabaje
+ChunkBoundsSoA MakeChunkGrid()
+{
+    constexpr int   MapCells  = 512;
+    constexpr int   NumChunks = MapCells / 16;
+    constexpr float ChunkSize = 16 * 2.f;
+    constexpr float Origin    = -MapCells * 2.f * 0.5f;
+
+    ChunkBoundsSoA Bounds;
+    for (int cz = 0; cz < NumChunks; ++cz)
+    {
+        for (int cx = 0; cx < NumChunks; ++cx)
+        {
+            const float x0 = Origin + cx * ChunkSize;
+            const float z0 = Origin + cz * ChunkSize;
+            Bounds.Add(float3{x0, -2.f, z0}, float3{x0 + ChunkSize, 2.f, z0 + ChunkSize});
+        }
+    }
+    Bounds.Add(float3{-1.f, -1.f, 3.f}, float3{1.f, 1.f, 5.f});
+    Bounds.Add(float3{-1.f, -1.f, -5.f}, float3{1.f, 1.f, -3.f});
+    Bounds.Add(float3{0.f, 0.f, 0.f}, float3{0.f, 0.f, 0.f});
+    return Bounds;
+}
+
+float4x4 MakeViewProj(const float3& Eye, float Yaw, bool IsGL)
+{
+    const float4x4 View = float4x4::Translation(-Eye.x, -Eye.y, -Eye.z) * float4x4::RotationY(Yaw);
+    return View * float4x4::Projection(PI_F / 4.f, 16.f / 9.f, 0.1f, 400.f, IsGL);
+}
+
+} // namespace
+
+// El camino SSE tiene que marcar exactamente los mismos chunks que el escalar
+TEST_CASE(ChunkCulling_SIMDMatchesScalar)
+{
+    const ChunkBoundsSoA Bounds = MakeChunkGrid();
+
+    std::mt19937                          Rng{7};
+    std::uniform_real_distribution<float> Pos{-600.f, 600.f};
+    std::uniform_real_distribution<float> Angle{-PI_F, PI_F};
+
+    std::vector<Uint8> VisibleSIMD, VisibleScalar;
+    for (int i = 0; i < 200; ++i)
+    {
+        const float3           Eye{Pos(Rng), 1.5f, Pos(Rng)};
+        const bool             IsGL = (i & 1) != 0;
+        const FrustumPlanesSoA Planes{MakeViewProj(Eye, Angle(Rng), IsGL), IsGL};
+
+        const Uint32 NumSIMD   = CullChunks(Bounds, Planes, VisibleSIMD, true);
+        const Uint32 NumScalar = CullChunks(Bounds, Planes, VisibleScalar, false);
+        TEST_CHECK(NumSIMD == NumScalar);
+        TEST_CHECK(VisibleSIMD == VisibleScalar);
+    }
+}
+
+// Camara en el origen mirando a +Z: la caja de delante entra y la de detras no
+TEST_CASE(ChunkCulling_FrontAndBehind)
+{
+    const ChunkBoundsSoA   Bounds = MakeChunkGrid();
+    const FrustumPlanesSoA Planes{MakeViewProj(float3{0.f, 0.f, 0.f}, 0.f, false), false};
+
+    std::vector<Uint8> Visible;
+    CullChunks(Bounds, Planes, Visible, true);
+
+    const Uint32 Front = Bounds.Size() - 3;
+    TEST_CHECK(Visible[Front] == 1);
+    TEST_CHECK(Visible[Front + 1] == 0);
+    TEST_CHECK(IsSphereVisible(Planes, float3{0.f, 0.f, 10.f}, 1.f));
+    TEST_CHECK(!IsSphereVisible(Planes, float3{0.f, 0.f, -10.f}, 1.f));
+}
@@ -0,0 +1,126 @@
+#include "TestFramework.h"
+#include "PackedTileGrid.h"
+#include <random>
+
+namespace
+{
+
+// Rejilla de referencia de un byte por celda con las mismas operaciones
+struct ByteGrid
+{
+    int                  Width  = 0;
+    int                  Height = 0;
+    std::vector<uint8_t> Cells;
+
+    void Assign(int w, int h, uint8_t Value)
+    {
+        Width  = w;
+        Height = h;
+        Cells.assign(static_cast<size_t>(w) * h, Value);
+    }
+
+    uint8_t& At(int x, int y) { return Cells[static_cast<size_t>(y) * Width + x]; }
+};
+
+bool SameCells(const PackedTileGrid& Packed, ByteGrid& Bytes)
+{
+    std::vector<uint8_t> Row(Bytes.Width);
+    for (int y = 0; y < Bytes.Height; ++y)
+    {
+        Packed.ExpandRow(y, Row.data());
+        for (int x = 0; x < Bytes.Width; ++x)
+        {
+            if (Packed.Get(x, y) != Bytes.At(x, y) || Row[x] != Bytes.At(x, y))
+                return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+// Tramos de fila, columnas y rectangulos al azar, con anchos alrededor de los
+// limites de palabra (32 celdas) y de bitplane (64)
+TEST_CASE(PackedTileGrid_MatchesByteGrid)
+{
+    const int Widths[] = {1, 5, 31, 32, 33, 63, 64, 65, 100, 257};
+
+    std::mt19937 Rng{22};
+    for (int Width : Widths)
+    {
+        const int Height = 1 + static_cast<int>(Rng() % 40);
+
+        PackedTileGrid Packed;
+        ByteGrid       Bytes;
+        Packed.Assign(Width, Height, 2);
+        Bytes.Assign(Width, Height, 2);
+        TEST_CHECK(Packed.GetWidth() == Width && Packed.GetHeight() == Height);
+
+        for (int op = 0; op < 300; ++op)
+        {
+            const uint8_t Value = static_cast<uint8_t>(Rng() % 4);
+            const int     x     = static_cast<int>(Rng() % Width);
+            const int     y     = static_cast<int>(Rng() % Height);
+            const int     w     = 1 + static_cast<int>(Rng() % (Width - x));
+            const int     h     = 1 + static_cast<int>(Rng() % (Height - y));
+            switch (op % 3)
+            {
+                case 0:
+                    Packed.FillRow(y, x, w, Value);
+                    for (int i = x; i < x + w; ++i)
+                        Bytes.At(i, y) = Value;
+                    break;
+                case 1:
+                    Packed.FillColumn(x, y, h, Value);
+                    for (int j = y; j < y + h; ++j)
+                        Bytes.At(x, j) = Value;
+                    break;
+                default:
+                    Packed.FillRect(x, y, w, h, Value);
+                    for (int j = y; j < y + h; ++j)
+                        for (int i = x; i < x + w; ++i)
+                            Bytes.At(i, j) = Value;
+                    break;
+            }
+        }
+        TEST_CHECK(SameCells(Packed, Bytes));
+
+        for (uint8_t Value = 0; Value < 4; ++Value)
+        {
+            const size_t Expected = static_cast<size_t>(std::count(Bytes.Cells.begin(), Bytes.Cells.end(), Value));
+            TEST_CHECK(Packed.Count(Value) == Expected);
+
+            // El plano marca justo las celdas con Value y deja a 0 el relleno de fila
+            TileBitplane Plane;
+            Packed.ExtractBitplane(Value, Plane);
+            TEST_CHECK(Plane.Width == Width && Plane.Height == Height && Plane.WordsPerRow == (static_cast<size_t>(Width) + 63) / 64);
+
+            bool   SameBits = true;
+            size_t NumBits  = 0;
+            for (int y = 0; y < Height; ++y)
+            {
+                for (int x = 0; x < Width; ++x)
+                    SameBits = SameBits && Plane.Test(x, y) == (Bytes.At(x, y) == Value);
+                for (size_t w = 0; w < Plane.WordsPerRow; ++w)
+                {
+                    for (uint64_t Bits = Plane.Row(y)[w]; Bits != 0; Bits &= Bits - 1)
+                    {
+                        SameBits = SameBits && static_cast<int>(w) * 64 + LowestSetBit(Bits) < Width;
+                        ++NumBits;
+                    }
+                }
+            }
+            TEST_CHECK(SameBits);
+            TEST_CHECK(NumBits == Expected);
+        }
+    }
+}
+
+TEST_CASE(PackedTileGrid_LowestSetBit)
+{
+    for (int i = 0; i < 64; ++i)
+    {
+        TEST_CHECK(LowestSetBit(1ull << i) == i);
+        TEST_CHECK(LowestSetBit(~0ull << i) == i);
+    }
+}
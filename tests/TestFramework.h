@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdio>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Pruebas sin framework externo: cada .cpp registra sus casos con TEST_CASE y
+// TEST_CHECK apunta el fallo sin cortar el caso, para ver todos de una pasada.
+// -----------------------------------------------------------------------------
+struct TestCase
+{
+    const char* Name;
+    void (*Fn)();
+};
+
+inline std::vector<TestCase>& GetTestCases()
+{
+    static std::vector<TestCase> Cases;
+    return Cases;
+}
+
+inline int& GetTestFailures()
+{
+    static int Failures = 0;
+    return Failures;
+}
+
+struct TestRegistrar
+{
+    TestRegistrar(const char* Name, void (*Fn)()) { GetTestCases().push_back({Name, Fn}); }
+};
+
+#define TEST_CASE(Name)                                  \
+    static void          Name();                         \
+    static TestRegistrar Name##_Registrar{#Name, &Name}; \
+    static void          Name()
+
+#define TEST_CHECK(Cond)                                                \
+    do                                                                  \
+    {                                                                   \
+        if (!(Cond))                                                    \
+        {                                                               \
+            std::printf("    %s(%d): %s\n", __FILE__, __LINE__, #Cond); \
+            ++GetTestFailures();                                        \
+        }                                                               \
+    } while (false)
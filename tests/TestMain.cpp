@@ -0,0 +1,27 @@
+#include "TestFramework.h"
+#include <cstring>
+
+// Sin argumentos ejecuta todos los casos; con uno, solo los que lo contienen
+// en el nombre. Devuelve 1 si alguno falla (ctest lo marca como fallido).
+int main(int argc, char** argv)
+{
+    const char* Filter = argc > 1 ? argv[1] : nullptr;
+
+    int NumRun = 0, NumFailed = 0;
+    for (const TestCase& Case : GetTestCases())
+    {
+        if (Filter != nullptr && std::strstr(Case.Name, Filter) == nullptr)
+            continue;
+
+        const int FailuresBefore = GetTestFailures();
+        Case.Fn();
+        const bool Passed = GetTestFailures() == FailuresBefore;
+        std::printf("[%s] %s\n", Passed ? "  OK  " : " FAIL ", Case.Name);
+
+        ++NumRun;
+        NumFailed += Passed ? 0 : 1;
+    }
+
+    std::printf("%d/%d casos correctos\n", NumRun - NumFailed, NumRun);
+    return NumFailed == 0 ? 0 : 1;
+}
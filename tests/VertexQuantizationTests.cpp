@@ -0,0 +1,124 @@
+#include "TestFramework.h"
+#include "VertexQuantization.h"
+#include <random>
+#include <vector>
+
+using namespace Diligent;
+
+namespace
+{
+
+float3 RandomDir(std::mt19937& Rng)
+{
+    std::normal_distribution<float> N{0.f, 1.f};
+    for (;;)
+    {
+        const float3 d{N(Rng), N(Rng), N(Rng)};
+        const float  l = length(d);
+        if (l > 1e-3f)
+            return d / l;
+    }
+}
+
+} // namespace
+
+// Mallas aleatorias con cajas de escalas muy distintas: el formato compacto
+// decodificado tiene que quedar dentro de las cotas que usa el GeometryPool
+TEST_CASE(VertexQuantizer_RoundTripWithinTolerance)
+{
+    std::mt19937                          Rng{18};
+    std::uniform_real_distribution<float> Unit{-1.f, 1.f};
+    std::uniform_real_distribution<float> UV{-4.f, 4.f};
+
+    const float Scales[] = {0.01f, 1.f, 37.f, 2500.f};
+    for (float Scale : Scales)
+    {
+        const float3 Offset{Unit(Rng) * Scale * 10.f, Unit(Rng) * Scale * 10.f, Unit(Rng) * Scale * 10.f};
+
+        std::vector<FloatMeshVertex> Vertices(4096);
+        for (size_t v = 0; v < Vertices.size(); ++v)
+        {
+            auto& Vert   = Vertices[v];
+            Vert.Pos     = float3{Unit(Rng) * Scale, Unit(Rng) * Scale * 0.5f, Unit(Rng) * Scale * 0.1f} + Offset;
+            Vert.Normal  = RandomDir(Rng);
+            Vert.UV      = float2{UV(Rng), UV(Rng)};
+            Vert.Tangent = float4{RandomDir(Rng), (v & 1) ? 1.f : -1.f};
+        }
+        // Direcciones en los ejes y en las aristas del octaedro
+        Vertices[0].Normal = float3{0.f, 0.f, 1.f};
+        Vertices[1].Normal = float3{0.f, 0.f, -1.f};
+        Vertices[2].Normal = float3{1.f, 0.f, 0.f};
+        Vertices[3].Normal = float3{0.f, -1.f, 0.f};
+        Vertices[4].Normal = float3{0.70710678f, 0.f, -0.70710678f};
+        // Malla sin UV: tangente nula, no cuenta en el error
+        Vertices[5].Tangent = float4{0.f, 0.f, 0.f, 1.f};
+
+        const Uint32 NumVertices = static_cast<Uint32>(Vertices.size());
+        const float4 Dequant     = VertexQuantizer::ComputeDequant(Vertices.data(), NumVertices);
+
+        std::vector<CompactMeshVertex> Encoded(Vertices.size());
+        VertexQuantizer::Encode(Vertices.data(), NumVertices, Dequant, Encoded.data());
+
+        const auto Stats = VertexQuantizer::Measure(Vertices.data(), Encoded.data(), NumVertices, Dequant);
+        TEST_CHECK(Stats.NumVertices == NumVertices);
+        TEST_CHECK(Stats.SignErrors == 0);
+        TEST_CHECK(VertexQuantizer::IsWithinTolerance(Stats));
+    }
+}
+
+// La caja de la malla llevada a la matriz de mundo deja las posiciones donde estaban
+TEST_CASE(VertexQuantizer_DequantTransform)
+{
+    FloatMeshVertex Vertices[2] = {};
+    Vertices[0].Pos             = float3{-3.f, 1.f, 10.f};
+    Vertices[1].Pos             = float3{5.f, 2.f, 11.f};
+
+    const float4 Dequant = VertexQuantizer::ComputeDequant(Vertices, 2);
+    TEST_CHECK(Dequant.x == 1.f && Dequant.y == 1.5f && Dequant.z == 10.5f && Dequant.w == 4.f);
+
+    CompactMeshVertex Encoded[2];
+    VertexQuantizer::Encode(Vertices, 2, Dequant, Encoded);
+    const float4x4 Transform = VertexQuantizer::GetDequantTransform(Dequant);
+    for (int v = 0; v < 2; ++v)
+    {
+        const float4 Box{VertexQuantizer::Snorm16ToFloat(Encoded[v].Pos[0]), VertexQuantizer::Snorm16ToFloat(Encoded[v].Pos[1]),
+                         VertexQuantizer::Snorm16ToFloat(Encoded[v].Pos[2]), 1.f};
+        const float4 p = Box * Transform;
+        TEST_CHECK(std::abs(p.x - Vertices[v].Pos.x) < 1e-3f);
+        TEST_CHECK(std::abs(p.y - Vertices[v].Pos.y) < 1e-3f);
+        TEST_CHECK(std::abs(p.z - Vertices[v].Pos.z) < 1e-3f);
+    }
+}
+
+// Todo half finito vuelve a si mismo, y los casos limite de FloatToHalf
+TEST_CASE(VertexQuantizer_HalfConversion)
+{
+    int NumMismatches = 0;
+    for (Uint32 h = 0; h <= 0xFFFFu; ++h)
+    {
+        if ((h & 0x7C00u) == 0x7C00u) // inf / nan
+            continue;
+        if (VertexQuantizer::FloatToHalf(VertexQuantizer::HalfToFloat(static_cast<Uint16>(h))) != h)
+            ++NumMismatches;
+    }
+    TEST_CHECK(NumMismatches == 0);
+
+    TEST_CHECK(VertexQuantizer::FloatToHalf(1.f) == 0x3C00u);
+    TEST_CHECK(VertexQuantizer::FloatToHalf(-2.f) == 0xC000u);
+    TEST_CHECK(VertexQuantizer::FloatToHalf(65504.f) == 0x7BFFu);
+    TEST_CHECK(VertexQuantizer::FloatToHalf(65520.f) == 0x7C00u);
+    TEST_CHECK(VertexQuantizer::FloatToHalf(std::ldexp(1.f, -24)) == 0x0001u);
+    TEST_CHECK(VertexQuantizer::FloatToHalf(std::ldexp(1.f, -26)) == 0x0000u);
+    TEST_CHECK(VertexQuantizer::FloatToHalf(1.f + std::ldexp(1.f, -11)) == 0x3C00u); // empate: al par
+    TEST_CHECK(VertexQuantizer::FloatToHalf(1.f + 3.f * std::ldexp(1.f, -11)) == 0x3C02u);
+}
+
+TEST_CASE(VertexQuantizer_Snorm16)
+{
+    TEST_CHECK(VertexQuantizer::FloatToSnorm16(1.f) == 32767);
+    TEST_CHECK(VertexQuantizer::FloatToSnorm16(-1.f) == -32767);
+    TEST_CHECK(VertexQuantizer::FloatToSnorm16(2.f) == 32767);
+    TEST_CHECK(VertexQuantizer::FloatToSnorm16(0.f) == 0);
+    TEST_CHECK(VertexQuantizer::Snorm16ToFloat(-32768) == -1.f);
+    TEST_CHECK(VertexQuantizer::Snorm16ToFloat(32767) == 1.f);
+}